@@ -323,12 +323,11 @@ static av_cold void exponent_init(AC3EncodeContext *s)
 
 
 /*
- * Extract exponents from the MDCT coefficients.
+ * Extract exponents from the MDCT coefficients of 1 channel.
  */
-static void extract_exponents(AC3EncodeContext *s)
+static void extract_exponents(AC3EncodeContext *s, int ch)
 {
-    int ch        = !s->cpl_on;
-    int chan_size = AC3_MAX_COEFS * s->num_blocks * (s->channels - ch + 1);
+    int chan_size = AC3_MAX_COEFS * s->num_blocks;
     AC3Block *block = &s->blocks[0];
 
     s->ac3dsp.extract_exponents(block->exp[ch], block->fixed_coef[ch], chan_size);
@@ -352,64 +351,57 @@ static const uint8_t exp_strategy_reuse_tab[4][6] = {
 };
 
 /*
- * Calculate exponent strategies for all channels.
+ * Calculate exponent strategies for 1 channel.
  * Array arrangement is reversed to simplify the per-channel calculation.
  */
-static void compute_exp_strategy(AC3EncodeContext *s)
+static void compute_exp_strategy(AC3EncodeContext *s, int ch)
 {
-    int ch, blk, blk1;
-
-    for (ch = !s->cpl_on; ch <= s->fbw_channels; ch++) {
-        uint8_t *exp_strategy = s->exp_strategy[ch];
-        uint8_t *exp          = s->blocks[0].exp[ch];
-        int exp_diff;
-
-        /* estimate if the exponent variation & decide if they should be
-           reused in the next frame */
-        exp_strategy[0] = EXP_NEW;
-        exp += AC3_MAX_COEFS;
-        for (blk = 1; blk < s->num_blocks; blk++, exp += AC3_MAX_COEFS) {
-            if (ch == CPL_CH) {
-                if (!s->blocks[blk-1].cpl_in_use) {
-                    exp_strategy[blk] = EXP_NEW;
-                    continue;
-                } else if (!s->blocks[blk].cpl_in_use) {
-                    exp_strategy[blk] = EXP_REUSE;
-                    continue;
-                }
-            } else if (s->blocks[blk].channel_in_cpl[ch] != s->blocks[blk-1].channel_in_cpl[ch]) {
+    uint8_t *exp_strategy = s->exp_strategy[ch];
+    uint8_t *exp          = s->blocks[0].exp[ch];
+    int blk, blk1, exp_diff;
+
+    if (ch == s->lfe_channel) {
+        exp_strategy[0] = EXP_D15;
+        for (blk = 1; blk < s->num_blocks; blk++)
+            exp_strategy[blk] = EXP_REUSE;
+        return;
+    }
+
+    /* estimate if the exponent variation & decide if they should be
+       reused in the next frame */
+    exp_strategy[0] = EXP_NEW;
+    exp += AC3_MAX_COEFS;
+    for (blk = 1; blk < s->num_blocks; blk++, exp += AC3_MAX_COEFS) {
+        if (ch == CPL_CH) {
+            if (!s->blocks[blk-1].cpl_in_use) {
                 exp_strategy[blk] = EXP_NEW;
                 continue;
+            } else if (!s->blocks[blk].cpl_in_use) {
+                exp_strategy[blk] = EXP_REUSE;
+                continue;
             }
-            exp_diff = s->mecc.sad[0](NULL, exp, exp - AC3_MAX_COEFS, 16, 16);
-            exp_strategy[blk] = EXP_REUSE;
-            if (ch == CPL_CH && exp_diff > (EXP_DIFF_THRESHOLD * (s->blocks[blk].end_freq[ch] - s->start_freq[ch]) / AC3_MAX_COEFS))
-                exp_strategy[blk] = EXP_NEW;
-            else if (ch > CPL_CH && exp_diff > EXP_DIFF_THRESHOLD)
-                exp_strategy[blk] = EXP_NEW;
-        }
-
-        /* now select the encoding strategy type : if exponents are often
-           recoded, we use a coarse encoding */
-        blk = 0;
-        while (blk < s->num_blocks) {
-            blk1 = blk + 1;
-            while (blk1 < s->num_blocks && exp_strategy[blk1] == EXP_REUSE)
-                blk1++;
-            exp_strategy[blk] = exp_strategy_reuse_tab[s->num_blks_code][blk1-blk-1];
-            blk = blk1;
+        } else if (s->blocks[blk].channel_in_cpl[ch] != s->blocks[blk-1].channel_in_cpl[ch]) {
+            exp_strategy[blk] = EXP_NEW;
+            continue;
         }
-    }
-    if (s->lfe_on) {
-        ch = s->lfe_channel;
-        s->exp_strategy[ch][0] = EXP_D15;
-        for (blk = 1; blk < s->num_blocks; blk++)
-            s->exp_strategy[ch][blk] = EXP_REUSE;
+        exp_diff = s->mecc.sad[0](NULL, exp, exp - AC3_MAX_COEFS, 16, 16);
+        exp_strategy[blk] = EXP_REUSE;
+        if (ch == CPL_CH && exp_diff > (EXP_DIFF_THRESHOLD * (s->blocks[blk].end_freq[ch] - s->start_freq[ch]) / AC3_MAX_COEFS))
+            exp_strategy[blk] = EXP_NEW;
+        else if (ch > CPL_CH && exp_diff > EXP_DIFF_THRESHOLD)
+            exp_strategy[blk] = EXP_NEW;
     }
 
-    /* for E-AC-3, determine frame exponent strategy */
-    if (CONFIG_EAC3_ENCODER && s->eac3)
-        ff_eac3_get_frame_exp_strategy(s);
+    /* now select the encoding strategy type : if exponents are often
+       recoded, we use a coarse encoding */
+    blk = 0;
+    while (blk < s->num_blocks) {
+        blk1 = blk + 1;
+        while (blk1 < s->num_blocks && exp_strategy[blk1] == EXP_REUSE)
+            blk1++;
+        exp_strategy[blk] = exp_strategy_reuse_tab[s->num_blks_code][blk1-blk-1];
+        blk = blk1;
+    }
 }
 
 
@@ -489,55 +481,51 @@ static void encode_exponents_blk_ch(uint8_t *exp, int nb_exps, int exp_strategy,
 
 
 /*
- * Encode exponents from original extracted form to what the decoder will see.
+ * Encode exponents of 1 channel from original extracted form to what the
+ * decoder will see.
  * This copies and groups exponents based on exponent strategy and reduces
  * deltas between adjacent exponent groups so that they can be differentially
  * encoded.
  */
-static void encode_exponents(AC3EncodeContext *s)
+static void encode_exponents(AC3EncodeContext *s, int ch)
 {
-    int blk, blk1, ch, cpl;
+    int blk, blk1, cpl;
     uint8_t *exp, *exp_strategy;
     int nb_coefs, num_reuse_blocks;
 
-    for (ch = !s->cpl_on; ch <= s->channels; ch++) {
-        exp          = s->blocks[0].exp[ch] + s->start_freq[ch];
-        exp_strategy = s->exp_strategy[ch];
+    exp          = s->blocks[0].exp[ch] + s->start_freq[ch];
+    exp_strategy = s->exp_strategy[ch];
 
-        cpl = (ch == CPL_CH);
-        blk = 0;
-        while (blk < s->num_blocks) {
-            AC3Block *block = &s->blocks[blk];
-            if (cpl && !block->cpl_in_use) {
-                exp += AC3_MAX_COEFS;
-                blk++;
-                continue;
-            }
-            nb_coefs = block->end_freq[ch] - s->start_freq[ch];
-            blk1 = blk + 1;
-
-            /* count the number of EXP_REUSE blocks after the current block
-               and set exponent reference block numbers */
-            s->exp_ref_block[ch][blk] = blk;
-            while (blk1 < s->num_blocks && exp_strategy[blk1] == EXP_REUSE) {
-                s->exp_ref_block[ch][blk1] = blk;
-                blk1++;
-            }
-            num_reuse_blocks = blk1 - blk - 1;
+    cpl = (ch == CPL_CH);
+    blk = 0;
+    while (blk < s->num_blocks) {
+        AC3Block *block = &s->blocks[blk];
+        if (cpl && !block->cpl_in_use) {
+            exp += AC3_MAX_COEFS;
+            blk++;
+            continue;
+        }
+        nb_coefs = block->end_freq[ch] - s->start_freq[ch];
+        blk1 = blk + 1;
+
+        /* count the number of EXP_REUSE blocks after the current block
+           and set exponent reference block numbers */
+        s->exp_ref_block[ch][blk] = blk;
+        while (blk1 < s->num_blocks && exp_strategy[blk1] == EXP_REUSE) {
+            s->exp_ref_block[ch][blk1] = blk;
+            blk1++;
+        }
+        num_reuse_blocks = blk1 - blk - 1;
 
-            /* for the EXP_REUSE case we select the min of the exponents */
-            s->ac3dsp.ac3_exponent_min(exp-s->start_freq[ch], num_reuse_blocks,
-                                       AC3_MAX_COEFS);
+        /* for the EXP_REUSE case we select the min of the exponents */
+        s->ac3dsp.ac3_exponent_min(exp-s->start_freq[ch], num_reuse_blocks,
+                                   AC3_MAX_COEFS);
 
-            encode_exponents_blk_ch(exp, nb_coefs, exp_strategy[blk], cpl);
+        encode_exponents_blk_ch(exp, nb_coefs, exp_strategy[blk], cpl);
 
-            exp += AC3_MAX_COEFS * (num_reuse_blocks + 1);
-            blk = blk1;
-        }
+        exp += AC3_MAX_COEFS * (num_reuse_blocks + 1);
+        blk = blk1;
     }
-
-    /* reference block numbers have been changed, so reset ref_bap_set */
-    s->ref_bap_set = 0;
 }
 
 
@@ -627,22 +615,78 @@ void ff_ac3_group_exponents(AC3EncodeContext *s)
 }
 
 
+/*
+ * Calculate masking curve of 1 channel based on the final exponents.
+ * Also calculate the power spectral densities to use in future calculations.
+ */
+static void bit_alloc_masking(AC3EncodeContext *s, int ch)
+{
+    int blk;
+
+    for (blk = 0; blk < s->num_blocks; blk++) {
+        AC3Block *block = &s->blocks[blk];
+        if (ch == CPL_CH && !block->cpl_in_use)
+            continue;
+        /* We only need psd and mask for calculating bap.
+           Since we currently do not calculate bap when exponent
+           strategy is EXP_REUSE we do not need to calculate psd or mask. */
+        if (s->exp_strategy[ch][blk] != EXP_REUSE) {
+            ff_ac3_bit_alloc_calc_psd(block->exp[ch], s->start_freq[ch],
+                                      block->end_freq[ch], block->psd[ch],
+                                      block->band_psd[ch]);
+            ff_ac3_bit_alloc_calc_mask(&s->bit_alloc, block->band_psd[ch],
+                                       s->start_freq[ch], block->end_freq[ch],
+                                       ff_ac3_fast_gain_tab[s->fast_gain_code[ch]],
+                                       ch == s->lfe_channel,
+                                       DBA_NONE, 0, NULL, NULL, NULL,
+                                       block->mask[ch]);
+        }
+    }
+}
+
+
+/*
+ * Calculate final exponents and masking curve for 1 channel.
+ * Channels are independent of each other, so they are processed as slices.
+ */
+static int process_exponents_ch(AVCodecContext *avctx, void *arg,
+                                int jobnr, int threadnr)
+{
+    AC3EncodeContext *s = avctx->priv_data;
+    int ch = jobnr + !s->cpl_on;
+
+    extract_exponents(s, ch);
+
+    compute_exp_strategy(s, ch);
+
+    encode_exponents(s, ch);
+
+    bit_alloc_masking(s, ch);
+
+    emms_c();
+    return 0;
+}
+
+
 /**
  * Calculate final exponents from the supplied MDCT coefficients and exponent shift.
  * Extract exponents from MDCT coefficients, calculate exponent strategies,
- * and encode final exponents.
+ * encode final exponents and calculate the masking curves used by the bit
+ * allocation.
  *
  * @param s  AC-3 encoder private context
  */
 void ff_ac3_process_exponents(AC3EncodeContext *s)
 {
-    extract_exponents(s);
-
-    compute_exp_strategy(s);
+    s->avctx->execute2(s->avctx, process_exponents_ch, NULL, NULL,
+                       s->channels + s->cpl_on);
 
-    encode_exponents(s);
+    /* for E-AC-3, determine frame exponent strategy */
+    if (CONFIG_EAC3_ENCODER && s->eac3)
+        ff_eac3_get_frame_exp_strategy(s);
 
-    emms_c();
+    /* reference block numbers have been changed, so reset ref_bap_set */
+    s->ref_bap_set = 0;
 }
 
 
@@ -934,36 +978,6 @@ static void count_frame_bits(AC3EncodeContext *s)
 }
 
 
-/*
- * Calculate masking curve based on the final exponents.
- * Also calculate the power spectral densities to use in future calculations.
- */
-static void bit_alloc_masking(AC3EncodeContext *s)
-{
-    int blk, ch;
-
-    for (blk = 0; blk < s->num_blocks; blk++) {
-        AC3Block *block = &s->blocks[blk];
-        for (ch = !block->cpl_in_use; ch <= s->channels; ch++) {
-            /* We only need psd and mask for calculating bap.
-               Since we currently do not calculate bap when exponent
-               strategy is EXP_REUSE we do not need to calculate psd or mask. */
-            if (s->exp_strategy[ch][blk] != EXP_REUSE) {
-                ff_ac3_bit_alloc_calc_psd(block->exp[ch], s->start_freq[ch],
-                                          block->end_freq[ch], block->psd[ch],
-                                          block->band_psd[ch]);
-                ff_ac3_bit_alloc_calc_mask(&s->bit_alloc, block->band_psd[ch],
-                                           s->start_freq[ch], block->end_freq[ch],
-                                           ff_ac3_fast_gain_tab[s->fast_gain_code[ch]],
-                                           ch == s->lfe_channel,
-                                           DBA_NONE, 0, NULL, NULL, NULL,
-                                           block->mask[ch]);
-            }
-        }
-    }
-}
-
-
 /*
  * Ensure that bap for each block and channel point to the current bap_buffer.
  * They may have been switched during the bit allocation search.
@@ -1008,6 +1022,8 @@ static void count_mantissa_bits_init(uint16_t mant_cnt[AC3_MAX_BLOCKS][16])
 /**
  * Update mantissa bit counts for all blocks in 1 channel in a given bandwidth
  * range.
+ * Blocks reusing the bit allocation pointers of a previous block get the same
+ * counts, so the bap values are only counted once per reference block.
  *
  * @param s                 AC-3 encoder private context
  * @param ch                channel index
@@ -1019,15 +1035,25 @@ static void count_mantissa_bits_update_ch(AC3EncodeContext *s, int ch,
                                           uint16_t mant_cnt[AC3_MAX_BLOCKS][16],
                                           int start, int end)
 {
-    int blk;
+    LOCAL_ALIGNED_16(uint16_t, ref_cnt, [16]);
+    uint8_t *ref_bap = NULL;
+    int blk, i, ref_end = 0;
 
     for (blk = 0; blk < s->num_blocks; blk++) {
         AC3Block *block = &s->blocks[blk];
+        int blk_end;
         if (ch == CPL_CH && !block->cpl_in_use)
             continue;
-        s->ac3dsp.update_bap_counts(mant_cnt[blk],
-                                    s->ref_bap[ch][blk] + start,
-                                    FFMIN(end, block->end_freq[ch]) - start);
+        blk_end = FFMIN(end, block->end_freq[ch]);
+        if (s->ref_bap[ch][blk] != ref_bap || blk_end != ref_end) {
+            ref_bap = s->ref_bap[ch][blk];
+            ref_end = blk_end;
+            memset(ref_cnt, 0, 16 * sizeof(*ref_cnt));
+            s->ac3dsp.update_bap_counts(ref_cnt, ref_bap + start,
+                                        blk_end - start);
+        }
+        for (i = 0; i < 16; i++)
+            mant_cnt[blk][i] += ref_cnt[i];
     }
 }
 
@@ -1149,8 +1175,6 @@ int ff_ac3_compute_bit_allocation(AC3EncodeContext *s)
 
     s->exponent_bits = count_exponent_bits(s);
 
-    bit_alloc_masking(s);
-
     return cbr_bit_allocation(s);
 }
 
@@ -1292,6 +1316,37 @@ static void quantize_mantissas_blk_ch(AC3Mant *s, int32_t *fixed_coef,
 }
 
 
+/*
+ * Quantize mantissas of 1 block.
+ * Mantissa grouping does not cross block boundaries, so blocks are processed
+ * as slices.
+ */
+static int quantize_mantissas_blk(AVCodecContext *avctx, void *arg,
+                                  int blk, int threadnr)
+{
+    AC3EncodeContext *s = avctx->priv_data;
+    AC3Block *block = &s->blocks[blk];
+    AC3Mant m = { 0 };
+    int ch, ch0 = 0, got_cpl;
+
+    got_cpl = !block->cpl_in_use;
+    for (ch = 1; ch <= s->channels; ch++) {
+        if (!got_cpl && ch > 1 && block->channel_in_cpl[ch-1]) {
+            ch0     = ch - 1;
+            ch      = CPL_CH;
+            got_cpl = 1;
+        }
+        quantize_mantissas_blk_ch(&m, block->fixed_coef[ch],
+                                  s->blocks[s->exp_ref_block[ch][blk]].exp[ch],
+                                  s->ref_bap[ch][blk], block->qmant[ch],
+                                  s->start_freq[ch], block->end_freq[ch]);
+        if (ch == CPL_CH)
+            ch = ch0;
+    }
+    return 0;
+}
+
+
 /**
  * Quantize mantissas using coefficients, exponents, and bit allocation pointers.
  *
@@ -1299,27 +1354,8 @@ static void quantize_mantissas_blk_ch(AC3Mant *s, int32_t *fixed_coef,
  */
 void ff_ac3_quantize_mantissas(AC3EncodeContext *s)
 {
-    int blk, ch, ch0=0, got_cpl;
-
-    for (blk = 0; blk < s->num_blocks; blk++) {
-        AC3Block *block = &s->blocks[blk];
-        AC3Mant m = { 0 };
-
-        got_cpl = !block->cpl_in_use;
-        for (ch = 1; ch <= s->channels; ch++) {
-            if (!got_cpl && ch > 1 && block->channel_in_cpl[ch-1]) {
-                ch0     = ch - 1;
-                ch      = CPL_CH;
-                got_cpl = 1;
-            }
-            quantize_mantissas_blk_ch(&m, block->fixed_coef[ch],
-                                      s->blocks[s->exp_ref_block[ch][blk]].exp[ch],
-                                      s->ref_bap[ch][blk], block->qmant[ch],
-                                      s->start_freq[ch], block->end_freq[ch]);
-            if (ch == CPL_CH)
-                ch = ch0;
-        }
-    }
+    s->avctx->execute2(s->avctx, quantize_mantissas_blk, NULL, NULL,
+                       s->num_blocks);
 }
 
 
@@ -2415,6 +2451,9 @@ av_cold int ff_ac3_encode_init(AVCodecContext *avctx)
 
     s->eac3 = avctx->codec_id == AV_CODEC_ID_EAC3;
 
+    s->nb_threads = avctx->active_thread_type & FF_THREAD_SLICE ?
+                    avctx->thread_count : 1;
+
     ret = validate_options(s);
     if (ret)
         return ret;
@@ -168,12 +168,13 @@ typedef struct AC3EncodeContext {
     AVFloatDSPContext *fdsp;
     MECmpContext mecc;
     AC3DSPContext ac3dsp;                   ///< AC-3 optimized functions
-    FFTContext mdct;                        ///< FFT context for MDCT calculation
+    FFTContext *mdct;                       ///< FFT contexts for MDCT calculation, one per thread
     const SampleType *mdct_window;          ///< MDCT window function array
 
     AC3Block blocks[AC3_MAX_BLOCKS];        ///< per-block info
 
     int fixed_point;                        ///< indicates if fixed-point encoder is being used
+    int nb_threads;                         ///< number of threads processing slices of a frame
     int eac3;                               ///< indicates if this is E-AC-3 vs. AC-3
     int bitstream_id;                       ///< bitstream id                           (bsid)
     int bitstream_mode;                     ///< bitstream mode                         (bsmod)
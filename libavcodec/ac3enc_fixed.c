@@ -47,12 +47,12 @@ static const AVClass ac3enc_class = {
  * Normalize the input samples to use the maximum available precision.
  * This assumes signed 16-bit input samples.
  */
-static int normalize_samples(AC3EncodeContext *s)
+static int normalize_samples(AC3EncodeContext *s, int16_t *windowed_samples)
 {
-    int v = s->ac3dsp.ac3_max_msb_abs_int16(s->windowed_samples, AC3_WINDOW_SIZE);
+    int v = s->ac3dsp.ac3_max_msb_abs_int16(windowed_samples, AC3_WINDOW_SIZE);
     v = 14 - av_log2(v);
     if (v > 0)
-        s->ac3dsp.ac3_lshift_int16(s->windowed_samples, AC3_WINDOW_SIZE, v);
+        s->ac3dsp.ac3_lshift_int16(windowed_samples, AC3_WINDOW_SIZE, v);
     /* +6 to right-shift from 31-bit to 25-bit */
     return v + 6;
 }
@@ -117,7 +117,12 @@ static CoefType calc_cpl_coord(CoefSumType energy_ch, CoefSumType energy_cpl)
  */
 av_cold void ff_ac3_fixed_mdct_end(AC3EncodeContext *s)
 {
-    ff_mdct_end(&s->mdct);
+    int i;
+
+    if (s->mdct)
+        for (i = 0; i < s->nb_threads; i++)
+            ff_mdct_end(&s->mdct[i]);
+    av_freep(&s->mdct);
 }
 
 
@@ -129,9 +134,18 @@ av_cold void ff_ac3_fixed_mdct_end(AC3EncodeContext *s)
  */
 av_cold int ff_ac3_fixed_mdct_init(AC3EncodeContext *s)
 {
-    int ret = ff_mdct_init(&s->mdct, 9, 0, -1.0);
+    int i, ret;
+
     s->mdct_window = ff_ac3_window;
-    return ret;
+
+    /* the fixed-point MDCT uses a scratch buffer in its context */
+    if (!(s->mdct = av_mallocz_array(s->nb_threads, sizeof(*s->mdct))))
+        return AVERROR(ENOMEM);
+    for (i = 0; i < s->nb_threads; i++) {
+        if ((ret = ff_mdct_init(&s->mdct[i], 9, 0, -1.0)) < 0)
+            return ret;
+    }
+    return 0;
 }
 
 
@@ -154,6 +168,7 @@ AVCodec ff_ac3_fixed_encoder = {
     .close           = ff_ac3_encode_close,
     .sample_fmts     = (const enum AVSampleFormat[]){ AV_SAMPLE_FMT_S16P,
                                                       AV_SAMPLE_FMT_NONE },
+    .capabilities    = AV_CODEC_CAP_SLICE_THREADS,
     .priv_class      = &ac3enc_class,
     .caps_internal   = FF_CODEC_CAP_INIT_CLEANUP,
     .supported_samplerates = ff_ac3_sample_rate_tab,
@@ -233,6 +233,11 @@ fail:
     return err;
 }
 
+static const CodedBitstreamUnitType decompose_unit_types[] = {
+    AV1_OBU_TEMPORAL_DELIMITER,
+    AV1_OBU_SEQUENCE_HEADER,
+};
+
 static int av1_metadata_init(AVBSFContext *bsf)
 {
     AV1MetadataContext *ctx = bsf->priv_data;
@@ -247,6 +252,12 @@ static int av1_metadata_init(AVBSFContext *bsf)
     if (err < 0)
         return err;
 
+    // Only the sequence header is modified, frame data is passed through.
+    ctx->input->decompose_unit_types    =
+        (CodedBitstreamUnitType*)decompose_unit_types;
+    ctx->input->nb_decompose_unit_types =
+        FF_ARRAY_ELEMS(decompose_unit_types);
+
     if (bsf->par_in->extradata) {
         err = ff_cbs_read_extradata(ctx->input, frag, bsf->par_in);
         if (err < 0) {
@@ -1213,8 +1213,8 @@ static int cbs_h2645_assemble_fragment(CodedBitstreamContext *ctx,
                                        CodedBitstreamFragment *frag)
 {
     uint8_t *data;
-    size_t max_size, dp, sp;
-    int err, i, zero_run;
+    size_t max_size, dp, sp, ep;
+    int err, i;
 
     for (i = 0; i < frag->nb_units; i++) {
         // Data should already all have been written when we get here.
@@ -1259,21 +1259,18 @@ static int cbs_h2645_assemble_fragment(CodedBitstreamContext *ctx,
         data[dp++] = 0;
         data[dp++] = 1;
 
-        zero_run = 0;
-        for (sp = 0; sp < unit->data_size; sp++) {
-            if (zero_run < 2) {
-                if (unit->data[sp] == 0)
-                    ++zero_run;
-                else
-                    zero_run = 0;
-            } else {
-                if ((unit->data[sp] & ~3) == 0) {
-                    // emulation_prevention_three_byte
-                    data[dp++] = 3;
-                }
-                zero_run = unit->data[sp] == 0;
+        for (sp = 0; sp < unit->data_size; sp = ep) {
+            ep = ff_h2645_find_zero_pair(unit->data, sp, unit->data_size);
+            if (ep < unit->data_size)
+                ep += 2;
+
+            memcpy(data + dp, unit->data + sp, ep - sp);
+            dp += ep - sp;
+
+            if (ep < unit->data_size) {
+                // emulation_prevention_three_byte
+                data[dp++] = 3;
             }
-            data[dp++] = unit->data[sp];
         }
     }
 
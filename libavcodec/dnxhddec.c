@@ -27,6 +27,7 @@
 #include "libavutil/imgutils.h"
 #include "avcodec.h"
 #include "blockdsp.h"
+#define CACHED_BITSTREAM_READER !ARCH_X86_32
 #define  UNCHECKED_BITSTREAM_READER 1
 #include "get_bits.h"
 #include "dnxhddata.h"
@@ -25,7 +25,26 @@
 #include "libavutil/imgutils.h"
 #include "bytestream.h"
 #include "avcodec.h"
+#include "dpxdsp.h"
 #include "internal.h"
+#include "thread.h"
+
+typedef struct DPXContext {
+    DPXDSPContext dsp;
+} DPXContext;
+
+typedef struct ThreadData {
+    AVFrame *frame;
+    const uint8_t *buf;
+    int stride;
+    int nb_slices;
+    int bits_per_color;
+    int elements;
+    int packing;
+    int endian;
+    int need_align;
+    int scanity;
+} ThreadData;
 
 static unsigned int read16(const uint8_t **ptr, int is_big)
 {
@@ -116,6 +135,109 @@ static uint16_t read12in32(const uint8_t **ptr, uint32_t *lbuf,
     }
 }
 
+static int decode_slice(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    DPXContext *s = avctx->priv_data;
+    ThreadData *td = arg;
+    AVFrame *p = td->frame;
+    int slice_start = avctx->height *  jobnr      / td->nb_slices;
+    int slice_end   = avctx->height * (jobnr + 1) / td->nb_slices;
+    const uint8_t *buf = td->buf + (ptrdiff_t)slice_start * td->stride;
+    int elements = td->elements, packing = td->packing, endian = td->endian;
+    unsigned int rgbBuffer = 0;
+    int n_datum = 0;
+    uint8_t *ptr[4];
+    int x, y, i;
+
+    for (i = 0; i < 4; i++)
+        ptr[i] = p->data[i] + (ptrdiff_t)slice_start * p->linesize[i];
+
+    switch (td->bits_per_color) {
+    case 10:
+        for (x = slice_start; x < slice_end; x++) {
+            uint16_t *dst[4] = {(uint16_t*)ptr[0],
+                                (uint16_t*)ptr[1],
+                                (uint16_t*)ptr[2],
+                                (uint16_t*)ptr[3]};
+            int shift = elements > 1 ? packing == 1 ? 22 : 20 : packing == 1 ? 2 : 0;
+            if (elements == 3 && !n_datum) {
+                s->dsp.unpack_rgb10[endian](buf, dst[0], dst[1], dst[2],
+                                            avctx->width, shift - 20);
+                buf += 4 * avctx->width;
+            } else {
+            for (y = 0; y < avctx->width; y++) {
+                if (elements >= 3)
+                    *dst[2]++ = read10in32(&buf, &rgbBuffer,
+                                           &n_datum, endian, shift);
+                if (elements == 1)
+                    *dst[0]++ = read10in32_gray(&buf, &rgbBuffer,
+                                                &n_datum, endian, shift);
+                else
+                    *dst[0]++ = read10in32(&buf, &rgbBuffer,
+                                           &n_datum, endian, shift);
+                if (elements >= 2)
+                    *dst[1]++ = read10in32(&buf, &rgbBuffer,
+                                           &n_datum, endian, shift);
+                if (elements == 4)
+                    *dst[3]++ =
+                    read10in32(&buf, &rgbBuffer,
+                               &n_datum, endian, shift);
+            }
+            }
+            if (!td->scanity)
+                n_datum = 0;
+            for (i = 0; i < elements; i++)
+                ptr[i] += p->linesize[i];
+        }
+        break;
+    case 12:
+        for (x = slice_start; x < slice_end; x++) {
+            uint16_t *dst[4] = {(uint16_t*)ptr[0],
+                                (uint16_t*)ptr[1],
+                                (uint16_t*)ptr[2],
+                                (uint16_t*)ptr[3]};
+            int shift = packing == 1 ? 4 : 0;
+            if (elements == 3 && packing == 1) {
+                s->dsp.unpack_rgb12[endian](buf, dst[0], dst[1], dst[2],
+                                            avctx->width);
+                buf += 6 * avctx->width;
+            } else {
+            for (y = 0; y < avctx->width; y++) {
+                if (packing) {
+                    if (elements >= 3)
+                        *dst[2]++ = read16(&buf, endian) >> shift & 0xFFF;
+                    *dst[0]++ = read16(&buf, endian) >> shift & 0xFFF;
+                    if (elements >= 2)
+                        *dst[1]++ = read16(&buf, endian) >> shift & 0xFFF;
+                    if (elements == 4)
+                        *dst[3]++ = read16(&buf, endian) >> shift & 0xFFF;
+                } else {
+                    if (elements >= 3)
+                        *dst[2]++ = read12in32(&buf, &rgbBuffer,
+                                               &n_datum, endian);
+                    *dst[0]++ = read12in32(&buf, &rgbBuffer,
+                                           &n_datum, endian);
+                    if (elements >= 2)
+                        *dst[1]++ = read12in32(&buf, &rgbBuffer,
+                                               &n_datum, endian);
+                    if (elements == 4)
+                        *dst[3]++ = read12in32(&buf, &rgbBuffer,
+                                               &n_datum, endian);
+                }
+            }
+            }
+            n_datum = 0;
+            for (i = 0; i < elements; i++)
+                ptr[i] += p->linesize[i];
+            // Jump to next aligned position
+            buf += td->need_align;
+        }
+        break;
+    }
+
+    return 0;
+}
+
 static int decode_frame(AVCodecContext *avctx,
                         void *data,
                         int *got_frame,
@@ -134,9 +256,8 @@ static int decode_frame(AVCodecContext *avctx,
     int x, y, stride, i, ret;
     int w, h, bits_per_color, descriptor, elements, packing;
     int encoding, need_align = 0;
-
-    unsigned int rgbBuffer = 0;
-    int n_datum = 0;
+    ThreadFrame frame = { .f = data };
+    ThreadData td;
 
     if (avpkt->size <= 1634) {
         av_log(avctx, AV_LOG_ERROR, "Packet too small for DPX header\n");
@@ -379,7 +500,7 @@ static int decode_frame(AVCodecContext *avctx,
 
     ff_set_sar(avctx, avctx->sample_aspect_ratio);
 
-    if ((ret = ff_get_buffer(avctx, p, 0)) < 0)
+    if ((ret = ff_thread_get_buffer(avctx, &frame, 0)) < 0)
         return ret;
 
     av_strlcpy(creator, avpkt->data + 160, 100);
@@ -398,72 +519,22 @@ static int decode_frame(AVCodecContext *avctx,
 
     switch (bits_per_color) {
     case 10:
-        for (x = 0; x < avctx->height; x++) {
-            uint16_t *dst[4] = {(uint16_t*)ptr[0],
-                                (uint16_t*)ptr[1],
-                                (uint16_t*)ptr[2],
-                                (uint16_t*)ptr[3]};
-            int shift = elements > 1 ? packing == 1 ? 22 : 20 : packing == 1 ? 2 : 0;
-            for (y = 0; y < avctx->width; y++) {
-                if (elements >= 3)
-                    *dst[2]++ = read10in32(&buf, &rgbBuffer,
-                                           &n_datum, endian, shift);
-                if (elements == 1)
-                    *dst[0]++ = read10in32_gray(&buf, &rgbBuffer,
-                                                &n_datum, endian, shift);
-                else
-                    *dst[0]++ = read10in32(&buf, &rgbBuffer,
-                                           &n_datum, endian, shift);
-                if (elements >= 2)
-                    *dst[1]++ = read10in32(&buf, &rgbBuffer,
-                                           &n_datum, endian, shift);
-                if (elements == 4)
-                    *dst[3]++ =
-                    read10in32(&buf, &rgbBuffer,
-                               &n_datum, endian, shift);
-            }
-            if (memcmp(input_device, "Scanity", 7))
-                n_datum = 0;
-            for (i = 0; i < elements; i++)
-                ptr[i] += p->linesize[i];
-        }
-        break;
     case 12:
-        for (x = 0; x < avctx->height; x++) {
-            uint16_t *dst[4] = {(uint16_t*)ptr[0],
-                                (uint16_t*)ptr[1],
-                                (uint16_t*)ptr[2],
-                                (uint16_t*)ptr[3]};
-            int shift = packing == 1 ? 4 : 0;
-            for (y = 0; y < avctx->width; y++) {
-                if (packing) {
-                    if (elements >= 3)
-                        *dst[2]++ = read16(&buf, endian) >> shift & 0xFFF;
-                    *dst[0]++ = read16(&buf, endian) >> shift & 0xFFF;
-                    if (elements >= 2)
-                        *dst[1]++ = read16(&buf, endian) >> shift & 0xFFF;
-                    if (elements == 4)
-                        *dst[3]++ = read16(&buf, endian) >> shift & 0xFFF;
-                } else {
-                    if (elements >= 3)
-                        *dst[2]++ = read12in32(&buf, &rgbBuffer,
-                                               &n_datum, endian);
-                    *dst[0]++ = read12in32(&buf, &rgbBuffer,
-                                           &n_datum, endian);
-                    if (elements >= 2)
-                        *dst[1]++ = read12in32(&buf, &rgbBuffer,
-                                               &n_datum, endian);
-                    if (elements == 4)
-                        *dst[3]++ = read12in32(&buf, &rgbBuffer,
-                                               &n_datum, endian);
-                }
-            }
-            n_datum = 0;
-            for (i = 0; i < elements; i++)
-                ptr[i] += p->linesize[i];
-            // Jump to next aligned position
-            buf += need_align;
-        }
+        td.frame          = p;
+        td.buf            = buf;
+        td.stride         = stride;
+        td.bits_per_color = bits_per_color;
+        td.elements       = elements;
+        td.packing        = packing;
+        td.endian         = endian;
+        td.need_align     = need_align;
+        td.scanity        = !memcmp(input_device, "Scanity", 7);
+        /* Scanity files carry the partially used word over to the next
+         * line, so the lines can only be decoded in order */
+        td.nb_slices      = td.scanity && bits_per_color == 10 &&
+                            avctx->width * elements % 3 ? 1 :
+                            av_clip(avctx->thread_count, 1, avctx->height);
+        avctx->execute2(avctx, decode_slice, &td, NULL, td.nb_slices);
         break;
     case 16:
         elements *= 2;
@@ -496,11 +567,23 @@ static int decode_frame(AVCodecContext *avctx,
     return buf_size;
 }
 
+static av_cold int decode_init(AVCodecContext *avctx)
+{
+    DPXContext *s = avctx->priv_data;
+
+    ff_dpxdsp_init(&s->dsp);
+
+    return 0;
+}
+
 AVCodec ff_dpx_decoder = {
     .name           = "dpx",
     .long_name      = NULL_IF_CONFIG_SMALL("DPX (Digital Picture Exchange) image"),
     .type           = AVMEDIA_TYPE_VIDEO,
     .id             = AV_CODEC_ID_DPX,
+    .priv_data_size = sizeof(DPXContext),
+    .init           = decode_init,
     .decode         = decode_frame,
-    .capabilities   = AV_CODEC_CAP_DR1,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_SLICE_THREADS |
+                      AV_CODEC_CAP_FRAME_THREADS,
 };
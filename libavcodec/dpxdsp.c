@@ -0,0 +1,123 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/intreadwrite.h"
+#include "dpxdsp.h"
+
+#define RD16(p) (big_endian ? AV_RB16(p) : AV_RL16(p))
+#define RD32(p) (big_endian ? AV_RB32(p) : AV_RL32(p))
+#define WR16(p, v) do { if (big_endian) AV_WB16(p, v); else AV_WL16(p, v); } while (0)
+#define WR32(p, v) do { if (big_endian) AV_WB32(p, v); else AV_WL32(p, v); } while (0)
+
+static av_always_inline void unpack_rgb10(const uint8_t *src, uint16_t *g,
+                                          uint16_t *b, uint16_t *r,
+                                          int width, int shift, int big_endian)
+{
+    int x;
+
+    for (x = 0; x < width; x++) {
+        uint32_t val = RD32(src + 4 * x) >> shift;
+        r[x] = val >> 20 & 0x3FF;
+        g[x] = val >> 10 & 0x3FF;
+        b[x] = val       & 0x3FF;
+    }
+}
+
+static av_always_inline void unpack_rgb12(const uint8_t *src, uint16_t *g,
+                                          uint16_t *b, uint16_t *r,
+                                          int width, int big_endian)
+{
+    int x;
+
+    for (x = 0; x < width; x++) {
+        r[x] = RD16(src + 6 * x    ) >> 4;
+        g[x] = RD16(src + 6 * x + 2) >> 4;
+        b[x] = RD16(src + 6 * x + 4) >> 4;
+    }
+}
+
+static av_always_inline void pack_rgb10(uint8_t *dst, const uint16_t *g,
+                                        const uint16_t *b, const uint16_t *r,
+                                        int width, int big_endian)
+{
+    int x;
+
+    for (x = 0; x < width; x++) {
+        uint32_t val = (unsigned)RD16(r + x) << 22 |
+                                 RD16(g + x) << 12 |
+                                 RD16(b + x) << 2;
+        WR32(dst + 4 * x, val);
+    }
+}
+
+static av_always_inline void pack_rgb12(uint8_t *dst, const uint16_t *g,
+                                        const uint16_t *b, const uint16_t *r,
+                                        int width, int big_endian)
+{
+    int x;
+
+    for (x = 0; x < width; x++) {
+        WR16(dst + 6 * x,     RD16(r + x) << 4);
+        WR16(dst + 6 * x + 2, RD16(g + x) << 4);
+        WR16(dst + 6 * x + 4, RD16(b + x) << 4);
+    }
+}
+
+#define DEF_FUNCS(suffix, big_endian)                                         \
+static void unpack_rgb10_ ## suffix(const uint8_t *src, uint16_t *g,          \
+                                    uint16_t *b, uint16_t *r,                 \
+                                    int width, int shift)                     \
+{                                                                             \
+    unpack_rgb10(src, g, b, r, width, shift, big_endian);                     \
+}                                                                             \
+                                                                              \
+static void unpack_rgb12_ ## suffix(const uint8_t *src, uint16_t *g,          \
+                                    uint16_t *b, uint16_t *r, int width)      \
+{                                                                             \
+    unpack_rgb12(src, g, b, r, width, big_endian);                            \
+}                                                                             \
+                                                                              \
+static void pack_rgb10_ ## suffix(uint8_t *dst, const uint16_t *g,            \
+                                  const uint16_t *b, const uint16_t *r,       \
+                                  int width)                                  \
+{                                                                             \
+    pack_rgb10(dst, g, b, r, width, big_endian);                              \
+}                                                                             \
+                                                                              \
+static void pack_rgb12_ ## suffix(uint8_t *dst, const uint16_t *g,            \
+                                  const uint16_t *b, const uint16_t *r,       \
+                                  int width)                                  \
+{                                                                             \
+    pack_rgb12(dst, g, b, r, width, big_endian);                              \
+}
+
+DEF_FUNCS(le, 0)
+DEF_FUNCS(be, 1)
+
+av_cold void ff_dpxdsp_init(DPXDSPContext *c)
+{
+    c->unpack_rgb10[0] = unpack_rgb10_le;
+    c->unpack_rgb10[1] = unpack_rgb10_be;
+    c->unpack_rgb12[0] = unpack_rgb12_le;
+    c->unpack_rgb12[1] = unpack_rgb12_be;
+    c->pack_rgb10[0]   = pack_rgb10_le;
+    c->pack_rgb10[1]   = pack_rgb10_be;
+    c->pack_rgb12[0]   = pack_rgb12_le;
+    c->pack_rgb12[1]   = pack_rgb12_be;
+}
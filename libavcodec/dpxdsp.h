@@ -0,0 +1,61 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_DPXDSP_H
+#define AVCODEC_DPXDSP_H
+
+#include <stdint.h>
+
+/**
+ * Row conversions between DPX packed RGB and planar GBR, the functions are
+ * indexed by the byte order of the DPX data: [0] little-endian, [1] big-endian.
+ */
+typedef struct DPXDSPContext {
+    /**
+     * Unpack 10-bit RGB pixels stored in one 32-bit word each, R in the most
+     * significant bits, with shift padding bits at the bottom of the word
+     * (2 for packing method A, 0 for method B).
+     */
+    void (*unpack_rgb10[2])(const uint8_t *src, uint16_t *g, uint16_t *b,
+                            uint16_t *r, int width, int shift);
+
+    /**
+     * Unpack 12-bit RGB pixels stored in the 12 most significant bits of
+     * 16-bit words (packing method A).
+     */
+    void (*unpack_rgb12[2])(const uint8_t *src, uint16_t *g, uint16_t *b,
+                            uint16_t *r, int width);
+
+    /**
+     * Pack 10-bit planar samples, stored in the byte order of the output,
+     * into 32-bit words with packing method A.
+     */
+    void (*pack_rgb10[2])(uint8_t *dst, const uint16_t *g, const uint16_t *b,
+                          const uint16_t *r, int width);
+
+    /**
+     * Pack 12-bit planar samples, stored in the byte order of the output,
+     * into 16-bit words with packing method A.
+     */
+    void (*pack_rgb12[2])(uint8_t *dst, const uint16_t *g, const uint16_t *b,
+                          const uint16_t *r, int width);
+} DPXDSPContext;
+
+void ff_dpxdsp_init(DPXDSPContext *c);
+
+#endif /* AVCODEC_DPXDSP_H */
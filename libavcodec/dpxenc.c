@@ -23,6 +23,7 @@
 #include "libavutil/intreadwrite.h"
 #include "libavutil/imgutils.h"
 #include "avcodec.h"
+#include "dpxdsp.h"
 #include "internal.h"
 
 typedef struct DPXContext {
@@ -31,8 +32,15 @@ typedef struct DPXContext {
     int num_components;
     int descriptor;
     int planar;
+    DPXDSPContext dsp;
 } DPXContext;
 
+typedef struct ThreadData {
+    const AVFrame *pic;
+    uint8_t *dst;
+    int nb_slices;
+} ThreadData;
+
 static av_cold int encode_init(AVCodecContext *avctx)
 {
     DPXContext *s = avctx->priv_data;
@@ -72,6 +80,8 @@ static av_cold int encode_init(AVCodecContext *avctx)
         return -1;
     }
 
+    ff_dpxdsp_init(&s->dsp);
+
     return 0;
 }
 
@@ -91,13 +101,14 @@ static av_always_inline void write32_internal(int big_endian, void *p, int value
 #define write32(p, value) write32_internal(s->big_endian, p, value)
 
 static void encode_rgb48_10bit(AVCodecContext *avctx, const AVFrame *pic,
-                               uint8_t *dst)
+                               uint8_t *dst, int slice_start, int slice_end)
 {
     DPXContext *s = avctx->priv_data;
-    const uint8_t *src = pic->data[0];
+    const uint8_t *src = pic->data[0] + slice_start * pic->linesize[0];
     int x, y;
 
-    for (y = 0; y < avctx->height; y++) {
+    dst += slice_start * avctx->width * 4;
+    for (y = slice_start; y < slice_end; y++) {
         for (x = 0; x < avctx->width; x++) {
             int value;
             if (s->big_endian) {
@@ -116,69 +127,65 @@ static void encode_rgb48_10bit(AVCodecContext *avctx, const AVFrame *pic,
     }
 }
 
-static void encode_gbrp10(AVCodecContext *avctx, const AVFrame *pic, uint8_t *dst)
+static void encode_gbrp10(AVCodecContext *avctx, const AVFrame *pic,
+                          uint8_t *dst, int slice_start, int slice_end)
 {
     DPXContext *s = avctx->priv_data;
-    const uint8_t *src[3] = {pic->data[0], pic->data[1], pic->data[2]};
-    int x, y, i;
+    int y;
 
-    for (y = 0; y < avctx->height; y++) {
-        for (x = 0; x < avctx->width; x++) {
-            int value;
-            if (s->big_endian) {
-                value = (AV_RB16(src[0] + 2*x) << 12)
-                      | (AV_RB16(src[1] + 2*x) << 2)
-                      | ((unsigned)AV_RB16(src[2] + 2*x) << 22);
-            } else {
-                value = (AV_RL16(src[0] + 2*x) << 12)
-                      | (AV_RL16(src[1] + 2*x) << 2)
-                      | ((unsigned)AV_RL16(src[2] + 2*x) << 22);
-            }
-            write32(dst, value);
-            dst += 4;
-        }
-        for (i = 0; i < 3; i++)
-            src[i] += pic->linesize[i];
+    dst += slice_start * avctx->width * 4;
+    for (y = slice_start; y < slice_end; y++) {
+        s->dsp.pack_rgb10[s->big_endian](dst,
+            (const uint16_t *)(pic->data[0] + y * pic->linesize[0]),
+            (const uint16_t *)(pic->data[1] + y * pic->linesize[1]),
+            (const uint16_t *)(pic->data[2] + y * pic->linesize[2]),
+            avctx->width);
+        dst += avctx->width * 4;
     }
 }
 
-static void encode_gbrp12(AVCodecContext *avctx, const AVFrame *pic, uint16_t *dst)
+static void encode_gbrp12(AVCodecContext *avctx, const AVFrame *pic,
+                          uint8_t *dst, int slice_start, int slice_end)
 {
     DPXContext *s = avctx->priv_data;
-    const uint16_t *src[3] = {(uint16_t*)pic->data[0],
-                              (uint16_t*)pic->data[1],
-                              (uint16_t*)pic->data[2]};
-    int x, y, i, pad;
-    pad = avctx->width*6;
-    pad = (FFALIGN(pad, 4) - pad) >> 1;
-    for (y = 0; y < avctx->height; y++) {
-        for (x = 0; x < avctx->width; x++) {
-            uint16_t value[3];
-            if (s->big_endian) {
-                value[1] = AV_RB16(src[0] + x) << 4;
-                value[2] = AV_RB16(src[1] + x) << 4;
-                value[0] = AV_RB16(src[2] + x) << 4;
-            } else {
-                value[1] = AV_RL16(src[0] + x) << 4;
-                value[2] = AV_RL16(src[1] + x) << 4;
-                value[0] = AV_RL16(src[2] + x) << 4;
-            }
-            for (i = 0; i < 3; i++)
-                write16(dst++, value[i]);
-        }
-        for (i = 0; i < pad; i++)
-            *dst++ = 0;
-        for (i = 0; i < 3; i++)
-            src[i] += pic->linesize[i]/2;
+    int y, len = avctx->width * 6, size = FFALIGN(len, 4);
+
+    dst += slice_start * size;
+    for (y = slice_start; y < slice_end; y++) {
+        s->dsp.pack_rgb12[s->big_endian](dst,
+            (const uint16_t *)(pic->data[0] + y * pic->linesize[0]),
+            (const uint16_t *)(pic->data[1] + y * pic->linesize[1]),
+            (const uint16_t *)(pic->data[2] + y * pic->linesize[2]),
+            avctx->width);
+        memset(dst + len, 0, size - len);
+        dst += size;
     }
 }
 
+static int encode_slice(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    DPXContext *s = avctx->priv_data;
+    ThreadData *td = arg;
+    int slice_start = avctx->height *  jobnr      / td->nb_slices;
+    int slice_end   = avctx->height * (jobnr + 1) / td->nb_slices;
+
+    if (s->bits_per_component == 12)
+        encode_gbrp12(avctx, td->pic, td->dst, slice_start, slice_end);
+    else if (s->planar)
+        encode_gbrp10(avctx, td->pic, td->dst, slice_start, slice_end);
+    else
+        encode_rgb48_10bit(avctx, td->pic, td->dst, slice_start, slice_end);
+
+    return 0;
+}
+
 static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                         const AVFrame *frame, int *got_packet)
 {
     DPXContext *s = avctx->priv_data;
     int size, ret, need_align, len;
     uint8_t *buf;
+    ThreadData td;
 
 #define HEADER_SIZE 1664  /* DPX Generic header */
     if (s->bits_per_component == 10)
@@ -253,13 +260,11 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
             return size;
         break;
     case 10:
-        if (s->planar)
-            encode_gbrp10(avctx, frame, buf + HEADER_SIZE);
-        else
-            encode_rgb48_10bit(avctx, frame, buf + HEADER_SIZE);
-        break;
     case 12:
-        encode_gbrp12(avctx, frame, (uint16_t*)(buf + HEADER_SIZE));
+        td.pic       = frame;
+        td.dst       = buf + HEADER_SIZE;
+        td.nb_slices = av_clip(avctx->thread_count, 1, avctx->height);
+        avctx->execute2(avctx, encode_slice, &td, NULL, td.nb_slices);
         break;
     default:
         av_log(avctx, AV_LOG_ERROR, "Unsupported bit depth: %d\n", s->bits_per_component);
@@ -284,6 +289,7 @@ AVCodec ff_dpx_encoder = {
     .priv_data_size = sizeof(DPXContext),
     .init           = encode_init,
     .encode2        = encode_frame,
+    .capabilities   = AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS,
     .pix_fmts       = (const enum AVPixelFormat[]){
         AV_PIX_FMT_GRAY8,
         AV_PIX_FMT_RGB24,    AV_PIX_FMT_RGBA, AV_PIX_FMT_ABGR,
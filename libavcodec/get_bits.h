@@ -118,6 +118,13 @@ static inline unsigned int show_bits(GetBitContext *s, int n);
  *   Return the number of bits left
  *
  * For examples see get_bits, show_bits, skip_bits, get_vlc.
+ *
+ * With CACHED_BITSTREAM_READER, the macros work directly on the 64-bit
+ * cache of the context, so that decoders written with them can switch
+ * readers by defining it. UPDATE_CACHE only refills the cache when less
+ * than 32 bits are left in it, and no more than 32 bits may be used
+ * between two UPDATE_CACHE. SKIP_COUNTER is a no-op, so SKIP_CACHE must
+ * always be used to consume bits.
  */
 
 #if CACHED_BITSTREAM_READER
@@ -214,6 +221,55 @@ static inline unsigned int show_bits(GetBitContext *s, int n);
 
 #define GET_CACHE(name, gb) ((uint32_t) name ## _cache)
 
+#else /* CACHED_BITSTREAM_READER */
+
+#define OPEN_READER_NOSIZE(name, gb) \
+    GetBitContext av_unused *const name ## _gb = (gb)
+
+#define OPEN_READER(name, gb) OPEN_READER_NOSIZE(name, gb)
+
+#define CLOSE_READER(name, gb) do { } while (0)
+
+#ifdef BITSTREAM_READER_LE
+
+# define UPDATE_CACHE(name, gb)                 \
+    do {                                        \
+        if ((gb)->bits_left < 32)               \
+            refill_32(gb, 1);                   \
+    } while (0)
+
+# define GET_CACHE(name, gb) ((uint32_t)(gb)->cache)
+
+# define SHOW_SBITS(name, gb, num) sign_extend(show_val(gb, num), num)
+
+#else
+
+# define UPDATE_CACHE(name, gb)                 \
+    do {                                        \
+        if ((gb)->bits_left < 32)               \
+            refill_32(gb, 0);                   \
+    } while (0)
+
+# define GET_CACHE(name, gb) ((uint32_t)((gb)->cache >> 32))
+
+# define SHOW_SBITS(name, gb, num) ((int)((int64_t)(gb)->cache >> (64 - (num))))
+
+#endif
+
+#define SHOW_UBITS(name, gb, num) show_val(gb, num)
+
+#define SKIP_CACHE(name, gb, num) skip_remaining(gb, num)
+
+#define SKIP_COUNTER(name, gb, num) do { } while (0)
+
+#define SKIP_BITS(name, gb, num) skip_remaining(gb, num)
+
+#define LAST_SKIP_BITS(name, gb, num) skip_remaining(gb, num)
+
+#define BITS_AVAILABLE(name, gb) (get_bits_count(gb) < (gb)->size_in_bits_plus8)
+
+#define BITS_LEFT(name, gb) ((int)((gb)->size_in_bits - get_bits_count(gb)))
+
 #endif
 
 static inline int get_bits_count(const GetBitContext *s)
@@ -226,19 +282,27 @@ static inline int get_bits_count(const GetBitContext *s)
 }
 
 #if CACHED_BITSTREAM_READER
+/**
+ * Refill the cache with as many whole bytes as fit, at least 32 bits if
+ * no more than 32 bits are left in it.
+ * This loads 64 bits at once, the bits below the new bits_left are the
+ * following bytes of the stream and are loaded again by the next refill.
+ */
 static inline void refill_32(GetBitContext *s, int is_le)
 {
+    unsigned bits = (64 - s->bits_left) & ~7;
+
 #if !UNCHECKED_BITSTREAM_READER
     if (s->index >> 3 >= s->buffer_end - s->buffer)
         return;
 #endif
 
     if (is_le)
-        s->cache = (uint64_t)AV_RL32(s->buffer + (s->index >> 3)) << s->bits_left | s->cache;
+        s->cache = AV_RL64(s->buffer + (s->index >> 3)) << s->bits_left | s->cache;
     else
-        s->cache = s->cache | (uint64_t)AV_RB32(s->buffer + (s->index >> 3)) << (32 - s->bits_left);
-    s->index     += 32;
-    s->bits_left += 32;
+        s->cache = s->cache | AV_RB64(s->buffer + (s->index >> 3)) >> s->bits_left;
+    s->index     += bits;
+    s->bits_left += bits;
 }
 
 static inline void refill_64(GetBitContext *s, int is_le)
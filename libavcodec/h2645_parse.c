@@ -31,110 +31,74 @@
 #include "h264.h"
 #include "h2645_parse.h"
 
-int ff_h2645_extract_rbsp(const uint8_t *src, int length,
-                          H2645RBSP *rbsp, H2645NAL *nal, int small_padding)
+/**
+ * @param src_end end of the input buffer, the data between the end of the NAL
+ *                and src_end can be used as padding when it is not copied
+ */
+static int extract_rbsp(const uint8_t *src, int length, const uint8_t *src_end,
+                        H2645RBSP *rbsp, H2645NAL *nal, int small_padding)
 {
     int i, si, di;
     uint8_t *dst;
 
     nal->skipped_bytes = 0;
-#define STARTCODE_TEST                                                  \
-        if (i + 2 < length && src[i + 1] == 0 && src[i + 2] <= 3) {     \
-            if (src[i + 2] != 3 && src[i + 2] != 0) {                   \
-                /* startcode, so we must be past the end */             \
-                length = i;                                             \
-            }                                                           \
-            break;                                                      \
-        }
-#if HAVE_FAST_UNALIGNED
-#define FIND_FIRST_ZERO                                                 \
-        if (i > 0 && !src[i])                                           \
-            i--;                                                        \
-        while (src[i])                                                  \
-            i++
-#if HAVE_FAST_64BIT
-    for (i = 0; i + 1 < length; i += 9) {
-        if (!((~AV_RN64(src + i) &
-               (AV_RN64(src + i) - 0x0100010001000101ULL)) &
-              0x8000800080008080ULL))
-            continue;
-        FIND_FIRST_ZERO;
-        STARTCODE_TEST;
-        i -= 7;
-    }
-#else
-    for (i = 0; i + 1 < length; i += 5) {
-        if (!((~AV_RN32(src + i) &
-               (AV_RN32(src + i) - 0x01000101U)) &
-              0x80008080U))
-            continue;
-        FIND_FIRST_ZERO;
-        STARTCODE_TEST;
-        i -= 3;
-    }
-#endif /* HAVE_FAST_64BIT */
-#else
-    for (i = 0; i + 1 < length; i += 2) {
-        if (src[i])
-            continue;
-        if (i > 0 && src[i - 1] == 0)
-            i--;
-        STARTCODE_TEST;
+
+    /* runs of zeros are kept as they are, only escapes need a copy */
+    i = ff_h2645_find_zero_pair(src, 0, length);
+    while (i < length && !src[i + 2])
+        i = ff_h2645_find_zero_pair(src, i + 1, length);
+    if (i < length && src[i + 2] != 3) {
+        /* startcode, so we must be past the end */
+        length = i;
     }
-#endif /* HAVE_FAST_UNALIGNED */
 
-    if (i >= length - 1 && small_padding) { // no escaped 0
+    if (i >= length && (small_padding ||
+                        src_end - (src + length) >= MAX_MBPAIR_SIZE)) { // no escaped 0
         nal->data     =
         nal->raw_data = src;
         nal->size     =
         nal->raw_size = length;
         return length;
-    } else if (i > length)
-        i = length;
+    }
 
     nal->rbsp_buffer = &rbsp->rbsp_buffer[rbsp->rbsp_buffer_size];
     dst = nal->rbsp_buffer;
 
-    memcpy(dst, src, i);
-    si = di = i;
-    while (si + 2 < length) {
-        // remove escapes (very rare 1:2^22)
-        if (src[si + 2] > 3) {
-            dst[di++] = src[si++];
-            dst[di++] = src[si++];
-        } else if (src[si] == 0 && src[si + 1] == 0 && src[si + 2] != 0) {
-            if (src[si + 2] == 3) { // escape
-                dst[di++] = 0;
-                dst[di++] = 0;
-                si       += 3;
-
-                if (nal->skipped_bytes_pos) {
-                    nal->skipped_bytes++;
-                    if (nal->skipped_bytes_pos_size < nal->skipped_bytes) {
-                        nal->skipped_bytes_pos_size *= 2;
-                        av_assert0(nal->skipped_bytes_pos_size >= nal->skipped_bytes);
-                        av_reallocp_array(&nal->skipped_bytes_pos,
-                                nal->skipped_bytes_pos_size,
-                                sizeof(*nal->skipped_bytes_pos));
-                        if (!nal->skipped_bytes_pos) {
-                            nal->skipped_bytes_pos_size = 0;
-                            return AVERROR(ENOMEM);
-                        }
+    // remove escapes (very rare 1:2^22), copying the data between them
+    si = di = 0;
+    while (i < length) {
+        if (src[i + 2] == 3) { // escape
+            memcpy(dst + di, src + si, i + 2 - si);
+            di += i + 2 - si;
+            si  = i + 3;
+
+            if (nal->skipped_bytes_pos) {
+                nal->skipped_bytes++;
+                if (nal->skipped_bytes_pos_size < nal->skipped_bytes) {
+                    nal->skipped_bytes_pos_size *= 2;
+                    av_assert0(nal->skipped_bytes_pos_size >= nal->skipped_bytes);
+                    av_reallocp_array(&nal->skipped_bytes_pos,
+                            nal->skipped_bytes_pos_size,
+                            sizeof(*nal->skipped_bytes_pos));
+                    if (!nal->skipped_bytes_pos) {
+                        nal->skipped_bytes_pos_size = 0;
+                        return AVERROR(ENOMEM);
                     }
-                    if (nal->skipped_bytes_pos)
-                        nal->skipped_bytes_pos[nal->skipped_bytes-1] = di - 1;
                 }
-                continue;
-            } else // next start code
-                goto nsc;
+                if (nal->skipped_bytes_pos)
+                    nal->skipped_bytes_pos[nal->skipped_bytes-1] = di - 1;
+            }
+            i = ff_h2645_find_zero_pair(src, si, length);
+        } else if (src[i + 2] != 0) { // next start code
+            length = i;
+        } else {
+            i = ff_h2645_find_zero_pair(src, i + 1, length);
         }
-
-        dst[di++] = src[si++];
     }
-    while (si < length)
-        dst[di++] = src[si++];
+    memcpy(dst + di, src + si, length - si);
+    di += length - si;
+    si  = length;
 
-nsc:
     memset(dst + di, 0, AV_INPUT_BUFFER_PADDING_SIZE);
 
     nal->data = dst;
@@ -146,6 +110,12 @@ nsc:
     return si;
 }
 
+int ff_h2645_extract_rbsp(const uint8_t *src, int length,
+                          H2645RBSP *rbsp, H2645NAL *nal, int small_padding)
+{
+    return extract_rbsp(src, length, src + length, rbsp, nal, small_padding);
+}
+
 static const char *hevc_nal_type_name[64] = {
     "TRAIL_N", // HEVC_NAL_TRAIL_N
     "TRAIL_R", // HEVC_NAL_TRAIL_R
@@ -329,17 +299,18 @@ static int h264_parse_nal_header(H2645NAL *nal, void *logctx)
 
 static int find_next_start_code(const uint8_t *buf, const uint8_t *next_avc)
 {
+    int size = next_avc - buf;
     int i = 0;
 
-    if (buf + 3 >= next_avc)
-        return next_avc - buf;
+    if (size <= 3)
+        return size;
 
-    while (buf + i + 3 < next_avc) {
-        if (buf[i] == 0 && buf[i + 1] == 0 && buf[i + 2] == 1)
-            break;
+    while ((i = ff_h2645_find_zero_pair(buf, i, size - 1)) < size - 1) {
+        if (buf[i + 2] == 1)
+            return i + 3;
         i++;
     }
-    return i + 3;
+    return size;
 }
 
 static void alloc_rbsp_buffer(H2645RBSP *rbsp, unsigned int size, int use_ref)
@@ -476,7 +447,8 @@ int ff_h2645_packet_split(H2645Packet *pkt, const uint8_t *buf, int length,
         }
         nal = &pkt->nals[pkt->nb_nals];
 
-        consumed = ff_h2645_extract_rbsp(bc.buffer, extract_length, &pkt->rbsp, nal, small_padding);
+        consumed = extract_rbsp(bc.buffer, extract_length, buf + length,
+                                &pkt->rbsp, nal, small_padding);
         if (consumed < 0)
             return consumed;
 
@@ -24,6 +24,7 @@
 #include <stdint.h>
 
 #include "libavutil/buffer.h"
+#include "libavutil/intreadwrite.h"
 #include "avcodec.h"
 #include "get_bits.h"
 
@@ -135,4 +136,60 @@ static inline int get_nalsize(int nal_length_size, const uint8_t *buf,
     return nalsize;
 }
 
+/**
+ * Find the first 00 00 xx sequence with xx <= 3 at or after position i,
+ * which is either an escape, a start code or a run of zeros.
+ * src must be followed by at least 8 bytes of padding.
+ *
+ * @return its position, or length if there is none
+ */
+static av_always_inline int ff_h2645_find_zero_pair(const uint8_t *src, int i, int length)
+{
+    const int start = i;
+
+#define ZERO_PAIR_TEST                                                  \
+        if (i + 2 < length && src[i + 1] == 0 && src[i + 2] <= 3)       \
+            return i;
+#if HAVE_FAST_UNALIGNED
+#define FIND_FIRST_ZERO                                                 \
+        if (i > start && !src[i])                                       \
+            i--;                                                        \
+        while (src[i])                                                  \
+            i++
+#if HAVE_FAST_64BIT
+    for (; i + 1 < length; i += 9) {
+        if (!((~AV_RN64(src + i) &
+               (AV_RN64(src + i) - 0x0100010001000101ULL)) &
+              0x8000800080008080ULL))
+            continue;
+        FIND_FIRST_ZERO;
+        ZERO_PAIR_TEST;
+        i -= 7;
+    }
+#else
+    for (; i + 1 < length; i += 5) {
+        if (!((~AV_RN32(src + i) &
+               (AV_RN32(src + i) - 0x01000101U)) &
+              0x80008080U))
+            continue;
+        FIND_FIRST_ZERO;
+        ZERO_PAIR_TEST;
+        i -= 3;
+    }
+#endif /* HAVE_FAST_64BIT */
+#else
+    for (; i + 1 < length; i += 2) {
+        if (src[i])
+            continue;
+        if (i > start && src[i - 1] == 0)
+            i--;
+        ZERO_PAIR_TEST;
+    }
+#endif /* HAVE_FAST_UNALIGNED */
+
+    return length;
+#undef FIND_FIRST_ZERO
+#undef ZERO_PAIR_TEST
+}
+
 #endif /* AVCODEC_H2645_PARSE_H */
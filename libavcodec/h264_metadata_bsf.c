@@ -621,6 +621,13 @@ fail:
     return err;
 }
 
+static const CodedBitstreamUnitType decompose_unit_types[] = {
+    H264_NAL_SPS,
+    H264_NAL_PPS,
+    H264_NAL_SLICE,
+    H264_NAL_IDR_SLICE,
+};
+
 static int h264_metadata_init(AVBSFContext *bsf)
 {
     H264MetadataContext *ctx = bsf->priv_data;
@@ -634,6 +641,18 @@ static int h264_metadata_init(AVBSFContext *bsf)
     if (err < 0)
         return err;
 
+    // SEI messages are parsed with the SPS activated by the slices, so
+    // everything is decomposed when they are needed.  Otherwise only
+    // the parameter sets (and the slices to find the AUD picture type)
+    // are, and all other NAL units are passed through unchanged.
+    if (!ctx->sei_user_data && !ctx->delete_filler &&
+        ctx->display_orientation == PASS) {
+        ctx->input->decompose_unit_types    =
+            (CodedBitstreamUnitType*)decompose_unit_types;
+        ctx->input->nb_decompose_unit_types =
+            ctx->aud == INSERT ? FF_ARRAY_ELEMS(decompose_unit_types) : 2;
+    }
+
     if (bsf->par_in->extradata) {
         err = ff_cbs_read_extradata(ctx->input, au, bsf->par_in);
         if (err < 0) {
@@ -490,6 +490,12 @@ fail:
     return err;
 }
 
+static const CodedBitstreamUnitType decompose_unit_types[] = {
+    HEVC_NAL_VPS,
+    HEVC_NAL_SPS,
+    HEVC_NAL_PPS,
+};
+
 static int h265_metadata_init(AVBSFContext *bsf)
 {
     H265MetadataContext *ctx = bsf->priv_data;
@@ -503,6 +509,16 @@ static int h265_metadata_init(AVBSFContext *bsf)
     if (err < 0)
         return err;
 
+    // Inserting an AUD needs the headers of all NAL units, otherwise
+    // only the parameter sets are decomposed and all other NAL units
+    // are passed through unchanged.
+    if (ctx->aud != INSERT) {
+        ctx->input->decompose_unit_types    =
+            (CodedBitstreamUnitType*)decompose_unit_types;
+        ctx->input->nb_decompose_unit_types =
+            FF_ARRAY_ELEMS(decompose_unit_types);
+    }
+
     if (bsf->par_in->extradata) {
         err = ff_cbs_read_extradata(ctx->input, au, bsf->par_in);
         if (err < 0) {
@@ -1524,9 +1524,7 @@ void ff_hevc_hls_residual_coding(HEVCContext *s, int x0, int y0,
     if (lc->tu.cross_pf) {
         int16_t *coeffs_y = (int16_t*)lc->edge_emu_buffer;
 
-        for (i = 0; i < (trafo_size * trafo_size); i++) {
-            coeffs[i] = coeffs[i] + ((lc->tu.res_scale_val * coeffs_y[i]) >> 3);
-        }
+        s->hevcdsp.cross_component_pred(coeffs, coeffs_y, lc->tu.res_scale_val, log2_trafo_size);
     }
     s->hevcdsp.add_residual[log2_trafo_size-2](dst, coeffs, stride);
 }
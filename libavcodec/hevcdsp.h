@@ -52,6 +52,9 @@ typedef struct HEVCDSPContext {
 
     void (*transform_rdpcm)(int16_t *coeffs, int16_t log2_size, int mode);
 
+    void (*cross_component_pred)(int16_t *coeffs, const int16_t *coeffs_y,
+                                 int res_scale_val, int16_t log2_size);
+
     void (*transform_4x4_luma)(int16_t *coeffs);
 
     void (*idct[4])(int16_t *coeffs, int col_limit);
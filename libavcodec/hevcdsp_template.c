@@ -104,6 +104,16 @@ static void FUNC(transform_rdpcm)(int16_t *_coeffs, int16_t log2_size, int mode)
     }
 }
 
+static void FUNC(cross_component_pred)(int16_t *coeffs, const int16_t *coeffs_y,
+                                       int res_scale_val, int16_t log2_size)
+{
+    int i;
+    int size = 1 << log2_size;
+
+    for (i = 0; i < size * size; i++)
+        coeffs[i] += (res_scale_val * coeffs_y[i]) >> 3;
+}
+
 static void FUNC(dequant)(int16_t *coeffs, int16_t log2_size)
 {
     int shift  = 15 - BIT_DEPTH - log2_size;
@@ -74,6 +74,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/avstring.h"
+#include "libavutil/qsort.h"
 
 #define NMSEDEC_BITS 7
 #define NMSEDEC_FRACBITS (NMSEDEC_BITS-1)
@@ -105,6 +106,15 @@ typedef struct {
    double *layer_rates;
 } Jpeg2000Tile;
 
+/** a row of code-blocks of a band, the unit of work of tier-1 coding */
+typedef struct Jpeg2000CblkRow {
+    int tileno;
+    int compno;
+    int reslevelno;
+    int bandno;
+    int cblky;
+} Jpeg2000CblkRow;
+
 typedef struct {
     AVClass *class;
     AVCodecContext *avctx;
@@ -129,6 +139,12 @@ typedef struct {
     Jpeg2000QuantStyle  qntsty;
 
     Jpeg2000Tile *tile;
+    Jpeg2000CblkRow *cblk_rows;
+    int nb_cblk_rows;
+    int *job_ret;          ///< return value of each job run by execute2()
+    double *slopes;        ///< rate-distortion slopes of the passes of a tile
+    unsigned int slopes_size;
+    Jpeg2000T1Context *t1; ///< tier-1 context of each thread
     int layer_rates[100];
     uint8_t compression_rate_enc; ///< Is compression done using compression ratio?
 
@@ -445,6 +461,81 @@ static void compute_rates(Jpeg2000EncoderContext* s)
 
 }
 
+static int alloc_cblks(Jpeg2000Component *comp, Jpeg2000CodingStyle *codsty)
+{
+    int reslevelno, bandno, cblkno;
+
+    for (reslevelno = 0; reslevelno < codsty->nreslevels; reslevelno++) {
+        Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+
+        for (bandno = 0; bandno < reslevel->nbands; bandno++) {
+            Jpeg2000Prec *prec = reslevel->band[bandno].prec;
+
+            for (cblkno = 0; cblkno < prec->nb_codeblocks_width * prec->nb_codeblocks_height; cblkno++) {
+                Jpeg2000Cblk *cblk = prec->cblk + cblkno;
+
+                cblk->data   = av_malloc(1 + 8192);
+                cblk->passes = av_malloc_array(JPEG2000_MAX_PASSES, sizeof(*cblk->passes));
+                if (!cblk->data || !cblk->passes)
+                    return AVERROR(ENOMEM);
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * list the code-block rows of all the bands, so that they can be coded
+ * in parallel
+ */
+static int init_cblk_rows(Jpeg2000EncoderContext *s)
+{
+    int tileno, compno, reslevelno, bandno, cblky, n;
+
+    for (n = 0; n < 2; n++) {
+        s->nb_cblk_rows = 0;
+        for (tileno = 0; tileno < s->numXtiles * s->numYtiles; tileno++) {
+            for (compno = 0; compno < s->ncomponents; compno++) {
+                Jpeg2000Component *comp = s->tile[tileno].comp + compno;
+
+                for (reslevelno = 0; reslevelno < s->codsty.nreslevels; reslevelno++) {
+                    Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+
+                    for (bandno = 0; bandno < reslevel->nbands; bandno++) {
+                        Jpeg2000Band *band = reslevel->band + bandno;
+
+                        if (band->coord[0][0] == band->coord[0][1] || band->coord[1][0] == band->coord[1][1])
+                            continue;
+
+                        for (cblky = 0; cblky < band->prec->nb_codeblocks_height; cblky++) {
+                            if (s->cblk_rows) {
+                                Jpeg2000CblkRow *row = s->cblk_rows + s->nb_cblk_rows;
+                                row->tileno     = tileno;
+                                row->compno     = compno;
+                                row->reslevelno = reslevelno;
+                                row->bandno     = bandno;
+                                row->cblky      = cblky;
+                            }
+                            s->nb_cblk_rows++;
+                        }
+                    }
+                }
+            }
+        }
+        if (!s->cblk_rows) {
+            s->cblk_rows = av_malloc_array(FFMAX(s->nb_cblk_rows, 1), sizeof(*s->cblk_rows));
+            if (!s->cblk_rows)
+                return AVERROR(ENOMEM);
+        }
+    }
+    s->job_ret = av_malloc_array(FFMAX3(s->nb_cblk_rows, 1,
+                                        s->numXtiles * s->numYtiles * s->ncomponents),
+                                 sizeof(*s->job_ret));
+    if (!s->job_ret)
+        return AVERROR(ENOMEM);
+    return 0;
+}
+
 /**
  * compute the sizes of tiles, resolution levels, bands, etc.
  * allocate memory for them
@@ -496,55 +587,49 @@ static int init_tiles(Jpeg2000EncoderContext *s)
                                                 s->avctx
                                                )) < 0)
                     return ret;
+                if ((ret = alloc_cblks(comp, codsty)) < 0)
+                    return ret;
             }
         }
     compute_rates(s);
-    return 0;
+    return init_cblk_rows(s);
 }
 
-#define COPY_FRAME(D, PIXEL)                                                                                                \
-    static void copy_frame_ ##D(Jpeg2000EncoderContext *s)                                                                  \
+#define COPY_TILE_COMP(D, PIXEL)                                                                                            \
+    static void copy_tile_comp_ ##D(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int compno)                              \
     {                                                                                                                       \
-        int tileno, compno, i, y, x;                                                                                        \
+        Jpeg2000Component *comp = tile->comp + compno;                                                                      \
+        int *dst = comp->i_data;                                                                                            \
+        int cbps = s->cbps[compno];                                                                                         \
+        int y, x;                                                                                                           \
         PIXEL *line;                                                                                                        \
-        for (tileno = 0; tileno < s->numXtiles * s->numYtiles; tileno++){                                                   \
-            Jpeg2000Tile *tile = s->tile + tileno;                                                                          \
-            if (s->planar){                                                                                                 \
-                for (compno = 0; compno < s->ncomponents; compno++){                                                        \
-                    Jpeg2000Component *comp = tile->comp + compno;                                                          \
-                    int *dst = comp->i_data;                                                                                \
-                    int cbps = s->cbps[compno];                                                                             \
-                    line = (PIXEL*)s->picture->data[compno]                                                                 \
-                           + comp->coord[1][0] * (s->picture->linesize[compno] / sizeof(PIXEL))                             \
-                           + comp->coord[0][0];                                                                             \
-                    for (y = comp->coord[1][0]; y < comp->coord[1][1]; y++){                                                \
-                        PIXEL *ptr = line;                                                                                  \
-                        for (x = comp->coord[0][0]; x < comp->coord[0][1]; x++)                                             \
-                            *dst++ = *ptr++ - (1 << (cbps - 1));                                                            \
-                        line += s->picture->linesize[compno] / sizeof(PIXEL);                                               \
-                    }                                                                                                       \
-                }                                                                                                           \
-            } else{                                                                                                         \
-                line = (PIXEL*)s->picture->data[0] + tile->comp[0].coord[1][0] * (s->picture->linesize[0] / sizeof(PIXEL))  \
-                       + tile->comp[0].coord[0][0] * s->ncomponents;                                                        \
+        if (s->planar){                                                                                                     \
+            line = (PIXEL*)s->picture->data[compno]                                                                         \
+                   + comp->coord[1][0] * (s->picture->linesize[compno] / sizeof(PIXEL))                                     \
+                   + comp->coord[0][0];                                                                                     \
+            for (y = comp->coord[1][0]; y < comp->coord[1][1]; y++){                                                        \
+                PIXEL *ptr = line;                                                                                          \
+                for (x = comp->coord[0][0]; x < comp->coord[0][1]; x++)                                                     \
+                    *dst++ = *ptr++ - (1 << (cbps - 1));                                                                    \
+                line += s->picture->linesize[compno] / sizeof(PIXEL);                                                       \
+            }                                                                                                               \
+        } else{                                                                                                             \
+            line = (PIXEL*)s->picture->data[0] + tile->comp[0].coord[1][0] * (s->picture->linesize[0] / sizeof(PIXEL))      \
+                   + tile->comp[0].coord[0][0] * s->ncomponents + compno;                                                   \
                                                                                                                             \
-                i = 0;                                                                                                      \
-                for (y = tile->comp[0].coord[1][0]; y < tile->comp[0].coord[1][1]; y++){                                    \
-                    PIXEL *ptr = line;                                                                                      \
-                    for (x = tile->comp[0].coord[0][0]; x < tile->comp[0].coord[0][1]; x++, i++){                           \
-                        for (compno = 0; compno < s->ncomponents; compno++){                                                \
-                            int cbps = s->cbps[compno];                                                                     \
-                            tile->comp[compno].i_data[i] = *ptr++  - (1 << (cbps - 1));                                     \
-                        }                                                                                                   \
-                    }                                                                                                       \
-                    line += s->picture->linesize[0] / sizeof(PIXEL);                                                        \
+            for (y = tile->comp[0].coord[1][0]; y < tile->comp[0].coord[1][1]; y++){                                        \
+                PIXEL *ptr = line;                                                                                          \
+                for (x = tile->comp[0].coord[0][0]; x < tile->comp[0].coord[0][1]; x++){                                    \
+                    *dst++ = *ptr - (1 << (cbps - 1));                                                                      \
+                    ptr += s->ncomponents;                                                                                  \
                 }                                                                                                           \
+                line += s->picture->linesize[0] / sizeof(PIXEL);                                                            \
             }                                                                                                               \
         }                                                                                                                   \
     }
 
-COPY_FRAME(8, uint8_t)
-COPY_FRAME(16, uint16_t)
+COPY_TILE_COMP(8, uint8_t)
+COPY_TILE_COMP(16, uint16_t)
 
 static void init_quantization(Jpeg2000EncoderContext *s)
 {
@@ -1179,10 +1264,15 @@ static int encode_packets(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int til
     return 0;
 }
 
-static void makelayer(Jpeg2000EncoderContext *s, int layno, double thresh, Jpeg2000Tile* tile, int final)
+/**
+ * @return the length of the code-block data of layers 0 to layno, without
+ *         the packet headers
+ */
+static int64_t makelayer(Jpeg2000EncoderContext *s, int layno, double thresh, Jpeg2000Tile* tile, int final)
 {
     int compno, resno, bandno, precno, cblkno;
     int passno;
+    int64_t data_len = 0;
 
     for (compno = 0; compno < s->ncomponents; compno++) {
         Jpeg2000Component *comp = &tile->comp[compno];
@@ -1235,6 +1325,8 @@ static void makelayer(Jpeg2000EncoderContext *s, int layno, double thresh, Jpeg2
                         }
                         layer->npasses = n - cblk->ninclpasses;
                         layer->cum_passes = n;
+                        if (n)
+                            data_len += cblk->passes[n - 1].rate;
 
                         if (layer->npasses == 0) {
                             layer->disto = 0;
@@ -1260,15 +1352,115 @@ static void makelayer(Jpeg2000EncoderContext *s, int layno, double thresh, Jpeg2
             }
         }
     }
+    return data_len;
+}
+
+/**
+ * Search the threshold of a layer with a tier-2 coding of the tile for each
+ * candidate.
+ */
+static double search_thresh_tier2(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int layno,
+                                  double lo, double hi)
+{
+    double thresh = 0.0;
+    double stable_thresh = 0.0;
+    double prev_thresh = -1.0;
+    int i;
+
+    for (i = 0; i < 128; i++) {
+        uint8_t *stream_pos = s->buf;
+        int ret;
+        thresh = (lo + hi) / 2;
+        /* the interval cannot be split any further, the remaining
+         * iterations would all repeat the same trial */
+        if (thresh == prev_thresh)
+            break;
+        prev_thresh = thresh;
+        makelayer(s, layno, thresh, tile, 0);
+        ret = encode_packets(s, tile, (int)(tile - s->tile), layno + 1);
+        memset(stream_pos, 0, s->buf - stream_pos);
+        if ((s->buf - stream_pos > ceil(tile->layer_rates[layno])) || ret < 0) {
+            lo = thresh;
+            s->buf = stream_pos;
+            continue;
+        }
+        hi = thresh;
+        stable_thresh = thresh;
+        s->buf = stream_pos;
+    }
+    return stable_thresh == 0.0 ? thresh : stable_thresh;
+}
+
+#define PCRD_TRIALS 6
+
+/**
+ * Post-compression rate-distortion optimization of a layer: the threshold
+ * is searched among the slopes of the passes using only the lengths of the
+ * coded passes, which needs no tier-2 coding. Each result is checked with a
+ * single tier-2 coding, the packet header size it measures is taken off the
+ * budget of the next search, and the thresholds checked so far bound the
+ * next search.
+ *
+ * @param slopes the slopes of the passes of the tile, sorted and unique
+ * @return 0 and the threshold in *thresh, or a negative value if no result
+ *         fits the budget after PCRD_TRIALS checks
+ */
+static int search_thresh_pcrd(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int layno,
+                              const double *slopes, int nb_slopes, double *thresh)
+{
+    const int64_t budget = ceil(tile->layer_rates[layno]);
+    int64_t headers = 0;
+    int lo = -1, hi = nb_slopes - 1;
+    int trial, found = 0;
+
+    for (trial = 0; trial < PCRD_TRIALS && lo < hi; trial++) {
+        uint8_t *stream_pos = s->buf;
+        int64_t data_len, size;
+        int l = lo, h = hi, ret;
+
+        while (h - l > 1) {
+            int m = (l + h) >> 1;
+            if (makelayer(s, layno, slopes[m], tile, 0) > budget - headers)
+                l = m;
+            else
+                h = m;
+        }
+        /* no threshold between the checked ones asks for less data */
+        if (found && h == hi)
+            break;
+
+        data_len = makelayer(s, layno, slopes[h], tile, 0);
+        ret = encode_packets(s, tile, (int)(tile - s->tile), layno + 1);
+        size = s->buf - stream_pos;
+        memset(stream_pos, 0, size);
+        s->buf = stream_pos;
+        if (ret < 0)
+            break;
+        if (size <= budget) {
+            *thresh = slopes[h];
+            hi = h;
+            found = 1;
+        } else {
+            lo = h;
+        }
+        headers = size - data_len;
+    }
+    return found ? 0 : AVERROR(EINVAL);
+}
+
+static int cmp_slopes(const void *a, const void *b)
+{
+    double da = *(const double *)a, db = *(const double *)b;
+    return (da > db) - (da < db);
 }
 
 static void makelayers(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile)
 {
     int precno, compno, reslevelno, bandno, cblkno, lev, passno, layno;
-    int i;
+    int i, n, nb_slopes = 0;
+    double *slopes;
     double min = DBL_MAX;
     double max = 0;
-    double thresh;
     int tile_disto = 0;
 
     Jpeg2000CodingStyle *codsty = &s->codsty;
@@ -1309,6 +1501,17 @@ static void makelayers(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile)
 
                             if (drslope > max)
                                 max = drslope;
+
+                            if (nb_slopes >= 0 && nb_slopes >= s->slopes_size / sizeof(*s->slopes)) {
+                                double *tmp = av_fast_realloc(s->slopes, &s->slopes_size,
+                                                              2 * (nb_slopes + 1) * sizeof(*s->slopes));
+                                if (tmp)
+                                    s->slopes = tmp;
+                                else
+                                    nb_slopes = -1;
+                            }
+                            if (nb_slopes >= 0)
+                                s->slopes[nb_slopes++] = drslope;
                         }
                     }
                 }
@@ -1316,34 +1519,23 @@ static void makelayers(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile)
         }
     }
 
+    slopes = nb_slopes >= 0 ? s->slopes : NULL;
+    if (nb_slopes > 1) {
+        AV_QSORT(slopes, nb_slopes, double, cmp_slopes);
+        for (i = n = 1; i < nb_slopes; i++)
+            if (slopes[i] != slopes[n - 1])
+                slopes[n++] = slopes[i];
+        nb_slopes = n;
+    }
+
     for (layno = 0; layno < s->nlayers; layno++) {
-        double lo = min;
-        double hi = max;
-        double stable_thresh = 0.0;
-        double good_thresh = 0.0;
-        if (!s->layer_rates[layno]) {
-            good_thresh = -1.0;
-        } else {
-            for (i = 0; i < 128; i++) {
-                uint8_t *stream_pos = s->buf;
-                int ret;
-                thresh = (lo + hi) / 2;
-                makelayer(s, layno, thresh, tile, 0);
-                ret = encode_packets(s, tile, (int)(tile - s->tile), layno + 1);
-                memset(stream_pos, 0, s->buf - stream_pos);
-                if ((s->buf - stream_pos > ceil(tile->layer_rates[layno])) || ret < 0) {
-                    lo = thresh;
-                    s->buf = stream_pos;
-                    continue;
-                }
-                hi = thresh;
-                stable_thresh = thresh;
-                s->buf = stream_pos;
-            }
-        }
-        if (good_thresh >= 0.0)
-            good_thresh = stable_thresh == 0.0 ? thresh : stable_thresh;
-        makelayer(s, layno, good_thresh, tile, 1);
+        double thresh = -1.0;
+        /* fall back to a tier-2 coding per candidate if the slopes could
+         * not be allocated or no candidate was found to fit */
+        if (s->layer_rates[layno] &&
+            (!slopes || search_thresh_pcrd(s, tile, layno, slopes, nb_slopes, &thresh) < 0))
+            thresh = search_thresh_tier2(s, tile, layno, min, max);
+        makelayer(s, layno, thresh, tile, 1);
     }
 }
 
@@ -1399,84 +1591,88 @@ static void truncpasses(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile)
     }
 }
 
-static int encode_tile(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int tileno)
+/**
+ * copy one component of a tile from the input picture and transform it
+ */
+static int dwt_tile_comp(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
 {
-    int compno, reslevelno, bandno, ret;
-    Jpeg2000T1Context t1;
-    Jpeg2000CodingStyle *codsty = &s->codsty;
-    for (compno = 0; compno < s->ncomponents; compno++){
-        Jpeg2000Component *comp = s->tile[tileno].comp + compno;
-
-        t1.stride = (1<<codsty->log2_cblk_width) + 2;
+    Jpeg2000EncoderContext *s = avctx->priv_data;
+    Jpeg2000Tile *tile = s->tile + jobnr / s->ncomponents;
+    int compno = jobnr % s->ncomponents;
 
-        av_log(s->avctx, AV_LOG_DEBUG,"dwt\n");
-        if ((ret = ff_dwt_encode(&comp->dwt, comp->i_data)) < 0)
-            return ret;
-        av_log(s->avctx, AV_LOG_DEBUG,"after dwt -> tier1\n");
+    if (avctx->pix_fmt == AV_PIX_FMT_BGR48 || avctx->pix_fmt == AV_PIX_FMT_GRAY16)
+        copy_tile_comp_16(s, tile, compno);
+    else
+        copy_tile_comp_8(s, tile, compno);
 
-        for (reslevelno = 0; reslevelno < codsty->nreslevels; reslevelno++){
-            Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+    return ff_dwt_encode(&tile->comp[compno].dwt, tile->comp[compno].i_data);
+}
 
-            for (bandno = 0; bandno < reslevel->nbands ; bandno++){
-                Jpeg2000Band *band = reslevel->band + bandno;
-                Jpeg2000Prec *prec = band->prec; // we support only 1 precinct per band ATM in the encoder
-                int cblkx, cblky, cblkno=0, xx0, x0, xx1, y0, yy0, yy1, bandpos;
-                yy0 = bandno == 0 ? 0 : comp->reslevel[reslevelno-1].coord[1][1] - comp->reslevel[reslevelno-1].coord[1][0];
-                y0 = yy0;
-                yy1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[1][0] + 1, band->log2_cblk_height) << band->log2_cblk_height,
-                            band->coord[1][1]) - band->coord[1][0] + yy0;
+static int encode_cblk_row(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    Jpeg2000EncoderContext *s = avctx->priv_data;
+    const Jpeg2000CblkRow *row = s->cblk_rows + jobnr;
+    Jpeg2000T1Context *t1 = s->t1 + threadnr;
+    Jpeg2000CodingStyle *codsty = &s->codsty;
+    Jpeg2000Tile *tile = s->tile + row->tileno;
+    Jpeg2000Component *comp = tile->comp + row->compno;
+    int reslevelno = row->reslevelno, bandno = row->bandno;
+    Jpeg2000Band *band = comp->reslevel[reslevelno].band + bandno;
+    Jpeg2000Prec *prec = band->prec; // we support only 1 precinct per band ATM in the encoder
+    int cblkx, cblkno = row->cblky * prec->nb_codeblocks_width;
+    int xx0, x0, xx1, y0, yy0, yy1, bandpos;
+
+    t1->stride = (1<<codsty->log2_cblk_width) + 2;
+
+    y0 = bandno == 0 ? 0 : comp->reslevel[reslevelno-1].coord[1][1] - comp->reslevel[reslevelno-1].coord[1][0];
+    yy0 = y0;
+    yy1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[1][0] + 1, band->log2_cblk_height) << band->log2_cblk_height,
+                band->coord[1][1]) - band->coord[1][0] + yy0;
+    if (row->cblky) {
+        yy0 = yy1 + (row->cblky - 1 << band->log2_cblk_height);
+        yy1 = FFMIN(yy0 + (1 << band->log2_cblk_height), band->coord[1][1] - band->coord[1][0] + y0);
+    }
 
-                if (band->coord[0][0] == band->coord[0][1] || band->coord[1][0] == band->coord[1][1])
-                    continue;
+    bandpos = bandno + (reslevelno > 0);
 
-                bandpos = bandno + (reslevelno > 0);
-
-                for (cblky = 0; cblky < prec->nb_codeblocks_height; cblky++){
-                    if (reslevelno == 0 || bandno == 1)
-                        xx0 = 0;
-                    else
-                        xx0 = comp->reslevel[reslevelno-1].coord[0][1] - comp->reslevel[reslevelno-1].coord[0][0];
-                    x0 = xx0;
-                    xx1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[0][0] + 1, band->log2_cblk_width) << band->log2_cblk_width,
-                                band->coord[0][1]) - band->coord[0][0] + xx0;
-
-                    for (cblkx = 0; cblkx < prec->nb_codeblocks_width; cblkx++, cblkno++){
-                        int y, x;
-                        if (codsty->transform == FF_DWT53){
-                            for (y = yy0; y < yy1; y++){
-                                int *ptr = t1.data + (y-yy0)*t1.stride;
-                                for (x = xx0; x < xx1; x++){
-                                    *ptr++ = comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x] * (1 << NMSEDEC_FRACBITS);
-                                }
-                            }
-                        } else{
-                            for (y = yy0; y < yy1; y++){
-                                int *ptr = t1.data + (y-yy0)*t1.stride;
-                                for (x = xx0; x < xx1; x++){
-                                    *ptr = (comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x]);
-                                    *ptr = (int64_t)*ptr * (int64_t)(16384 * 65536 / band->i_stepsize) >> 15 - NMSEDEC_FRACBITS;
-                                    ptr++;
-                                }
-                            }
-                        }
-                        if (!prec->cblk[cblkno].data)
-                            prec->cblk[cblkno].data = av_malloc(1 + 8192);
-                        if (!prec->cblk[cblkno].passes)
-                            prec->cblk[cblkno].passes = av_malloc_array(JPEG2000_MAX_PASSES, sizeof (*prec->cblk[cblkno].passes));
-                        if (!prec->cblk[cblkno].data || !prec->cblk[cblkno].passes)
-                            return AVERROR(ENOMEM);
-                        encode_cblk(s, &t1, prec->cblk + cblkno, tile, xx1 - xx0, yy1 - yy0,
-                                    bandpos, codsty->nreslevels - reslevelno - 1);
-                        xx0 = xx1;
-                        xx1 = FFMIN(xx1 + (1 << band->log2_cblk_width), band->coord[0][1] - band->coord[0][0] + x0);
-                    }
-                    yy0 = yy1;
-                    yy1 = FFMIN(yy1 + (1 << band->log2_cblk_height), band->coord[1][1] - band->coord[1][0] + y0);
+    if (reslevelno == 0 || bandno == 1)
+        xx0 = 0;
+    else
+        xx0 = comp->reslevel[reslevelno-1].coord[0][1] - comp->reslevel[reslevelno-1].coord[0][0];
+    x0 = xx0;
+    xx1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[0][0] + 1, band->log2_cblk_width) << band->log2_cblk_width,
+                band->coord[0][1]) - band->coord[0][0] + xx0;
+
+    for (cblkx = 0; cblkx < prec->nb_codeblocks_width; cblkx++, cblkno++){
+        int y, x;
+        if (codsty->transform == FF_DWT53){
+            for (y = yy0; y < yy1; y++){
+                int *ptr = t1->data + (y-yy0)*t1->stride;
+                for (x = xx0; x < xx1; x++){
+                    *ptr++ = comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x] * (1 << NMSEDEC_FRACBITS);
+                }
+            }
+        } else{
+            for (y = yy0; y < yy1; y++){
+                int *ptr = t1->data + (y-yy0)*t1->stride;
+                for (x = xx0; x < xx1; x++){
+                    *ptr = (comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x]);
+                    *ptr = (int64_t)*ptr * (int64_t)(16384 * 65536 / band->i_stepsize) >> 15 - NMSEDEC_FRACBITS;
+                    ptr++;
                 }
             }
         }
-        av_log(s->avctx, AV_LOG_DEBUG, "after tier1\n");
+        encode_cblk(s, t1, prec->cblk + cblkno, tile, xx1 - xx0, yy1 - yy0,
+                    bandpos, codsty->nreslevels - reslevelno - 1);
+        xx0 = xx1;
+        xx1 = FFMIN(xx1 + (1 << band->log2_cblk_width), band->coord[0][1] - band->coord[0][0] + x0);
     }
+    return 0;
+}
+
+static int encode_tile(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int tileno)
+{
+    int ret;
 
     av_log(s->avctx, AV_LOG_DEBUG, "rate control\n");
     if (s->compression_rate_enc)
@@ -1495,6 +1691,11 @@ static void cleanup(Jpeg2000EncoderContext *s)
     int tileno, compno;
     Jpeg2000CodingStyle *codsty = &s->codsty;
 
+    av_freep(&s->cblk_rows);
+    av_freep(&s->job_ret);
+    av_freep(&s->slopes);
+    av_freep(&s->t1);
+
     if (!s->tile)
         return;
     for (tileno = 0; tileno < s->numXtiles * s->numYtiles; tileno++){
@@ -1528,7 +1729,7 @@ static void update_size(uint8_t *size, const uint8_t *end)
 static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                         const AVFrame *pict, int *got_packet)
 {
-    int tileno, ret;
+    int tileno, ret, i, nb_jobs;
     Jpeg2000EncoderContext *s = avctx->priv_data;
     uint8_t *chunkstart, *jp2cstart, *jp2hstart;
 
@@ -1543,13 +1744,21 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
 
     s->lambda = s->picture->quality * LAMBDA_SCALE;
 
-    if (avctx->pix_fmt == AV_PIX_FMT_BGR48 || avctx->pix_fmt == AV_PIX_FMT_GRAY16)
-        copy_frame_16(s);
-    else
-        copy_frame_8(s);
-
     reinit(s);
 
+    av_log(s->avctx, AV_LOG_DEBUG, "dwt\n");
+    nb_jobs = s->numXtiles * s->numYtiles * s->ncomponents;
+    avctx->execute2(avctx, dwt_tile_comp, NULL, s->job_ret, nb_jobs);
+    for (i = 0; i < nb_jobs; i++)
+        if (s->job_ret[i] < 0)
+            return s->job_ret[i];
+    av_log(s->avctx, AV_LOG_DEBUG, "after dwt -> tier1\n");
+    avctx->execute2(avctx, encode_cblk_row, NULL, s->job_ret, s->nb_cblk_rows);
+    for (i = 0; i < s->nb_cblk_rows; i++)
+        if (s->job_ret[i] < 0)
+            return s->job_ret[i];
+    av_log(s->avctx, AV_LOG_DEBUG, "after tier1\n");
+
     if (s->format == CODEC_JP2) {
         av_assert0(s->buf == pkt->data);
 
@@ -1790,6 +1999,10 @@ FF_ENABLE_DEPRECATION_WARNINGS
     ff_mqc_init_context_tables();
     init_luts();
 
+    s->t1 = av_malloc_array(FFMAX(avctx->thread_count, 1), sizeof(*s->t1));
+    if (!s->t1)
+        return AVERROR(ENOMEM);
+
     init_quantization(s);
     if ((ret=init_tiles(s)) < 0)
         return ret;
@@ -1848,6 +2061,7 @@ AVCodec ff_jpeg2000_encoder = {
     .init           = j2kenc_init,
     .encode2        = encode_frame,
     .close          = j2kenc_destroy,
+    .capabilities   = AV_CODEC_CAP_SLICE_THREADS,
     .pix_fmts       = (const enum AVPixelFormat[]) {
         AV_PIX_FMT_RGB24, AV_PIX_FMT_YUV444P, AV_PIX_FMT_GRAY8,
         AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV422P,
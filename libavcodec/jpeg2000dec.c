@@ -90,8 +90,19 @@ typedef struct Jpeg2000Tile {
     GetByteContext      packed_headers_stream;  // byte context corresponding to packed headers
     uint16_t tp_idx;                    // Tile-part index
     int coord[2][2];                    // border coordinates {{x0, x1}, {y0, y1}}
+    uint8_t coded[4];                   // whether a code-block of the component has data
 } Jpeg2000Tile;
 
+/* a row of code-blocks of a precinct band, the unit of work of tier-1 decoding */
+typedef struct Jpeg2000CblkRow {
+    int tileno;
+    int compno;
+    int reslevelno;
+    int bandno;
+    int precno;
+    int cblky;
+} Jpeg2000CblkRow;
+
 typedef struct Jpeg2000DecoderContext {
     AVClass         *class;
     AVCodecContext  *avctx;
@@ -134,6 +145,13 @@ typedef struct Jpeg2000DecoderContext {
     Jpeg2000Tile    *tile;
     Jpeg2000DSPContext dsp;
 
+    Jpeg2000T1Context *t1;              // tier-1 context of each thread
+    Jpeg2000CblkRow *cblk_rows;
+    unsigned int    cblk_rows_size;
+    int             *cblk_rows_coded;
+    unsigned int    cblk_rows_coded_size;
+    int             nb_cblk_rows;
+
     /*options parameters*/
     int             reduction_factor;
 } Jpeg2000DecoderContext;
@@ -1937,75 +1955,134 @@ static inline void roi_scale_cblk(Jpeg2000Cblk *cblk,
     }
 }
 
-static inline void tile_codeblocks(Jpeg2000DecoderContext *s, Jpeg2000Tile *tile)
+/* list the code-block rows of all the tiles, so that they can be decoded in parallel */
+static int init_cblk_rows(Jpeg2000DecoderContext *s)
 {
-    Jpeg2000T1Context t1;
+    int tileno, compno, reslevelno, bandno, precno, cblky, n;
 
-    int compno, reslevelno, bandno;
+    for (n = 0; n < 2; n++) {
+        s->nb_cblk_rows = 0;
+        for (tileno = 0; tileno < s->numXtiles * s->numYtiles; tileno++) {
+            Jpeg2000Tile *tile = s->tile + tileno;
 
-    /* Loop on tile components */
-    for (compno = 0; compno < s->ncomponents; compno++) {
-        Jpeg2000Component *comp     = tile->comp + compno;
-        Jpeg2000CodingStyle *codsty = tile->codsty + compno;
-        int coded = 0;
+            for (compno = 0; compno < s->ncomponents; compno++) {
+                Jpeg2000Component *comp     = tile->comp + compno;
+                Jpeg2000CodingStyle *codsty = tile->codsty + compno;
 
-        t1.stride = (1<<codsty->log2_cblk_width) + 2;
+                for (reslevelno = 0; reslevelno < codsty->nreslevels2decode; reslevelno++) {
+                    Jpeg2000ResLevel *rlevel = comp->reslevel + reslevelno;
 
-        /* Loop on resolution levels */
-        for (reslevelno = 0; reslevelno < codsty->nreslevels2decode; reslevelno++) {
-            Jpeg2000ResLevel *rlevel = comp->reslevel + reslevelno;
-            /* Loop on bands */
-            for (bandno = 0; bandno < rlevel->nbands; bandno++) {
-                int nb_precincts, precno;
-                Jpeg2000Band *band = rlevel->band + bandno;
-                int cblkno = 0, bandpos;
+                    for (bandno = 0; bandno < rlevel->nbands; bandno++) {
+                        Jpeg2000Band *band = rlevel->band + bandno;
 
-                bandpos = bandno + (reslevelno > 0);
+                        if (band->coord[0][0] == band->coord[0][1] ||
+                            band->coord[1][0] == band->coord[1][1])
+                            continue;
 
-                if (band->coord[0][0] == band->coord[0][1] ||
-                    band->coord[1][0] == band->coord[1][1])
-                    continue;
+                        for (precno = 0; precno < rlevel->num_precincts_x * rlevel->num_precincts_y; precno++) {
+                            for (cblky = 0; cblky < band->prec[precno].nb_codeblocks_height; cblky++) {
+                                if (n) {
+                                    Jpeg2000CblkRow *row = s->cblk_rows + s->nb_cblk_rows;
+                                    row->tileno     = tileno;
+                                    row->compno     = compno;
+                                    row->reslevelno = reslevelno;
+                                    row->bandno     = bandno;
+                                    row->precno     = precno;
+                                    row->cblky      = cblky;
+                                }
+                                s->nb_cblk_rows++;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        if (!n) {
+            av_fast_malloc(&s->cblk_rows, &s->cblk_rows_size,
+                           FFMAX(s->nb_cblk_rows, 1) * sizeof(*s->cblk_rows));
+            av_fast_malloc(&s->cblk_rows_coded, &s->cblk_rows_coded_size,
+                           FFMAX(s->nb_cblk_rows, 1) * sizeof(*s->cblk_rows_coded));
+            if (!s->cblk_rows || !s->cblk_rows_coded)
+                return AVERROR(ENOMEM);
+        }
+    }
+    return 0;
+}
 
-                nb_precincts = rlevel->num_precincts_x * rlevel->num_precincts_y;
-                /* Loop on precincts */
-                for (precno = 0; precno < nb_precincts; precno++) {
-                    Jpeg2000Prec *prec = band->prec + precno;
-
-                    /* Loop on codeblocks */
-                    for (cblkno = 0;
-                         cblkno < prec->nb_codeblocks_width * prec->nb_codeblocks_height;
-                         cblkno++) {
-                        int x, y;
-                        Jpeg2000Cblk *cblk = prec->cblk + cblkno;
-                        int ret = decode_cblk(s, codsty, &t1, cblk,
-                                    cblk->coord[0][1] - cblk->coord[0][0],
-                                    cblk->coord[1][1] - cblk->coord[1][0],
-                                    bandpos, comp->roi_shift);
-                        if (ret)
-                            coded = 1;
-                        else
-                            continue;
-                        x = cblk->coord[0][0] - band->coord[0][0];
-                        y = cblk->coord[1][0] - band->coord[1][0];
-
-                        if (comp->roi_shift)
-                            roi_scale_cblk(cblk, comp, &t1);
-                        if (codsty->transform == FF_DWT97)
-                            dequantization_float(x, y, cblk, comp, &t1, band);
-                        else if (codsty->transform == FF_DWT97_INT)
-                            dequantization_int_97(x, y, cblk, comp, &t1, band);
-                        else
-                            dequantization_int(x, y, cblk, comp, &t1, band);
-                   } /* end cblk */
-                } /*end prec */
-            } /* end band */
-        } /* end reslevel */
+/* decode a row of code-blocks, returns whether any of them had data */
+static int decode_cblk_row(AVCodecContext *avctx, void *td,
+                           int jobnr, int threadnr)
+{
+    Jpeg2000DecoderContext *s   = avctx->priv_data;
+    const Jpeg2000CblkRow *row  = s->cblk_rows + jobnr;
+    Jpeg2000T1Context *t1       = s->t1 + threadnr;
+    Jpeg2000Tile *tile          = s->tile + row->tileno;
+    Jpeg2000Component *comp     = tile->comp + row->compno;
+    Jpeg2000CodingStyle *codsty = tile->codsty + row->compno;
+    Jpeg2000Band *band          = comp->reslevel[row->reslevelno].band + row->bandno;
+    Jpeg2000Prec *prec          = band->prec + row->precno;
+    int bandpos = row->bandno + (row->reslevelno > 0);
+    int cblkno  = row->cblky * prec->nb_codeblocks_width;
+    int cblkend = cblkno + prec->nb_codeblocks_width;
+    int coded   = 0;
+
+    t1->stride = (1<<codsty->log2_cblk_width) + 2;
+
+    for (; cblkno < cblkend; cblkno++) {
+        int x, y;
+        Jpeg2000Cblk *cblk = prec->cblk + cblkno;
+        int ret = decode_cblk(s, codsty, t1, cblk,
+                    cblk->coord[0][1] - cblk->coord[0][0],
+                    cblk->coord[1][1] - cblk->coord[1][0],
+                    bandpos, comp->roi_shift);
+        if (ret)
+            coded = 1;
+        else
+            continue;
+        x = cblk->coord[0][0] - band->coord[0][0];
+        y = cblk->coord[1][0] - band->coord[1][0];
+
+        if (comp->roi_shift)
+            roi_scale_cblk(cblk, comp, t1);
+        if (codsty->transform == FF_DWT97)
+            dequantization_float(x, y, cblk, comp, t1, band);
+        else if (codsty->transform == FF_DWT97_INT)
+            dequantization_int_97(x, y, cblk, comp, t1, band);
+        else
+            dequantization_int(x, y, cblk, comp, t1, band);
+    } /* end cblk */
 
-        /* inverse DWT */
-        if (coded)
-            ff_dwt_decode(&comp->dwt, codsty->transform == FF_DWT97 ? (void*)comp->f_data : (void*)comp->i_data);
+    return coded;
+}
 
-    } /*end comp */
+/* inverse DWT of one tile component */
+static int jpeg2000_dwt_tile_comp(AVCodecContext *avctx, void *td,
+                                  int jobnr, int threadnr)
+{
+    Jpeg2000DecoderContext *s   = avctx->priv_data;
+    Jpeg2000Tile *tile          = s->tile + jobnr / s->ncomponents;
+    int compno                  = jobnr % s->ncomponents;
+    Jpeg2000Component *comp     = tile->comp + compno;
+    Jpeg2000CodingStyle *codsty = tile->codsty + compno;
+
+    if (tile->coded[compno])
+        ff_dwt_decode(&comp->dwt, codsty->transform == FF_DWT97 ? (void*)comp->f_data : (void*)comp->i_data);
+
+    return 0;
+}
+
+static void tile_codeblocks(Jpeg2000DecoderContext *s)
+{
+    int i;
+
+    s->avctx->execute2(s->avctx, decode_cblk_row, NULL, s->cblk_rows_coded, s->nb_cblk_rows);
+
+    for (i = 0; i < s->nb_cblk_rows; i++)
+        if (s->cblk_rows_coded[i])
+            s->tile[s->cblk_rows[i].tileno].coded[s->cblk_rows[i].compno] = 1;
+
+    s->avctx->execute2(s->avctx, jpeg2000_dwt_tile_comp, NULL, NULL,
+                       s->numXtiles * s->numYtiles * s->ncomponents);
 }
 
 #define WRITE_FRAME(D, PIXEL)                                                                     \
@@ -2081,25 +2158,11 @@ static int jpeg2000_decode_tile(AVCodecContext *avctx, void *td,
     Jpeg2000DecoderContext *s = avctx->priv_data;
     AVFrame *picture = td;
     Jpeg2000Tile *tile = s->tile + jobnr;
-    int x;
-
-    tile_codeblocks(s, tile);
 
     /* inverse MCT transformation */
     if (tile->codsty[0].mct)
         mct_decode(s, tile);
 
-    for (x = 0; x < s->ncomponents; x++) {
-        if (s->cdef[x] < 0) {
-            for (x = 0; x < s->ncomponents; x++) {
-                s->cdef[x] = x + 1;
-            }
-            if ((s->ncomponents & 1) == 0)
-                s->cdef[s->ncomponents-1] = 0;
-            break;
-        }
-    }
-
     if (s->precision <= 8) {
         write_frame_8(s, tile, picture, 8);
     } else {
@@ -2483,6 +2546,23 @@ static av_cold int jpeg2000_decode_init(AVCodecContext *avctx)
     ff_thread_once(&init_static_once, jpeg2000_init_static_data);
     ff_jpeg2000dsp_init(&s->dsp);
 
+    s->t1 = av_malloc_array(avctx->active_thread_type & FF_THREAD_SLICE ? avctx->thread_count : 1,
+                            sizeof(*s->t1));
+    if (!s->t1)
+        return AVERROR(ENOMEM);
+
+    return 0;
+}
+
+static av_cold int jpeg2000_decode_close(AVCodecContext *avctx)
+{
+    Jpeg2000DecoderContext *s = avctx->priv_data;
+
+    av_freep(&s->t1);
+    av_freep(&s->cblk_rows);
+    av_freep(&s->cblk_rows_coded);
+    s->cblk_rows_size = s->cblk_rows_coded_size = 0;
+
     return 0;
 }
 
@@ -2492,7 +2572,7 @@ static int jpeg2000_decode_frame(AVCodecContext *avctx, void *data,
     Jpeg2000DecoderContext *s = avctx->priv_data;
     ThreadFrame frame = { .f = data };
     AVFrame *picture = data;
-    int ret;
+    int ret, x;
 
     s->avctx     = avctx;
     bytestream2_init(&s->g, avpkt->data, avpkt->size);
@@ -2539,6 +2619,22 @@ static int jpeg2000_decode_frame(AVCodecContext *avctx, void *data,
     if (ret = jpeg2000_read_bitstream_packets(s))
         goto end;
 
+    for (x = 0; x < s->ncomponents; x++) {
+        if (s->cdef[x] < 0) {
+            for (x = 0; x < s->ncomponents; x++) {
+                s->cdef[x] = x + 1;
+            }
+            if ((s->ncomponents & 1) == 0)
+                s->cdef[s->ncomponents-1] = 0;
+            break;
+        }
+    }
+
+    if ((ret = init_cblk_rows(s)) < 0)
+        goto end;
+
+    tile_codeblocks(s);
+
     avctx->execute2(avctx, jpeg2000_decode_tile, picture, NULL, s->numXtiles * s->numYtiles);
 
     jpeg2000_dec_cleanup(s);
@@ -2583,6 +2679,7 @@ AVCodec ff_jpeg2000_decoder = {
     .priv_data_size   = sizeof(Jpeg2000DecoderContext),
     .init             = jpeg2000_decode_init,
     .decode           = jpeg2000_decode_frame,
+    .close            = jpeg2000_decode_close,
     .priv_class       = &jpeg2000_class,
     .max_lowres       = 5,
     .profiles         = NULL_IF_CONFIG_SMALL(ff_jpeg2000_profiles)
@@ -379,6 +379,41 @@ static int bands_dist(OpusPsyContext *s, CeltFrame *f, float *total_dist)
     return 0;
 }
 
+static int bands_dist_job(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    OpusPsyContext *s = arg;
+    CeltFrame *f = s->thread_frame ? &s->thread_frame[threadnr] : s->search_frame;
+
+    f->intensity_stereo = s->search_is[jobnr];
+    f->dual_stereo      = s->search_ds[jobnr];
+    f->seed             = s->search_seed;
+
+    return bands_dist(s, f, &s->search_dist[jobnr]);
+}
+
+/* Each trial only depends on the frame and on its own stereo parameters, so
+ * the trials are run in parallel on per-thread copies of the frame.
+ * The noise filling of the trials must not depend on the trials run before
+ * them, so they all start from the same seed, which is left untouched. */
+static void bands_dist_search(OpusPsyContext *s, CeltFrame *f, int nb_trials)
+{
+    int i;
+
+    s->search_frame = f;
+    s->search_seed  = f->seed;
+    if (s->thread_frame) {
+        for (i = 0; i < s->nb_threads; i++) {
+            CeltPVQ *pvq = s->thread_frame[i].pvq;
+            memcpy(&s->thread_frame[i], f, sizeof(*f));
+            s->thread_frame[i].pvq = pvq;
+        }
+    }
+
+    s->avctx->execute2(s->avctx, bands_dist_job, s, NULL, nb_trials);
+
+    f->seed = s->search_seed;
+}
+
 static void celt_search_for_dual_stereo(OpusPsyContext *s, CeltFrame *f)
 {
     float td1, td2;
@@ -387,9 +422,12 @@ static void celt_search_for_dual_stereo(OpusPsyContext *s, CeltFrame *f)
     if (s->avctx->channels < 2)
         return;
 
-    bands_dist(s, f, &td1);
-    f->dual_stereo = 1;
-    bands_dist(s, f, &td2);
+    s->search_is[0] = s->search_is[1] = f->intensity_stereo;
+    s->search_ds[0] = 0;
+    s->search_ds[1] = 1;
+    bands_dist_search(s, f, 2);
+    td1 = s->search_dist[0];
+    td2 = s->search_dist[1];
 
     f->dual_stereo = td2 < td1;
     s->dual_stereo_used += td2 < td1;
@@ -397,20 +435,32 @@ static void celt_search_for_dual_stereo(OpusPsyContext *s, CeltFrame *f)
 
 static void celt_search_for_intensity(OpusPsyContext *s, CeltFrame *f)
 {
-    int i, best_band = CELT_MAX_BANDS - 1;
-    float dist, best_dist = FLT_MAX;
+    int i, nb_trials = 0, best_band = CELT_MAX_BANDS - 1;
+    float best_dist = FLT_MAX;
     /* TODO: fix, make some heuristic up here using the lambda value */
     float end_band = 0;
+    OpusRangeCoder dump;
 
     if (s->avctx->channels < 2)
         return;
 
-    for (i = f->end_band; i >= end_band; i--) {
-        f->intensity_stereo = i;
-        bands_dist(s, f, &dist);
-        if (best_dist > dist) {
-            best_dist = dist;
-            best_band = i;
+    /* The bit allocation limits the intensity stereo band to the number of
+     * coded bands, which does not depend on it, so all the bands above that
+     * give the same distortion and are only tried once */
+    ff_opus_rc_enc_init(&dump);
+    ff_celt_bitalloc(f, &dump, 1);
+
+    for (i = FFMIN(f->end_band, f->coded_bands); i >= end_band; i--) {
+        s->search_is[nb_trials] = i;
+        s->search_ds[nb_trials] = f->dual_stereo;
+        nb_trials++;
+    }
+    bands_dist_search(s, f, nb_trials);
+
+    for (i = 0; i < nb_trials; i++) {
+        if (best_dist > s->search_dist[i]) {
+            best_dist = s->search_dist[i];
+            best_band = i ? s->search_is[i] : f->end_band;
         }
     }
 
@@ -540,6 +590,18 @@ av_cold int ff_opus_psy_init(OpusPsyContext *s, AVCodecContext *avctx,
         goto fail;
     }
 
+    s->nb_threads = avctx->active_thread_type & FF_THREAD_SLICE ? avctx->thread_count : 1;
+    if (s->nb_threads > 1) {
+        s->thread_frame = av_mallocz_array(s->nb_threads, sizeof(*s->thread_frame));
+        if (!s->thread_frame) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        for (i = 0; i < s->nb_threads; i++)
+            if ((ret = ff_celt_pvq_init(&s->thread_frame[i].pvq, 1)) < 0)
+                goto fail;
+    }
+
     for (ch = 0; ch < s->avctx->channels; ch++) {
         for (i = 0; i < CELT_MAX_BANDS; i++) {
             bessel_init(&s->bfilter_hi[ch][i], 1.0f, 19.0f, 100.0f, 1);
@@ -574,6 +636,11 @@ fail:
     av_freep(&s->inflection_points);
     av_freep(&s->dsp);
 
+    if (s->thread_frame)
+        for (i = 0; i < s->nb_threads; i++)
+            ff_celt_pvq_uninit(&s->thread_frame[i].pvq);
+    av_freep(&s->thread_frame);
+
     for (i = 0; i < CELT_BLOCK_NB; i++) {
         ff_mdct15_uninit(&s->mdct[i]);
         av_freep(&s->window[i]);
@@ -597,6 +664,11 @@ av_cold int ff_opus_psy_end(OpusPsyContext *s)
     av_freep(&s->inflection_points);
     av_freep(&s->dsp);
 
+    if (s->thread_frame)
+        for (i = 0; i < s->nb_threads; i++)
+            ff_celt_pvq_uninit(&s->thread_frame[i].pvq);
+    av_freep(&s->thread_frame);
+
     for (i = 0; i < CELT_BLOCK_NB; i++) {
         ff_mdct15_uninit(&s->mdct[i]);
         av_freep(&s->window[i]);
@@ -89,6 +89,15 @@ typedef struct OpusPsyContext {
     float lambda;
     int *inflection_points;
     int inflection_points_count;
+
+    /* Stereo searches, each trial quantization is run as a slice */
+    int nb_threads;
+    CeltFrame *search_frame;                /* Frame being searched */
+    CeltFrame *thread_frame;                /* Per-thread copies of it, if threaded */
+    uint32_t search_seed;                   /* Noise seed every trial starts from */
+    int   search_is[CELT_MAX_BANDS + 1];    /* Intensity stereo band of each trial */
+    int   search_ds[CELT_MAX_BANDS + 1];    /* Dual stereo flag of each trial */
+    float search_dist[CELT_MAX_BANDS + 1];  /* Resulting distortion */
 } OpusPsyContext;
 
 int  ff_opus_psy_process           (OpusPsyContext *s, OpusPacketInfo *p);
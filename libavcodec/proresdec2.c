@@ -26,6 +26,7 @@
 
 //#define DEBUG
 
+#define CACHED_BITSTREAM_READER !ARCH_X86_32
 #define LONG_BITSTREAM_READER
 
 #include "libavutil/internal.h"
@@ -487,7 +488,7 @@ static av_always_inline int decode_ac_coeffs(AVCodecContext *avctx, GetBitContex
     block_mask = blocks_per_slice - 1;
 
     for (pos = block_mask;;) {
-        bits_left = gb->size_in_bits - re_index;
+        bits_left = BITS_LEFT(re, gb);
         if (!bits_left || (bits_left < 32 && !SHOW_UBITS(re, gb, bits_left)))
             break;
 
@@ -237,6 +237,129 @@ cglobal %1_h264_chroma_mc2_10, 6,7
     REP_RET
 %endmacro
 
+;-----------------------------------------------------------------------------
+; void ff_put/avg_h264_chroma_mc8(pixel *dst, pixel *src, ptrdiff_t stride,
+;                                 int h, int mx, int my)
+; AVX2 version, two rows of 8 pixels per register
+;-----------------------------------------------------------------------------
+; load the rows at %2 and %2+%3 into the low and high lanes of m%1
+%macro LOAD_2ROWS 3
+    movu         xm%1, [%2]
+    vinserti128   m%1, m%1, [%2+%3], 1
+%endmacro
+
+; store the lanes of m%2 to dst and dst+stride, averaged with dst for avg
+%macro STORE_2ROWS 3 ; put/avg, src, tmp
+%ifidn %1, avg
+    LOAD_2ROWS     %3, r0, r2
+    pavgw         m%2, m%3
+%endif
+    mova         [r0], xm%2
+    vextracti128 [r0+r2], m%2, 1
+%endmacro
+
+%macro CHROMA_MC8_AVX2 1
+cglobal %1_h264_chroma_mc8_10, 6,7,8
+    mov          r6d, r5d
+    or           r6d, r4d
+    jne .at_least_one_non_zero
+    ; mx == 0 AND my == 0 - no filter needed
+    lea           r4, [r2*2]
+.next4rows:
+    LOAD_2ROWS      0, r1, r2
+    STORE_2ROWS    %1, 0, 2
+    add           r1, r4
+    add           r0, r4
+    LOAD_2ROWS      1, r1, r2
+    STORE_2ROWS    %1, 1, 3
+    add           r1, r4
+    add           r0, r4
+    sub          r3d, 4
+    jne .next4rows
+    RET
+
+.at_least_one_non_zero:
+    mov          r6d, 2
+    test         r5d, r5d
+    je .x_interpolation
+    mov           r6, r2        ; dxy = x ? 1 : stride
+    test         r4d, r4d
+    jne .xy_interpolation
+.x_interpolation:
+    ; mx == 0 XOR my == 0 - 1 dimensional filter only
+    or           r4d, r5d       ; x + y
+    movd         xm5, r4d
+    vpbroadcastw  m4, [pw_8]
+    vpbroadcastw  m6, [pw_4]    ; m6 = rnd >> 3
+    vpbroadcastw  m5, xm5       ; m5 = B = x
+    psubw         m4, m5        ; m4 = A = 8-x
+    lea           r5, [r1+r6]   ; src + dxy
+    lea           r4, [r2*2]
+
+.next1drow:
+    LOAD_2ROWS     0, r1, r2    ; m0 = src[0..7]
+    LOAD_2ROWS     2, r5, r2    ; m2 = src[1..8]
+
+    pmullw        m0, m4        ; m0 = A * src[0..7]
+    pmullw        m2, m5        ; m2 = B * src[1..8]
+
+    paddw         m0, m6
+    paddw         m0, m2
+    psrlw         m0, 3
+    STORE_2ROWS   %1, 0, 1      ; dst[0..7] = (A * src[0..7] + B * src[1..8] + (rnd >> 3)) >> 3
+
+    add           r0, r4
+    add           r1, r4
+    add           r5, r4
+    sub          r3d, 2
+    jne .next1drow
+    RET
+
+.xy_interpolation: ; general case, bilinear
+    movd         xm4, r4m         ; x
+    movd         xm6, r5m         ; y
+
+    vpbroadcastw  m4, xm4         ; m4 = x words
+    vpbroadcastw  m6, xm6         ; m6 = y words
+    vpbroadcastw  m3, [pw_32]
+    psllw         m5, m4, 3       ; m5 = 8x
+    pmullw        m4, m6          ; m4 = x * y
+    psllw         m6, 3           ; m6 = 8y
+    paddw         m1, m5, m6      ; m1 = 8x+8y
+    mova          m7, m4          ; DD = x * y
+    psubw         m5, m4          ; m5 = B = 8x - xy
+    psubw         m6, m4          ; m6 = C = 8y - xy
+    vpbroadcastw  m0, [pw_64]
+    paddw         m4, m0
+    psubw         m4, m1          ; m4 = A = xy - (8x+8y) + 64
+    lea           r4, [r2*2]
+
+.next2drow:
+    LOAD_2ROWS     0, r1, r2      ; m0 = src[0..7]
+    LOAD_2ROWS     1, r1+2, r2    ; m1 = src[1..8]
+    add           r1, r2
+    pmullw        m0, m4
+    pmullw        m1, m5
+    paddw         m0, m1          ; m0 = A * src[0..7] + B * src[1..8]
+
+    LOAD_2ROWS     1, r1, r2
+    LOAD_2ROWS     2, r1+2, r2
+    pmullw        m1, m6
+    pmullw        m2, m7
+    paddw         m0, m1          ; m0 += C * src[0..7+strde]
+    paddw         m0, m2          ; m0 += D * src[1..8+strde]
+
+    paddw         m0, m3
+    psrlw         m0, 6
+    STORE_2ROWS   %1, 0, 1        ; dst[0..7] = (m0 + 32) >> 6
+
+    add           r0, r4
+    add           r1, r2
+    sub          r3d, 2
+    jne .next2drow
+    RET
+%endmacro
+
 %macro NOTHING 2-3
 %endmacro
 %macro AVG 2-3
@@ -253,6 +376,10 @@ CHROMA_MC8 put
 INIT_XMM avx
 CHROMA_MC8 put
 %endif
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+CHROMA_MC8_AVX2 put
+%endif
 INIT_MMX mmxext
 CHROMA_MC4 put
 CHROMA_MC2 put
@@ -264,6 +391,10 @@ CHROMA_MC8 avg
 INIT_XMM avx
 CHROMA_MC8 avg
 %endif
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+CHROMA_MC8_AVX2 avg
+%endif
 INIT_MMX mmxext
 CHROMA_MC4 avg
 CHROMA_MC2 avg
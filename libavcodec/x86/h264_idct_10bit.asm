@@ -613,6 +613,80 @@ INIT_XMM avx
 IDCT8_ADD
 %endif
 
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+; %1=uint8_t *dst, %2/%3=rows, %4=tmp, %5=zero, %6=pw_pixel_max, %7=stride
+%macro STORE_DIFF16x2 7
+    psrad       m%2, 6
+    psrad       m%3, 6
+    packssdw    m%2, m%3
+    vpermq      m%2, m%2, q3120
+    mova       xm%4, [%1]
+    vinserti128 m%4, m%4, [%1+%7], 1
+    paddsw      m%2, m%4
+    CLIPW       m%2, m%5, m%6
+    mova       [%1], xm%2
+    vextracti128 [%1+%7], m%2, 1
+%endmacro
+
+; the whole 8x8 block fits in m0-m7 with one row of coefficients per register,
+; the block is only 16-byte aligned
+INIT_YMM avx2
+cglobal h264_idct8_add_10, 3,4,11
+    movsxdifnidn r2, r2d
+    call h264_idct8_add1_10 %+ SUFFIX
+    RET
+
+ALIGN 16
+h264_idct8_add1_10 %+ SUFFIX:
+    add   dword [r1], 32
+    movu          m1, [r1+ 32]
+    movu          m2, [r1+ 64]
+    movu          m3, [r1+ 96]
+    movu          m5, [r1+160]
+    movu          m6, [r1+192]
+    movu          m7, [r1+224]
+    movu          m8, [r1]
+    movu          m9, [r1+128]
+    IDCT8_1D      m8, m9
+
+    SBUTTERFLY    dq, 0, 1, 8
+    SBUTTERFLY    dq, 2, 3, 8
+    SBUTTERFLY    dq, 4, 5, 8
+    SBUTTERFLY    dq, 6, 7, 8
+    SBUTTERFLY   qdq, 0, 2, 8
+    SBUTTERFLY   qdq, 1, 3, 8
+    SBUTTERFLY   qdq, 4, 6, 8
+    SBUTTERFLY   qdq, 5, 7, 8
+    SBUTTERFLY  dqqq, 0, 4, 8
+    SBUTTERFLY  dqqq, 2, 6, 8
+    SBUTTERFLY  dqqq, 1, 5, 8
+    SBUTTERFLY  dqqq, 3, 7, 8
+    SWAP           1, 2
+    SWAP           5, 6
+    SWAP           0, 8
+    SWAP           4, 9
+    IDCT8_1D      m8, m9
+
+    pxor          m8, m8
+    vpbroadcastw  m9, [pw_pixel_max]
+    movu    [r1+  0], m8
+    movu    [r1+ 32], m8
+    movu    [r1+ 64], m8
+    movu    [r1+ 96], m8
+    movu    [r1+128], m8
+    movu    [r1+160], m8
+    movu    [r1+192], m8
+    movu    [r1+224], m8
+    STORE_DIFF16x2 r0,      0, 1, 10, 8, 9, r2
+    lea           r0, [r0+r2*2]
+    STORE_DIFF16x2 r0,      2, 3, 10, 8, 9, r2
+    lea           r0, [r0+r2*2]
+    STORE_DIFF16x2 r0,      4, 5, 10, 8, 9, r2
+    lea           r0, [r0+r2*2]
+    STORE_DIFF16x2 r0,      6, 7, 10, 8, 9, r2
+    ret
+%endif
+
 ;-----------------------------------------------------------------------------
 ; void ff_h264_idct8_add4_10(pixel **dst, const int *block_offset,
 ;                            int16_t *block, int stride,
@@ -655,3 +729,7 @@ IDCT8_ADD4
 INIT_XMM avx
 IDCT8_ADD4
 %endif
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+INIT_YMM avx2
+IDCT8_ADD4
+%endif
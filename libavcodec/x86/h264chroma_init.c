@@ -66,6 +66,8 @@ CHROMA_MC(put, 8, 10, sse2)
 CHROMA_MC(avg, 8, 10, sse2)
 CHROMA_MC(put, 8, 10, avx)
 CHROMA_MC(avg, 8, 10, avx)
+CHROMA_MC(put, 8, 10, avx2)
+CHROMA_MC(avg, 8, 10, avx2)
 
 av_cold void ff_h264chroma_init_x86(H264ChromaContext *c, int bit_depth)
 {
@@ -114,4 +116,9 @@ av_cold void ff_h264chroma_init_x86(H264ChromaContext *c, int bit_depth)
         c->put_h264_chroma_pixels_tab[0] = ff_put_h264_chroma_mc8_10_avx;
         c->avg_h264_chroma_pixels_tab[0] = ff_avg_h264_chroma_mc8_10_avx;
     }
+
+    if (EXTERNAL_AVX2_FAST(cpu_flags) && bit_depth > 8 && bit_depth <= 10) {
+        c->put_h264_chroma_pixels_tab[0] = ff_put_h264_chroma_mc8_10_avx2;
+        c->avg_h264_chroma_pixels_tab[0] = ff_avg_h264_chroma_mc8_10_avx2;
+    }
 }
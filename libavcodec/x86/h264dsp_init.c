@@ -47,6 +47,7 @@ IDCT_ADD_FUNC(8, 10, sse2)
 IDCT_ADD_FUNC(, 10, avx)
 IDCT_ADD_FUNC(8_dc, 10, avx)
 IDCT_ADD_FUNC(8, 10, avx)
+IDCT_ADD_FUNC(8, 10, avx2)
 
 
 #define IDCT_ADD_REP_FUNC(NUM, REP, DEPTH, OPT)                         \
@@ -59,6 +60,7 @@ IDCT_ADD_REP_FUNC(8, 4, 8, mmxext)
 IDCT_ADD_REP_FUNC(8, 4, 8, sse2)
 IDCT_ADD_REP_FUNC(8, 4, 10, sse2)
 IDCT_ADD_REP_FUNC(8, 4, 10, avx)
+IDCT_ADD_REP_FUNC(8, 4, 10, avx2)
 IDCT_ADD_REP_FUNC(, 16, 8, mmx)
 IDCT_ADD_REP_FUNC(, 16, 8, mmxext)
 IDCT_ADD_REP_FUNC(, 16, 8, sse2)
@@ -443,6 +445,10 @@ av_cold void ff_h264dsp_init_x86(H264DSPContext *c, const int bit_depth,
             c->h264_h_loop_filter_luma_intra   = ff_deblock_h_luma_intra_10_avx;
 #endif /* HAVE_ALIGNED_STACK */
         }
+        if (ARCH_X86_64 && EXTERNAL_AVX2_FAST(cpu_flags)) {
+            c->h264_idct8_add  = ff_h264_idct8_add_10_avx2;
+            c->h264_idct8_add4 = ff_h264_idct8_add4_10_avx2;
+        }
     }
 #endif
 }
@@ -24,7 +24,9 @@
 SECTION .text
 
 cextern pw_1023
+cextern pw_4095
 %define max_pixels_10 pw_1023
+%define max_pixels_12 pw_4095
 
 ; the add_res macros and functions were largely inspired by h264_idct.asm from the x264 project
 %macro ADD_RES_MMX_4_8 0
@@ -289,21 +291,23 @@ cglobal hevc_add_residual_32_8, 3, 5, 7
     mova      [%1+%2+32], m3
 %endmacro
 
-; void ff_hevc_add_residual_<4|8|16|32>_10(pixel *dst, int16_t *block, ptrdiff_t stride)
-INIT_MMX mmxext
-cglobal hevc_add_residual_4_10, 3, 3, 6
+; void ff_hevc_add_residual_<4|8|16|32>_<10|12>(pixel *dst, int16_t *block, ptrdiff_t stride)
+; %1 = bitdepth
+%macro ADD_RES_4_HIGH 1
+cglobal hevc_add_residual_4_%1, 3, 3, 6
     pxor              m2, m2
-    mova              m3, [max_pixels_10]
+    mova              m3, [max_pixels_%1]
     ADD_RES_MMX_4_10  r0, r2, r1
     add               r1, 16
     lea               r0, [r0+2*r2]
     ADD_RES_MMX_4_10  r0, r2, r1
     RET
+%endmacro
 
-INIT_XMM sse2
-cglobal hevc_add_residual_8_10, 3, 4, 6
+%macro ADD_RES_SSE_HIGH 1
+cglobal hevc_add_residual_8_%1, 3, 4, 6
     pxor              m4, m4
-    mova              m5, [max_pixels_10]
+    mova              m5, [max_pixels_%1]
     lea               r3, [r2*3]
 
     ADD_RES_SSE_8_10  r0, r2, r3, r1
@@ -312,9 +316,9 @@ cglobal hevc_add_residual_8_10, 3, 4, 6
     ADD_RES_SSE_8_10  r0, r2, r3, r1
     RET
 
-cglobal hevc_add_residual_16_10, 3, 5, 6
+cglobal hevc_add_residual_16_%1, 3, 5, 6
     pxor              m4, m4
-    mova              m5, [max_pixels_10]
+    mova              m5, [max_pixels_%1]
 
     mov              r4d, 8
 .loop:
@@ -325,9 +329,9 @@ cglobal hevc_add_residual_16_10, 3, 5, 6
     jg .loop
     RET
 
-cglobal hevc_add_residual_32_10, 3, 5, 6
+cglobal hevc_add_residual_32_%1, 3, 5, 6
     pxor              m4, m4
-    mova              m5, [max_pixels_10]
+    mova              m5, [max_pixels_%1]
 
     mov              r4d, 32
 .loop:
@@ -337,12 +341,12 @@ cglobal hevc_add_residual_32_10, 3, 5, 6
     dec              r4d
     jg .loop
     RET
+%endmacro
 
-%if HAVE_AVX2_EXTERNAL
-INIT_YMM avx2
-cglobal hevc_add_residual_16_10, 3, 5, 6
+%macro ADD_RES_AVX2_HIGH 1
+cglobal hevc_add_residual_16_%1, 3, 5, 6
     pxor               m4, m4
-    mova               m5, [max_pixels_10]
+    mova               m5, [max_pixels_%1]
     lea                r3, [r2*3]
 
     mov               r4d, 4
@@ -354,9 +358,9 @@ cglobal hevc_add_residual_16_10, 3, 5, 6
     jg .loop
     RET
 
-cglobal hevc_add_residual_32_10, 3, 5, 6
+cglobal hevc_add_residual_32_%1, 3, 5, 6
     pxor               m4, m4
-    mova               m5, [max_pixels_10]
+    mova               m5, [max_pixels_%1]
 
     mov               r4d, 16
 .loop:
@@ -366,4 +370,54 @@ cglobal hevc_add_residual_32_10, 3, 5, 6
     dec               r4d
     jg .loop
     RET
+%endmacro
+
+INIT_MMX mmxext
+ADD_RES_4_HIGH 10
+ADD_RES_4_HIGH 12
+
+INIT_XMM sse2
+ADD_RES_SSE_HIGH 10
+ADD_RES_SSE_HIGH 12
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+ADD_RES_AVX2_HIGH 10
+ADD_RES_AVX2_HIGH 12
+%endif ;HAVE_AVX2_EXTERNAL
+
+; void ff_hevc_cross_component_pred(int16_t *coeffs, const int16_t *coeffs_y,
+;                                   int res_scale_val, int16_t log2_size)
+; coeffs[i] += (res_scale_val * coeffs_y[i]) >> 3, for any bitdepth
+%macro CROSS_COMPONENT_PRED 0
+cglobal hevc_cross_component_pred, 4, 5, 4, coeffs, coeffs_y, scale, log2_size, size
+    movd             xm3, scaled
+    SPLATW            m3, xm3
+    movzx     log2_sized, log2_sizew
+    xor           sized, sized
+    bts           sized, log2_sized
+    imul          sized, sized
+    add           sized, sized          ; size * size * sizeof(int16_t)
+    add          coeffsq, sizeq
+    add        coeffs_yq, sizeq
+    neg            sizeq
+.loop:
+    mova              m0, [coeffs_yq+sizeq]
+    pmulhw            m1, m0, m3
+    pmullw            m0, m3
+    psrlw             m0, 3
+    psllw             m1, 13            ; low 16 bits of the 32-bit product >> 3
+    por               m0, m1
+    paddw             m0, [coeffsq+sizeq]
+    mova [coeffsq+sizeq], m0
+    add            sizeq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse2
+CROSS_COMPONENT_PRED
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+CROSS_COMPONENT_PRED
 %endif ;HAVE_AVX2_EXTERNAL
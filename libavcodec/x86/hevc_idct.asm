@@ -28,6 +28,7 @@ SECTION_RODATA
 pd_64: times 4 dd 64
 pd_2048: times 4 dd 2048
 pd_512: times 4 dd 512
+pd_128: times 4 dd 128
 
 ; 4x4 transform coeffs
 cextern pw_64
@@ -236,7 +237,7 @@ times 4 dw 90, -90
 
 SECTION .text
 
-; void ff_hevc_idct_HxW_dc_{8,10}_<opt>(int16_t *coeffs)
+; void ff_hevc_idct_HxW_dc_{8,10,12}_<opt>(int16_t *coeffs)
 ; %1 = HxW
 ; %2 = number of loops
 ; %3 = bitdepth
@@ -356,7 +357,7 @@ cglobal hevc_idct_%1x%1_dc_%2, 1, 2, 1, coeff, tmp
     movhps %2, [r0 + %6 + %7]
 %endmacro
 
-; void ff_hevc_idct_4x4__{8,10}_<opt>(int16_t *coeffs, int col_limit)
+; void ff_hevc_idct_4x4__{8,10,12}_<opt>(int16_t *coeffs, int col_limit)
 ; %1 = bitdepth
 %macro IDCT_4x4 1
 cglobal hevc_idct_4x4_%1, 1, 1, 5, coeffs
@@ -503,7 +504,7 @@ cglobal hevc_idct_transpose_8x8, 0, 0, 0
     ret
 %endmacro
 
-; void ff_hevc_idct_8x8_{8,10}_<opt>(int16_t *coeffs, int col_limit)
+; void ff_hevc_idct_8x8_{8,10,12}_<opt>(int16_t *coeffs, int col_limit)
 ; %1 = bitdepth
 %macro IDCT_8x8 1
 cglobal hevc_idct_8x8_%1, 1, 1, 8, coeffs
@@ -625,7 +626,7 @@ cglobal hevc_idct_transpose_16x16, 0, 0, 0
     ret
 %endmacro
 
-; void ff_hevc_idct_16x16_{8,10}_<opt>(int16_t *coeffs, int col_limit)
+; void ff_hevc_idct_16x16_{8,10,12}_<opt>(int16_t *coeffs, int col_limit)
 ; %1 = bitdepth
 %macro IDCT_16x16 1
 cglobal hevc_idct_16x16_%1, 1, 2, 16, coeffs
@@ -787,7 +788,7 @@ cglobal hevc_idct_transpose_32x32, 0, 0, 0
     ret
 %endmacro
 
-; void ff_hevc_idct_32x32_{8,10}_<opt>(int16_t *coeffs, int col_limit)
+; void ff_hevc_idct_32x32_{8,10,12}_<opt>(int16_t *coeffs, int col_limit)
 ; %1 = bitdepth
 %macro IDCT_32x32 1
 cglobal hevc_idct_32x32_%1, 1, 6, 16, 256, coeffs
@@ -849,5 +850,5 @@ INIT_IDCT 8, sse2
 INIT_IDCT 8, avx
 INIT_IDCT 10, sse2
 INIT_IDCT 10, avx
-;INIT_IDCT 12, sse2
-;INIT_IDCT 12, avx
+INIT_IDCT 12, sse2
+INIT_IDCT 12, avx
@@ -256,4 +256,17 @@ void ff_hevc_add_residual_32_10_sse2(uint8_t *dst, int16_t *res, ptrdiff_t strid
 void ff_hevc_add_residual_16_10_avx2(uint8_t *dst, int16_t *res, ptrdiff_t stride);
 void ff_hevc_add_residual_32_10_avx2(uint8_t *dst, int16_t *res, ptrdiff_t stride);
 
+void ff_hevc_add_residual_4_12_mmxext(uint8_t *dst, int16_t *res, ptrdiff_t stride);
+void ff_hevc_add_residual_8_12_sse2(uint8_t *dst, int16_t *res, ptrdiff_t stride);
+void ff_hevc_add_residual_16_12_sse2(uint8_t *dst, int16_t *res, ptrdiff_t stride);
+void ff_hevc_add_residual_32_12_sse2(uint8_t *dst, int16_t *res, ptrdiff_t stride);
+
+void ff_hevc_add_residual_16_12_avx2(uint8_t *dst, int16_t *res, ptrdiff_t stride);
+void ff_hevc_add_residual_32_12_avx2(uint8_t *dst, int16_t *res, ptrdiff_t stride);
+
+void ff_hevc_cross_component_pred_sse2(int16_t *coeffs, const int16_t *coeffs_y,
+                                       int res_scale_val, int16_t log2_size);
+void ff_hevc_cross_component_pred_avx2(int16_t *coeffs, const int16_t *coeffs_y,
+                                       int res_scale_val, int16_t log2_size);
+
 #endif // AVCODEC_X86_HEVCDSP_H
@@ -74,12 +74,16 @@ IDCT_DC_FUNCS(32x32, avx2);
 #define IDCT_FUNCS(opt)                                             \
 void ff_hevc_idct_4x4_8_    ## opt(int16_t *coeffs, int col_limit); \
 void ff_hevc_idct_4x4_10_   ## opt(int16_t *coeffs, int col_limit); \
+void ff_hevc_idct_4x4_12_   ## opt(int16_t *coeffs, int col_limit); \
 void ff_hevc_idct_8x8_8_    ## opt(int16_t *coeffs, int col_limit); \
 void ff_hevc_idct_8x8_10_   ## opt(int16_t *coeffs, int col_limit); \
+void ff_hevc_idct_8x8_12_   ## opt(int16_t *coeffs, int col_limit); \
 void ff_hevc_idct_16x16_8_  ## opt(int16_t *coeffs, int col_limit); \
 void ff_hevc_idct_16x16_10_ ## opt(int16_t *coeffs, int col_limit); \
+void ff_hevc_idct_16x16_12_ ## opt(int16_t *coeffs, int col_limit); \
 void ff_hevc_idct_32x32_8_  ## opt(int16_t *coeffs, int col_limit); \
-void ff_hevc_idct_32x32_10_ ## opt(int16_t *coeffs, int col_limit);
+void ff_hevc_idct_32x32_10_ ## opt(int16_t *coeffs, int col_limit); \
+void ff_hevc_idct_32x32_12_ ## opt(int16_t *coeffs, int col_limit);
 
 IDCT_FUNCS(sse2)
 IDCT_FUNCS(avx)
@@ -738,6 +742,8 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
             c->add_residual[1] = ff_hevc_add_residual_8_8_sse2;
             c->add_residual[2] = ff_hevc_add_residual_16_8_sse2;
             c->add_residual[3] = ff_hevc_add_residual_32_8_sse2;
+
+            c->cross_component_pred = ff_hevc_cross_component_pred_sse2;
         }
         if (EXTERNAL_SSSE3(cpu_flags)) {
             if(ARCH_X86_64) {
@@ -876,6 +882,8 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
             c->sao_edge_filter[4] = ff_hevc_sao_edge_filter_64_8_avx2;
 
             c->add_residual[3] = ff_hevc_add_residual_32_8_avx2;
+
+            c->cross_component_pred = ff_hevc_cross_component_pred_avx2;
         }
     } else if (bit_depth == 10) {
         if (EXTERNAL_MMXEXT(cpu_flags)) {
@@ -906,6 +914,8 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
             c->add_residual[1] = ff_hevc_add_residual_8_10_sse2;
             c->add_residual[2] = ff_hevc_add_residual_16_10_sse2;
             c->add_residual[3] = ff_hevc_add_residual_32_10_sse2;
+
+            c->cross_component_pred = ff_hevc_cross_component_pred_sse2;
         }
         if (EXTERNAL_SSSE3(cpu_flags) && ARCH_X86_64) {
             c->hevc_v_loop_filter_luma = ff_hevc_v_loop_filter_luma_10_ssse3;
@@ -1093,9 +1103,12 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
 
             c->add_residual[2] = ff_hevc_add_residual_16_10_avx2;
             c->add_residual[3] = ff_hevc_add_residual_32_10_avx2;
+
+            c->cross_component_pred = ff_hevc_cross_component_pred_avx2;
         }
     } else if (bit_depth == 12) {
         if (EXTERNAL_MMXEXT(cpu_flags)) {
+            c->add_residual[0] = ff_hevc_add_residual_4_12_mmxext;
             c->idct_dc[0] = ff_hevc_idct_4x4_dc_12_mmxext;
             c->idct_dc[1] = ff_hevc_idct_8x8_dc_12_mmxext;
         }
@@ -1105,6 +1118,9 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
             if (ARCH_X86_64) {
                 c->hevc_v_loop_filter_luma = ff_hevc_v_loop_filter_luma_12_sse2;
                 c->hevc_h_loop_filter_luma = ff_hevc_h_loop_filter_luma_12_sse2;
+
+                c->idct[2] = ff_hevc_idct_16x16_12_sse2;
+                c->idct[3] = ff_hevc_idct_32x32_12_sse2;
             }
             SAO_BAND_INIT(12, sse2);
             SAO_EDGE_INIT(12, sse2);
@@ -1112,6 +1128,15 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
             c->idct_dc[1] = ff_hevc_idct_8x8_dc_12_sse2;
             c->idct_dc[2] = ff_hevc_idct_16x16_dc_12_sse2;
             c->idct_dc[3] = ff_hevc_idct_32x32_dc_12_sse2;
+
+            c->idct[0]    = ff_hevc_idct_4x4_12_sse2;
+            c->idct[1]    = ff_hevc_idct_8x8_12_sse2;
+
+            c->add_residual[1] = ff_hevc_add_residual_8_12_sse2;
+            c->add_residual[2] = ff_hevc_add_residual_16_12_sse2;
+            c->add_residual[3] = ff_hevc_add_residual_32_12_sse2;
+
+            c->cross_component_pred = ff_hevc_cross_component_pred_sse2;
         }
         if (EXTERNAL_SSSE3(cpu_flags) && ARCH_X86_64) {
             c->hevc_v_loop_filter_luma = ff_hevc_v_loop_filter_luma_12_ssse3;
@@ -1134,7 +1159,14 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
             if (ARCH_X86_64) {
                 c->hevc_v_loop_filter_luma = ff_hevc_v_loop_filter_luma_12_avx;
                 c->hevc_h_loop_filter_luma = ff_hevc_h_loop_filter_luma_12_avx;
+
+                c->idct[2] = ff_hevc_idct_16x16_12_avx;
+                c->idct[3] = ff_hevc_idct_32x32_12_avx;
             }
+
+            c->idct[0] = ff_hevc_idct_4x4_12_avx;
+            c->idct[1] = ff_hevc_idct_8x8_12_avx;
+
             SAO_BAND_INIT(12, avx);
         }
         if (EXTERNAL_AVX2(cpu_flags)) {
@@ -1146,6 +1178,11 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
 
             SAO_BAND_INIT(12, avx2);
             SAO_EDGE_INIT(12, avx2);
+
+            c->add_residual[2] = ff_hevc_add_residual_16_12_avx2;
+            c->add_residual[3] = ff_hevc_add_residual_32_12_avx2;
+
+            c->cross_component_pred = ff_hevc_cross_component_pred_avx2;
         }
     }
 }
@@ -31,6 +31,7 @@ enum FrameType {
     INNER_FRAME,
     FINAL_FRAME,
     LINEAR_MODE,
+    STREAM_MODE,
     FRAME_NB
 };
 
@@ -91,6 +92,31 @@ typedef struct LoudNormContext {
     int prev_nb_samples;
     int channels;
 
+    /* single-pass streaming mode */
+    int lookahead;              // lookahead option, in milliseconds
+    int stream_delay;           // total delay of the audio, in samples
+    int stream_skip;            // leading delayed samples still to be dropped
+    int stream_flushing;        // EOF reached, the delay line is being drained
+    double *stream_buf;         // delay line in front of the loudness gain
+    int stream_buf_size;        // size of stream_buf, in samples
+    int stream_buf_index;
+    int stream_window;          // limiter lookahead window, in samples
+    int64_t stream_pos;         // number of samples entered into the limiter
+    double *stream_lim_buf;     // gained samples pending in the limiter window
+    double *stream_min_val;     // monotonic queue for the window gain minimum
+    int64_t *stream_min_pos;
+    int stream_min_head;
+    int stream_min_count;
+    double *stream_env;         // release-smoothed gains of the last window
+    double stream_env_sum;
+    double stream_env_prev;
+    double release_coef;
+    int stream_block_size;      // samples between two loudness gain updates
+    int stream_block_pos;
+    int stream_blocks;
+    double stream_gain[2];      // gain at the start and end of the current block
+    double *stream_tmp;         // one gained sample, entering the limiter
+
     FFEBUR128State *r128_in;
     FFEBUR128State *r128_out;
 } LoudNormContext;
@@ -119,6 +145,7 @@ static const AVOption loudnorm_options[] = {
     {     "none",         0,                                   0,                        AV_OPT_TYPE_CONST,   {.i64 =  NONE},     0,         0,  FLAGS, "print_format" },
     {     "json",         0,                                   0,                        AV_OPT_TYPE_CONST,   {.i64 =  JSON},     0,         0,  FLAGS, "print_format" },
     {     "summary",      0,                                   0,                        AV_OPT_TYPE_CONST,   {.i64 =  SUMMARY},  0,         0,  FLAGS, "print_format" },
+    { "lookahead",        "set streaming mode lookahead in ms",OFFSET(lookahead),        AV_OPT_TYPE_INT,     {.i64 =  0},        0,      3000,  FLAGS },
     { NULL }
 };
 
@@ -406,6 +433,154 @@ static void true_peak_limiter(LoudNormContext *s, double *out, int nb_samples, i
     }
 }
 
+static void stream_update_gain(LoudNormContext *s)
+{
+    double global, shortterm, relative_threshold, env_global, env_shortterm, delta;
+
+    ff_ebur128_loudness_global(s->r128_in, &global);
+    ff_ebur128_relative_threshold(s->r128_in, &relative_threshold);
+    /* the short-term window is not filled during the first 3 seconds */
+    if (s->stream_blocks < 30)
+        ff_ebur128_loudness_momentary(s->r128_in, &shortterm);
+    else
+        ff_ebur128_loudness_shortterm(s->r128_in, &shortterm);
+
+    if (shortterm < relative_threshold || shortterm <= -70.) {
+        delta = s->prev_delta;
+    } else {
+        env_global = fabs(shortterm - global) < (s->target_lra / 2.) ? shortterm - global : (s->target_lra / 2.) * ((shortterm - global) < 0 ? -1 : 1);
+        env_shortterm = s->target_i - shortterm;
+        delta = pow(10., (env_global + env_shortterm) / 20.);
+    }
+
+    s->stream_gain[0] = s->stream_gain[1];
+    /* exponential smoothing stands in for the centered gaussian of the
+     * dynamic mode, which would need 1s of lookahead */
+    if (s->stream_blocks)
+        s->stream_gain[1] += 0.25 * (delta - s->stream_gain[1]);
+    else
+        s->stream_gain[0] = s->stream_gain[1] = delta;
+    s->prev_delta = delta;
+    s->stream_blocks++;
+}
+
+/**
+ * Push one gained sample into the lookahead limiter and return in out the
+ * sample leaving the limiter window.
+ *
+ * The gain needed by each sample is reduced to its minimum over the window,
+ * smoothed by the release filter and averaged over the window again, so the
+ * attack ramp ends exactly on the peak and no sample exceeds the ceiling.
+ * Like true_peak_limiter(), this works on the sample peaks of the audio
+ * upsampled to 192 kHz.
+ */
+static void stream_limiter(LoudNormContext *s, const double *in, double *out, int channels)
+{
+    const int window = s->stream_window;
+    const int64_t pos = s->stream_pos++;
+    const int idx = pos % window;
+    const int out_idx = (pos + 1) % window;
+    const double ceiling = s->target_tp;
+    double *lim = s->stream_lim_buf;
+    double gain = 1., env, peak = 0.;
+    int c, back;
+
+    for (c = 0; c < channels; c++) {
+        lim[idx * channels + c] = in[c];
+        peak = FFMAX(peak, fabs(in[c]));
+    }
+    if (peak > ceiling)
+        gain = ceiling / peak;
+
+    /* drop the expired head first, so the queue never holds more than
+     * window entries once the new gain is pushed */
+    if (s->stream_min_count && s->stream_min_pos[s->stream_min_head] <= pos - window) {
+        s->stream_min_head = (s->stream_min_head + 1) % window;
+        s->stream_min_count--;
+    }
+    while (s->stream_min_count) {
+        back = (s->stream_min_head + s->stream_min_count - 1) % window;
+        if (s->stream_min_val[back] < gain)
+            break;
+        s->stream_min_count--;
+    }
+    back = (s->stream_min_head + s->stream_min_count++) % window;
+    s->stream_min_val[back] = gain;
+    s->stream_min_pos[back] = pos;
+    gain = s->stream_min_val[s->stream_min_head];
+
+    env = gain < s->stream_env_prev ? gain : s->stream_env_prev + (gain - s->stream_env_prev) * s->release_coef;
+    s->stream_env_prev = env;
+    s->stream_env_sum += env - s->stream_env[out_idx];
+    s->stream_env[out_idx] = env;
+    if (!out_idx) {
+        /* avoid accumulating rounding errors in the running sum */
+        int i;
+        s->stream_env_sum = 0.;
+        for (i = 0; i < window; i++)
+            s->stream_env_sum += s->stream_env[i];
+    }
+    gain = s->stream_env_sum / window;
+
+    for (c = 0; c < channels; c++) {
+        out[c] = lim[out_idx * channels + c] * gain;
+        if (fabs(out[c]) > ceiling)
+            out[c] = ceiling * (out[c] < 0 ? -1 : 1);
+    }
+}
+
+/**
+ * Streaming mode: the loudness gain follows the input measurement with a
+ * bounded delay instead of the 3 seconds buffer of the dynamic mode.
+ *
+ * @return the number of samples written to dst
+ */
+static int stream_frame(LoudNormContext *s, const double *src, double *dst,
+                        int nb_samples, int channels)
+{
+    int n, c, nb_out = 0;
+
+    while (nb_samples > 0) {
+        const int len = FFMIN(nb_samples, s->stream_block_size - s->stream_block_pos);
+
+        if (!s->stream_flushing)
+            ff_ebur128_add_frames_double(s->r128_in, src, len);
+
+        for (n = 0; n < len; n++) {
+            const double gain = s->stream_gain[0] + ((double)s->stream_block_pos / s->stream_block_size) * (s->stream_gain[1] - s->stream_gain[0]);
+            double *buf = s->stream_buf + s->stream_buf_index * channels;
+            double *tmp = s->stream_tmp;
+
+            for (c = 0; c < channels; c++) {
+                tmp[c] = buf[c] * gain * s->offset;
+                buf[c] = src[c];
+            }
+            if (++s->stream_buf_index >= s->stream_buf_size)
+                s->stream_buf_index = 0;
+
+            stream_limiter(s, tmp, dst, channels);
+            src += channels;
+            s->stream_block_pos++;
+
+            if (s->stream_skip > 0) {
+                s->stream_skip--;
+                continue;
+            }
+            dst += channels;
+            nb_out++;
+        }
+
+        if (s->stream_block_pos >= s->stream_block_size) {
+            s->stream_block_pos = 0;
+            if (!s->stream_flushing)
+                stream_update_gain(s);
+        }
+        nb_samples -= len;
+    }
+
+    return nb_out;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
@@ -440,6 +615,19 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     buf = s->buf;
     limiter_buf = s->limiter_buf;
 
+    if (s->frame_type == STREAM_MODE) {
+        out->nb_samples = stream_frame(s, src, dst, in->nb_samples, inlink->channels);
+        if (in != out)
+            av_frame_free(&in);
+        if (!out->nb_samples) {
+            av_frame_free(&out);
+            return 0;
+        }
+        ff_ebur128_add_frames_double(s->r128_out, dst, out->nb_samples);
+        s->pts += out->nb_samples;
+        return ff_filter_frame(outlink, out);
+    }
+
     ff_ebur128_add_frames_double(s->r128_in, src, in->nb_samples);
 
     if (s->frame_type == FIRST_FRAME && in->nb_samples < frame_size(inlink->sample_rate, 3000)) {
@@ -645,7 +833,16 @@ static int request_frame(AVFilterLink *outlink)
     LoudNormContext *s = ctx->priv;
 
     ret = ff_request_frame(inlink);
-    if (ret == AVERROR_EOF && s->frame_type == INNER_FRAME) {
+    if (ret == AVERROR_EOF && s->frame_type == STREAM_MODE && !s->stream_flushing) {
+        AVFrame *frame = ff_get_audio_buffer(outlink, s->stream_delay);
+
+        if (!frame)
+            return AVERROR(ENOMEM);
+        av_samples_set_silence(frame->extended_data, 0, frame->nb_samples,
+                               frame->channels, frame->format);
+        s->stream_flushing = 1;
+        ret = filter_frame(inlink, frame);
+    } else if (ret == AVERROR_EOF && s->frame_type == INNER_FRAME) {
         double *src;
         double *buf;
         int nb_samples, n, c, offset;
@@ -729,6 +926,7 @@ static int config_input(AVFilterLink *inlink)
 {
     AVFilterContext *ctx = inlink->dst;
     LoudNormContext *s = ctx->priv;
+    int n;
 
     s->r128_in = ff_ebur128_init(inlink->channels, inlink->sample_rate, 0, FF_EBUR128_MODE_I | FF_EBUR128_MODE_S | FF_EBUR128_MODE_LRA | FF_EBUR128_MODE_SAMPLE_PEAK);
     if (!s->r128_in)
@@ -759,7 +957,32 @@ static int config_input(AVFilterLink *inlink)
 
     init_gaussian_filter(s);
 
-    if (s->frame_type != LINEAR_MODE) {
+    if (s->frame_type == STREAM_MODE) {
+        const int channels = inlink->channels;
+
+        s->stream_delay = FFMAX(1, av_rescale(s->lookahead, inlink->sample_rate, 1000));
+        s->stream_window = FFMIN(frame_size(inlink->sample_rate, 10), s->stream_delay);
+        s->stream_buf_size = s->stream_delay - s->stream_window + 1;
+        s->stream_skip = s->stream_delay;
+        s->stream_block_size = frame_size(inlink->sample_rate, 100);
+        s->release_coef = 1. - exp(-1. / frame_size(inlink->sample_rate, 100));
+
+        s->stream_buf     = av_calloc(s->stream_buf_size * channels, sizeof(*s->stream_buf));
+        s->stream_lim_buf = av_calloc(s->stream_window * channels, sizeof(*s->stream_lim_buf));
+        s->stream_min_val = av_calloc(s->stream_window, sizeof(*s->stream_min_val));
+        s->stream_min_pos = av_calloc(s->stream_window, sizeof(*s->stream_min_pos));
+        s->stream_env     = av_calloc(s->stream_window, sizeof(*s->stream_env));
+        s->stream_tmp     = av_calloc(channels, sizeof(*s->stream_tmp));
+        if (!s->stream_buf || !s->stream_lim_buf || !s->stream_min_val ||
+            !s->stream_min_pos || !s->stream_env || !s->stream_tmp)
+            return AVERROR(ENOMEM);
+
+        for (n = 0; n < s->stream_window; n++)
+            s->stream_env[n] = 1.;
+        s->stream_env_sum = s->stream_window;
+        s->stream_env_prev = 1.;
+        s->stream_gain[0] = s->stream_gain[1] = s->prev_delta = 1.;
+    } else if (s->frame_type != LINEAR_MODE) {
         inlink->min_samples =
         inlink->max_samples =
         inlink->partial_buf_size = frame_size(inlink->sample_rate, 3000);
@@ -798,6 +1021,9 @@ static av_cold int init(AVFilterContext *ctx)
         }
     }
 
+    if (s->frame_type == FIRST_FRAME && s->lookahead)
+        s->frame_type = STREAM_MODE;
+
     return 0;
 }
 
@@ -856,7 +1082,7 @@ static av_cold void uninit(AVFilterContext *ctx)
             20. * log10(tp_out),
             lra_out,
             thresh_out,
-            s->frame_type == LINEAR_MODE ? "linear" : "dynamic",
+            s->frame_type == LINEAR_MODE ? "linear" : s->frame_type == STREAM_MODE ? "streaming" : "dynamic",
             s->target_i - i_out
         );
         break;
@@ -884,7 +1110,7 @@ static av_cold void uninit(AVFilterContext *ctx)
             20. * log10(tp_out),
             lra_out,
             thresh_out,
-            s->frame_type == LINEAR_MODE ? "Linear" : "Dynamic",
+            s->frame_type == LINEAR_MODE ? "Linear" : s->frame_type == STREAM_MODE ? "Streaming" : "Dynamic",
             s->target_i - i_out
         );
         break;
@@ -898,6 +1124,12 @@ end:
     av_freep(&s->limiter_buf);
     av_freep(&s->prev_smp);
     av_freep(&s->buf);
+    av_freep(&s->stream_buf);
+    av_freep(&s->stream_lim_buf);
+    av_freep(&s->stream_min_val);
+    av_freep(&s->stream_min_pos);
+    av_freep(&s->stream_env);
+    av_freep(&s->stream_tmp);
 }
 
 static const AVFilterPad avfilter_af_loudnorm_inputs[] = {
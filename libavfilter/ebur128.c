@@ -89,6 +89,10 @@ struct FFEBUR128StateInternal {
     unsigned long *short_term_block_energy_histogram;
     /** Keeps track of when a new short term block is needed. */
     size_t short_term_frame_counter;
+    /** Channel weighted energy of each 100ms block of audio_data. */
+    double *block_energies;
+    /** Index of the first block of block_energies not computed yet. */
+    size_t block_energies_index;
     /** Maximum sample peak, one per channel */
     double *sample_peak;
     /** The maximum window duration in ms. */
@@ -256,11 +260,16 @@ FFEBUR128State *ff_ebur128_init(unsigned int channels,
                                     st->channels * sizeof(*st->d->audio_data));
     CHECK_ERROR(!st->d->audio_data, 0, free_sample_peak)
 
+    st->d->block_energies =
+        av_mallocz_array(st->d->audio_data_frames / st->d->samples_in_100ms,
+                         sizeof(*st->d->block_energies));
+    CHECK_ERROR(!st->d->block_energies, 0, free_audio_data)
+
     ebur128_init_filter(st);
 
     st->d->block_energy_histogram =
         av_mallocz(1000 * sizeof(*st->d->block_energy_histogram));
-    CHECK_ERROR(!st->d->block_energy_histogram, 0, free_audio_data)
+    CHECK_ERROR(!st->d->block_energy_histogram, 0, free_block_energies)
     st->d->short_term_block_energy_histogram =
         av_mallocz(1000 * sizeof(*st->d->short_term_block_energy_histogram));
     CHECK_ERROR(!st->d->short_term_block_energy_histogram, 0,
@@ -271,6 +280,7 @@ FFEBUR128State *ff_ebur128_init(unsigned int channels,
     st->d->needed_frames = st->d->samples_in_100ms * 4;
     /* start at the beginning of the buffer */
     st->d->audio_data_index = 0;
+    st->d->block_energies_index = 0;
 
     if (ff_thread_once(&histogram_init, &init_histogram) != 0)
         goto free_short_term_block_energy_histogram;
@@ -285,6 +295,8 @@ free_short_term_block_energy_histogram:
     av_free(st->d->short_term_block_energy_histogram);
 free_block_energy_histogram:
     av_free(st->d->block_energy_histogram);
+free_block_energies:
+    av_free(st->d->block_energies);
 free_audio_data:
     av_free(st->d->audio_data);
 free_sample_peak:
@@ -304,6 +316,7 @@ void ff_ebur128_destroy(FFEBUR128State ** st)
     av_free((*st)->d->block_energy_histogram);
     av_free((*st)->d->short_term_block_energy_histogram);
     av_free((*st)->d->audio_data);
+    av_free((*st)->d->block_energies);
     av_free((*st)->d->channel_map);
     av_free((*st)->d->sample_peak);
     av_free((*st)->d->data_ptrs);
@@ -317,6 +330,10 @@ static void ebur128_filter_##type(FFEBUR128State* st, const type** srcs,
                                   size_t src_index, size_t frames,                 \
                                   int stride) {                                    \
     double* audio_data = st->d->audio_data + st->d->audio_data_index;              \
+    const double a1 = st->d->a[1], a2 = st->d->a[2];                               \
+    const double a3 = st->d->a[3], a4 = st->d->a[4];                               \
+    const double b0 = st->d->b[0], b1 = st->d->b[1], b2 = st->d->b[2];             \
+    const double b3 = st->d->b[3], b4 = st->d->b[4];                               \
     size_t i, c;                                                                   \
                                                                                    \
     if ((st->mode & FF_EBUR128_MODE_SAMPLE_PEAK) == FF_EBUR128_MODE_SAMPLE_PEAK) { \
@@ -336,29 +353,37 @@ static void ebur128_filter_##type(FFEBUR128State* st, const type** srcs,
     }                                                                              \
     for (c = 0; c < st->channels; ++c) {                                           \
         int ci = st->d->channel_map[c] - 1;                                        \
+        double *v, v1, v2, v3, v4;                                                 \
         if (ci < 0) continue;                                                      \
         else if (ci == FF_EBUR128_DUAL_MONO - 1) ci = 0; /*dual mono */            \
+        /* keep the state in registers, stores to audio_data may alias it */       \
+        v  = st->d->v[ci];                                                         \
+        v1 = v[1];                                                                 \
+        v2 = v[2];                                                                 \
+        v3 = v[3];                                                                 \
+        v4 = v[4];                                                                 \
         for (i = 0; i < frames; ++i) {                                             \
-            st->d->v[ci][0] = (double) (srcs[c][src_index + i * stride] / scaling_factor) \
-                         - st->d->a[1] * st->d->v[ci][1]                           \
-                         - st->d->a[2] * st->d->v[ci][2]                           \
-                         - st->d->a[3] * st->d->v[ci][3]                           \
-                         - st->d->a[4] * st->d->v[ci][4];                          \
+            const double v0 = (double) (srcs[c][src_index + i * stride] / scaling_factor) \
+                         - a1 * v1                                                 \
+                         - a2 * v2                                                 \
+                         - a3 * v3                                                 \
+                         - a4 * v4;                                                \
             audio_data[i * st->channels + c] =                                     \
-                           st->d->b[0] * st->d->v[ci][0]                           \
-                         + st->d->b[1] * st->d->v[ci][1]                           \
-                         + st->d->b[2] * st->d->v[ci][2]                           \
-                         + st->d->b[3] * st->d->v[ci][3]                           \
-                         + st->d->b[4] * st->d->v[ci][4];                          \
-            st->d->v[ci][4] = st->d->v[ci][3];                                     \
-            st->d->v[ci][3] = st->d->v[ci][2];                                     \
-            st->d->v[ci][2] = st->d->v[ci][1];                                     \
-            st->d->v[ci][1] = st->d->v[ci][0];                                     \
+                           b0 * v0                                                 \
+                         + b1 * v1                                                 \
+                         + b2 * v2                                                 \
+                         + b3 * v3                                                 \
+                         + b4 * v4;                                                \
+            v4 = v3;                                                               \
+            v3 = v2;                                                               \
+            v2 = v1;                                                               \
+            v1 = v0;                                                               \
         }                                                                          \
-        st->d->v[ci][4] = fabs(st->d->v[ci][4]) < DBL_MIN ? 0.0 : st->d->v[ci][4]; \
-        st->d->v[ci][3] = fabs(st->d->v[ci][3]) < DBL_MIN ? 0.0 : st->d->v[ci][3]; \
-        st->d->v[ci][2] = fabs(st->d->v[ci][2]) < DBL_MIN ? 0.0 : st->d->v[ci][2]; \
-        st->d->v[ci][1] = fabs(st->d->v[ci][1]) < DBL_MIN ? 0.0 : st->d->v[ci][1]; \
+        v[0] = v1;                                                                 \
+        v[4] = fabs(v4) < DBL_MIN ? 0.0 : v4;                                      \
+        v[3] = fabs(v3) < DBL_MIN ? 0.0 : v3;                                      \
+        v[2] = fabs(v2) < DBL_MIN ? 0.0 : v2;                                      \
+        v[1] = fabs(v1) < DBL_MIN ? 0.0 : v1;                                      \
     }                                                                              \
 }
 EBUR128_FILTER(short, -((double)SHRT_MIN))
@@ -443,6 +468,57 @@ static void ebur128_calc_gating_block(FFEBUR128State * st,
     }
 }
 
+/* Compute the energies of the 100ms blocks completed up to audio_data_index,
+ * the gating blocks are then summed from them instead of rescanning 400ms or
+ * 3s of audio every 100ms. */
+static void ebur128_calc_block_energies(FFEBUR128State * st)
+{
+    const size_t block_samples = st->d->samples_in_100ms * st->channels;
+    size_t end = st->d->audio_data_index / block_samples;
+    size_t b, i, c;
+
+    for (b = st->d->block_energies_index; b < end; ++b) {
+        const double *data = st->d->audio_data + b * block_samples;
+        double sum = 0.0;
+        for (c = 0; c < st->channels; ++c) {
+            double channel_sum = 0.0;
+            if (st->d->channel_map[c] == FF_EBUR128_UNUSED)
+                continue;
+            for (i = c; i < block_samples; i += st->channels)
+                channel_sum += data[i] * data[i];
+            if (st->d->channel_map[c] == FF_EBUR128_Mp110 ||
+                st->d->channel_map[c] == FF_EBUR128_Mm110 ||
+                st->d->channel_map[c] == FF_EBUR128_Mp060 ||
+                st->d->channel_map[c] == FF_EBUR128_Mm060 ||
+                st->d->channel_map[c] == FF_EBUR128_Mp090 ||
+                st->d->channel_map[c] == FF_EBUR128_Mm090) {
+                channel_sum *= 1.41;
+            } else if (st->d->channel_map[c] == FF_EBUR128_DUAL_MONO) {
+                channel_sum *= 2.0;
+            }
+            sum += channel_sum;
+        }
+        st->d->block_energies[b] = sum;
+    }
+    st->d->block_energies_index = st->d->audio_data_index ==
+                                  st->d->audio_data_frames * st->channels ? 0 : end;
+}
+
+/* Mean energy of the nb_blocks 100ms blocks ending at audio_data_index. */
+static double ebur128_sum_block_energies(FFEBUR128State * st, size_t nb_blocks)
+{
+    const size_t nb_total = st->d->audio_data_frames / st->d->samples_in_100ms;
+    size_t b = st->d->audio_data_index / (st->d->samples_in_100ms * st->channels);
+    double sum = 0.0;
+    size_t i;
+
+    for (i = 0; i < nb_blocks; ++i) {
+        b = b ? b - 1 : nb_total - 1;
+        sum += st->d->block_energies[b];
+    }
+    return sum / (double) (nb_blocks * st->d->samples_in_100ms);
+}
+
 int ff_ebur128_set_channel(FFEBUR128State * st,
                            unsigned int channel_number, int value)
 {
@@ -457,7 +533,6 @@ int ff_ebur128_set_channel(FFEBUR128State * st,
     return 0;
 }
 
-static int ebur128_energy_shortterm(FFEBUR128State * st, double *out);
 #define FF_EBUR128_ADD_FRAMES_PLANAR(type)                                             \
 void ff_ebur128_add_frames_planar_##type(FFEBUR128State* st, const type** srcs,        \
                                  size_t frames, int stride) {                          \
@@ -468,15 +543,20 @@ void ff_ebur128_add_frames_planar_##type(FFEBUR128State* st, const type** srcs,
             src_index += st->d->needed_frames * stride;                                \
             frames -= st->d->needed_frames;                                            \
             st->d->audio_data_index += st->d->needed_frames * st->channels;            \
+            if ((st->mode & FF_EBUR128_MODE_I)   == FF_EBUR128_MODE_I ||               \
+                (st->mode & FF_EBUR128_MODE_LRA) == FF_EBUR128_MODE_LRA) {             \
+                ebur128_calc_block_energies(st);                                       \
+            }                                                                          \
             /* calculate the new gating block */                                       \
             if ((st->mode & FF_EBUR128_MODE_I) == FF_EBUR128_MODE_I) {                 \
-                ebur128_calc_gating_block(st, st->d->samples_in_100ms * 4, NULL);      \
+                double energy = ebur128_sum_block_energies(st, 4);                     \
+                if (energy >= histogram_energy_boundaries[0])                          \
+                    ++st->d->block_energy_histogram[find_histogram_index(energy)];     \
             }                                                                          \
             if ((st->mode & FF_EBUR128_MODE_LRA) == FF_EBUR128_MODE_LRA) {             \
                 st->d->short_term_frame_counter += st->d->needed_frames;               \
                 if (st->d->short_term_frame_counter == st->d->samples_in_100ms * 30) { \
-                    double st_energy;                                                  \
-                    ebur128_energy_shortterm(st, &st_energy);                          \
+                    double st_energy = ebur128_sum_block_energies(st, 30);             \
                     if (st_energy >= histogram_energy_boundaries[0]) {                 \
                         ++st->d->short_term_block_energy_histogram[                    \
                                                     find_histogram_index(st_energy)];  \
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2012 Clément Bœsch
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <math.h>
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "ebur128dsp.h"
+
+/* pre-filter coefficients */
+#define PRE_B0  1.53512485958697
+#define PRE_B1 -2.69169618940638
+#define PRE_B2  1.19839281085285
+#define PRE_A1 -1.69065929318241
+#define PRE_A2  0.73248077421585
+
+/* RLB-filter coefficients */
+#define RLB_B0  1.0
+#define RLB_B1 -2.0
+#define RLB_B2  1.0
+#define RLB_A1 -1.99004745483398
+#define RLB_A2  0.99007225036621
+
+static void filter_channels_c(double *x, double *y, double *z,
+                              const double *samples,
+                              double *cache_400, double *cache_3000,
+                              double *sum_400, double *sum_3000,
+                              int nb_channels)
+{
+    double *x1 = x, *x2 = x + nb_channels;
+    double *y1 = y, *y2 = y + nb_channels;
+    double *z1 = z, *z2 = z + nb_channels;
+    int ch;
+
+    for (ch = 0; ch < nb_channels; ch++) {
+        /* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2 */
+        const double x0 = samples[ch];
+        const double y0 = x0     * PRE_B0 + x1[ch] * PRE_B1 + x2[ch] * PRE_B2
+                                          - y1[ch] * PRE_A1 - y2[ch] * PRE_A2;
+        const double z0 = y0     * RLB_B0 + y1[ch] * RLB_B1 + y2[ch] * RLB_B2
+                                          - z1[ch] * RLB_A1 - z2[ch] * RLB_A2;
+        const double bin = z0 * z0;
+
+        x2[ch] = x1[ch];
+        x1[ch] = x0;
+        y2[ch] = y1[ch];
+        y1[ch] = y0;
+        z2[ch] = z1[ch];
+        z1[ch] = z0;
+
+        sum_400 [ch] = sum_400 [ch] + bin - cache_400 [ch];
+        sum_3000[ch] = sum_3000[ch] + bin - cache_3000[ch];
+        cache_400 [ch] = bin;
+        cache_3000[ch] = bin;
+    }
+}
+
+static void sample_peaks_c(double *ch_peaks, const double *samples,
+                           int nb_channels, int nb_samples)
+{
+    int i, ch;
+
+    for (i = 0; i < nb_samples; i++) {
+        for (ch = 0; ch < nb_channels; ch++)
+            ch_peaks[ch] = FFMAX(ch_peaks[ch], fabs(samples[ch]));
+        samples += nb_channels;
+    }
+}
+
+/* ITU-R BS.1770-4 Annex 2, 48 taps interpolation filter split in 4 phases */
+static const double tp_coeffs[4][EBUR128_TP_HISTORY + 1] = {
+    {  0.0017089843750,  0.0109863281250, -0.0196533203125,  0.0332031250000,
+      -0.0594482421875,  0.1373291015625,  0.9721679687500, -0.1022949218750,
+       0.0476074218750, -0.0266113281250,  0.0148925781250, -0.0083007812500 },
+    { -0.0291748046875,  0.0292968750000, -0.0517578125000,  0.0891113281250,
+      -0.1665039062500,  0.4650878906250,  0.7797851562500, -0.2003173828125,
+       0.1015625000000, -0.0582275390625,  0.0330810546875, -0.0189208984375 },
+    { -0.0189208984375,  0.0330810546875, -0.0582275390625,  0.1015625000000,
+      -0.2003173828125,  0.7797851562500,  0.4650878906250, -0.1665039062500,
+       0.0891113281250, -0.0517578125000,  0.0292968750000, -0.0291748046875 },
+    { -0.0083007812500,  0.0148925781250, -0.0266113281250,  0.0476074218750,
+      -0.1022949218750,  0.9721679687500,  0.1373291015625, -0.0594482421875,
+       0.0332031250000, -0.0196533203125,  0.0109863281250,  0.0017089843750 },
+};
+
+static void true_peaks_c(double *ch_peaks, const double *samples,
+                         int nb_channels, int nb_samples)
+{
+    int i, ch, p, k;
+
+    for (i = 0; i < nb_samples; i++) {
+        for (ch = 0; ch < nb_channels; ch++) {
+            double peak = ch_peaks[ch];
+
+            for (p = 0; p < 4; p++) {
+                const double *src = samples + ch;
+                double v = 0.0;
+
+                for (k = 0; k <= EBUR128_TP_HISTORY; k++) {
+                    v += tp_coeffs[p][k] * *src;
+                    src -= nb_channels;
+                }
+                peak = FFMAX(peak, fabs(v));
+            }
+            ch_peaks[ch] = peak;
+        }
+        samples += nb_channels;
+    }
+}
+
+av_cold void ff_ebur128_dsp_init(EBUR128DSPContext *dsp)
+{
+    dsp->filter_channels = filter_channels_c;
+    dsp->sample_peaks    = sample_peaks_c;
+    dsp->true_peaks      = true_peaks_c;
+
+    if (ARCH_X86)
+        ff_ebur128_dsp_init_x86(dsp);
+}
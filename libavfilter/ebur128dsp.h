@@ -0,0 +1,66 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_EBUR128DSP_H
+#define AVFILTER_EBUR128DSP_H
+
+/** number of past input frames needed by true_peaks() */
+#define EBUR128_TP_HISTORY 11
+
+typedef struct EBUR128DSPContext {
+    /**
+     * K-weight one frame of interleaved samples and update the energy
+     * windows of all the channels.
+     *
+     * The filter histories x (input), y (pre-filter output) and z (RLB-filter
+     * output) are each made of 2 planes of nb_channels values holding the
+     * [i-1] and [i-2] samples of every channel; they are updated in place.
+     *
+     * @param samples    nb_channels input samples
+     * @param cache_400  nb_channels entries of the 400ms window to replace
+     * @param cache_3000 nb_channels entries of the 3s window to replace
+     * @param sum_400    running sums of the 400ms window, per channel
+     * @param sum_3000   running sums of the 3s window, per channel
+     */
+    void (*filter_channels)(double *x, double *y, double *z,
+                            const double *samples,
+                            double *cache_400, double *cache_3000,
+                            double *sum_400, double *sum_3000,
+                            int nb_channels);
+
+    /**
+     * Update the per channel maximum absolute value of interleaved samples.
+     */
+    void (*sample_peaks)(double *ch_peaks, const double *samples,
+                         int nb_channels, int nb_samples);
+
+    /**
+     * Update the per channel maximum absolute value of interleaved samples
+     * oversampled by 4 with the polyphase FIR of ITU-R BS.1770-4 Annex 2.
+     *
+     * @param samples interleaved samples, the EBUR128_TP_HISTORY frames
+     *                preceding them must be readable
+     */
+    void (*true_peaks)(double *ch_peaks, const double *samples,
+                       int nb_channels, int nb_samples);
+} EBUR128DSPContext;
+
+void ff_ebur128_dsp_init(EBUR128DSPContext *dsp);
+void ff_ebur128_dsp_init_x86(EBUR128DSPContext *dsp);
+
+#endif /* AVFILTER_EBUR128DSP_H */
@@ -76,6 +76,9 @@ typedef struct PaletteGenContext {
     int nb_boxes;                           // number of boxes (increase will segmenting them)
     int palette_pushed;                     // if the palette frame is pushed into the outlink or not
     uint8_t transparency_color[4];          // background color for transparency
+    int nb_jobs;                            // number of histogram slice jobs
+    int *jobs_ret;                          // return value of each job
+    struct hist_node *job_hists;            // one histogram per job, merged into the main one
 } PaletteGenContext;
 
 #define OFFSET(x) offsetof(PaletteGenContext, x)
@@ -403,9 +406,9 @@ static inline unsigned color_hash(uint32_t color)
 }
 
 /**
- * Locate the color in the hash table and increment its counter.
+ * Locate the color in the hash table and add count to its counter.
  */
-static int color_inc(struct hist_node *hist, uint32_t color)
+static av_always_inline int color_add(struct hist_node *hist, uint32_t color, uint64_t count)
 {
     int i;
     const unsigned hash = color_hash(color);
@@ -415,7 +418,7 @@ static int color_inc(struct hist_node *hist, uint32_t color)
     for (i = 0; i < node->nb_entries; i++) {
         e = &node->entries[i];
         if (e->color == color) {
-            e->count++;
+            e->count += count;
             return 0;
         }
     }
@@ -425,26 +428,31 @@ static int color_inc(struct hist_node *hist, uint32_t color)
     if (!e)
         return AVERROR(ENOMEM);
     e->color = color;
-    e->count = 1;
+    e->count = count;
     return 1;
 }
 
+typedef struct ThreadData {
+    const AVFrame *f1, *f2;
+} ThreadData;
+
 /**
- * Update histogram when pixels differ from previous frame.
+ * Update a histogram with the pixels of f1 in the rows [y_start, y_end),
+ * skipping the ones identical to f2 if it is set.
  */
-static int update_histogram_diff(struct hist_node *hist,
-                                 const AVFrame *f1, const AVFrame *f2)
+static int update_histogram_rows(struct hist_node *hist, const AVFrame *f1, const AVFrame *f2,
+                                 int y_start, int y_end)
 {
     int x, y, ret, nb_diff_colors = 0;
 
-    for (y = 0; y < f1->height; y++) {
+    for (y = y_start; y < y_end; y++) {
         const uint32_t *p = (const uint32_t *)(f1->data[0] + y*f1->linesize[0]);
-        const uint32_t *q = (const uint32_t *)(f2->data[0] + y*f2->linesize[0]);
+        const uint32_t *q = f2 ? (const uint32_t *)(f2->data[0] + y*f2->linesize[0]) : NULL;
 
         for (x = 0; x < f1->width; x++) {
-            if (p[x] == q[x])
+            if (q && p[x] == q[x])
                 continue;
-            ret = color_inc(hist, p[x]);
+            ret = color_add(hist, p[x], 1);
             if (ret < 0)
                 return ret;
             nb_diff_colors += ret;
@@ -454,25 +462,80 @@ static int update_histogram_diff(struct hist_node *hist,
 }
 
 /**
- * Simple histogram of the frame.
+ * Build the histogram of a horizontal slice of the frame in the job's own
+ * histogram.
  */
-static int update_histogram_frame(struct hist_node *hist, const AVFrame *f)
+static int update_histogram_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    int x, y, ret, nb_diff_colors = 0;
+    PaletteGenContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    struct hist_node *hist = s->job_hists + jobnr * HIST_SIZE;
+    const int slice_start = (td->f1->height *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->f1->height * (jobnr+1)) / nb_jobs;
+    int i;
 
-    for (y = 0; y < f->height; y++) {
-        const uint32_t *p = (const uint32_t *)(f->data[0] + y*f->linesize[0]);
+    for (i = 0; i < HIST_SIZE; i++)
+        hist[i].nb_entries = 0;
+    return update_histogram_rows(hist, td->f1, td->f2, slice_start, slice_end);
+}
 
-        for (x = 0; x < f->width; x++) {
-            ret = color_inc(hist, p[x]);
-            if (ret < 0)
-                return ret;
-            nb_diff_colors += ret;
+/**
+ * Merge a range of buckets of the job histograms into the main histogram.
+ * The jobs are merged in the order of their slices, so every bucket lists
+ * its colors in the same order as a single scan of the frame would.
+ */
+static int merge_histograms_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PaletteGenContext *s = ctx->priv;
+    const int hash_start = (HIST_SIZE *  jobnr   ) / nb_jobs;
+    const int hash_end   = (HIST_SIZE * (jobnr+1)) / nb_jobs;
+    int i, j, k, ret, nb_diff_colors = 0;
+
+    for (j = 0; j < nb_jobs; j++) {
+        const struct hist_node *hist = s->job_hists + j * HIST_SIZE;
+
+        for (i = hash_start; i < hash_end; i++) {
+            const struct hist_node *node = &hist[i];
+
+            for (k = 0; k < node->nb_entries; k++) {
+                ret = color_add(s->histogram, node->entries[k].color, node->entries[k].count);
+                if (ret < 0)
+                    return ret;
+                nb_diff_colors += ret;
+            }
         }
     }
     return nb_diff_colors;
 }
 
+/**
+ * Update histogram for a frame, optionally only where pixels differ from
+ * another frame.
+ */
+static int update_histogram(AVFilterContext *ctx, const AVFrame *f1, const AVFrame *f2)
+{
+    PaletteGenContext *s = ctx->priv;
+    ThreadData td = { .f1 = f1, .f2 = f2 };
+    const int nb_jobs = FFMIN(s->nb_jobs, f1->height);
+    int i, nb_diff_colors = 0;
+
+    if (nb_jobs <= 1)
+        return update_histogram_rows(s->histogram, f1, f2, 0, f1->height);
+
+    ctx->internal->execute(ctx, update_histogram_slice, &td, s->jobs_ret, nb_jobs);
+    for (i = 0; i < nb_jobs; i++)
+        if (s->jobs_ret[i] < 0)
+            return s->jobs_ret[i];
+
+    ctx->internal->execute(ctx, merge_histograms_slice, NULL, s->jobs_ret, nb_jobs);
+    for (i = 0; i < nb_jobs; i++) {
+        if (s->jobs_ret[i] < 0)
+            return s->jobs_ret[i];
+        nb_diff_colors += s->jobs_ret[i];
+    }
+    return nb_diff_colors;
+}
+
 /**
  * Update the histogram for each passing frame. No frame will be pushed here.
  */
@@ -480,8 +543,8 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
     PaletteGenContext *s = ctx->priv;
-    int ret = s->prev_frame ? update_histogram_diff(s->histogram, s->prev_frame, in)
-                            : update_histogram_frame(s->histogram, in);
+    int ret = s->prev_frame ? update_histogram(ctx, s->prev_frame, in)
+                            : update_histogram(ctx, in, NULL);
 
     if (ret > 0)
         s->nb_refs += ret;
@@ -535,8 +598,21 @@ static int request_frame(AVFilterLink *outlink)
  */
 static int config_output(AVFilterLink *outlink)
 {
+    AVFilterContext *ctx = outlink->src;
+    PaletteGenContext *s = ctx->priv;
+
     outlink->w = outlink->h = 16;
     outlink->sample_aspect_ratio = av_make_q(1, 1);
+
+    s->nb_jobs = FFMIN(HIST_SIZE, ff_filter_get_nb_threads(ctx));
+    s->jobs_ret = av_calloc(s->nb_jobs, sizeof(*s->jobs_ret));
+    if (!s->jobs_ret)
+        return AVERROR(ENOMEM);
+    if (s->nb_jobs > 1) {
+        s->job_hists = av_calloc(s->nb_jobs * HIST_SIZE, sizeof(*s->job_hists));
+        if (!s->job_hists)
+            return AVERROR(ENOMEM);
+    }
     return 0;
 }
 
@@ -548,6 +624,11 @@ static av_cold void uninit(AVFilterContext *ctx)
     for (i = 0; i < HIST_SIZE; i++)
         av_freep(&s->histogram[i].entries);
     av_freep(&s->refs);
+    if (s->job_hists)
+        for (i = 0; i < s->nb_jobs * HIST_SIZE; i++)
+            av_freep(&s->job_hists[i].entries);
+    av_freep(&s->job_hists);
+    av_freep(&s->jobs_ret);
     av_frame_free(&s->prev_frame);
 }
 
@@ -579,4 +660,5 @@ AVFilter ff_vf_palettegen = {
     .inputs        = palettegen_inputs,
     .outputs       = palettegen_outputs,
     .priv_class    = &palettegen_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
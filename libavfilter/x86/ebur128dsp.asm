@@ -0,0 +1,226 @@
+;*****************************************************************************
+;* x86-optimized functions for the ebur128 filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+; ITU-R BS.1770-4 Annex 2 interpolation filter, one row of the 4 phases per tap
+tp_coeffs: dq  0.0017089843750, -0.0291748046875, -0.0189208984375, -0.0083007812500
+           dq  0.0109863281250,  0.0292968750000,  0.0330810546875,  0.0148925781250
+           dq -0.0196533203125, -0.0517578125000, -0.0582275390625, -0.0266113281250
+           dq  0.0332031250000,  0.0891113281250,  0.1015625000000,  0.0476074218750
+           dq -0.0594482421875, -0.1665039062500, -0.2003173828125, -0.1022949218750
+           dq  0.1373291015625,  0.4650878906250,  0.7797851562500,  0.9721679687500
+           dq  0.9721679687500,  0.7797851562500,  0.4650878906250,  0.1373291015625
+           dq -0.1022949218750, -0.2003173828125, -0.1665039062500, -0.0594482421875
+           dq  0.0476074218750,  0.1015625000000,  0.0891113281250,  0.0332031250000
+           dq -0.0266113281250, -0.0582275390625, -0.0517578125000, -0.0196533203125
+           dq  0.0148925781250,  0.0330810546875,  0.0292968750000,  0.0109863281250
+           dq -0.0083007812500, -0.0189208984375, -0.0291748046875,  0.0017089843750
+
+pd_abs:    times 4 dq 0x7fffffffffffffff
+
+; pre-filter and RLB-filter coefficients, b0 and b2 of the RLB-filter are 1.0
+pd_pre_b0: times 2 dq  1.53512485958697
+pd_pre_b1: times 2 dq -2.69169618940638
+pd_pre_b2: times 2 dq  1.19839281085285
+pd_pre_a1: times 2 dq -1.69065929318241
+pd_pre_a2: times 2 dq  0.73248077421585
+pd_rlb_b1: times 2 dq -2.0
+pd_rlb_a1: times 2 dq -1.99004745483398
+pd_rlb_a2: times 2 dq  0.99007225036621
+
+SECTION .text
+
+%if ARCH_X86_64
+
+;------------------------------------------------------------------------------
+; void ff_ebur128_filter_channels(double *x, double *y, double *z,
+;                                 const double *samples,
+;                                 double *cache_400, double *cache_3000,
+;                                 double *sum_400, double *sum_3000,
+;                                 int nb_channels)
+;------------------------------------------------------------------------------
+
+; %1 = load/store instruction, %2 = offset of the channels
+%macro FILTER_CHANNELS 2
+    %1                 m0, [samplesq+%2]
+    %1                 m1, [xq+%2]
+    %1                 m2, [x2q+%2]
+    %1      [x2q+%2], m1
+    %1       [xq+%2], m0
+    mulpd              m0, [pd_pre_b0]
+    mulpd              m1, [pd_pre_b1]
+    mulpd              m2, [pd_pre_b2]
+    addpd              m0, m1
+    addpd              m0, m2
+    %1                 m3, [yq+%2]
+    %1                 m4, [y2q+%2]
+    %1      [y2q+%2], m3
+    mulpd              m1, m3, [pd_pre_a1]
+    mulpd              m2, m4, [pd_pre_a2]
+    subpd              m0, m1
+    subpd              m0, m2
+    %1       [yq+%2], m0
+    mulpd              m3, [pd_rlb_b1]
+    addpd              m0, m3
+    addpd              m0, m4
+    %1                 m1, [zq+%2]
+    %1                 m2, [z2q+%2]
+    %1      [z2q+%2], m1
+    mulpd              m1, [pd_rlb_a1]
+    mulpd              m2, [pd_rlb_a2]
+    subpd              m0, m1
+    subpd              m0, m2
+    %1       [zq+%2], m0
+    mulpd              m0, m0
+    %1                 m1, [sum_400q+%2]
+    %1                 m2, [cache_400q+%2]
+    %1                 m3, [sum_3000q+%2]
+    %1                 m4, [cache_3000q+%2]
+    addpd              m1, m0
+    addpd              m3, m0
+    subpd              m1, m2
+    subpd              m3, m4
+    %1 [sum_400q+%2], m1
+    %1 [sum_3000q+%2], m3
+    %1 [cache_400q+%2], m0
+    %1 [cache_3000q+%2], m0
+%endmacro
+
+INIT_XMM sse2
+cglobal ebur128_filter_channels, 9, 12, 5, x, y, z, samples, cache_400, cache_3000, \
+                                           sum_400, sum_3000, len, x2, y2, z2
+    movsxdifnidn     lenq, lend
+    shl              lenq, 3
+    lea               x2q, [xq+lenq*2]
+    lea               y2q, [yq+lenq*2]
+    lea               z2q, [zq+lenq*2]
+    add                xq, lenq
+    add                yq, lenq
+    add                zq, lenq
+    add          samplesq, lenq
+    add        cache_400q, lenq
+    add       cache_3000q, lenq
+    add          sum_400q, lenq
+    add         sum_3000q, lenq
+    neg              lenq
+    add              lenq, mmsize
+    jg .tail
+.loop:
+    FILTER_CHANNELS movupd, lenq-mmsize
+    add              lenq, mmsize
+    jle .loop
+.tail:
+    ; the last channel of an odd count, the upper halves are zero
+    cmp              lenq, mmsize
+    je .end
+    FILTER_CHANNELS movsd, lenq-mmsize
+.end:
+    RET
+
+;------------------------------------------------------------------------------
+; void ff_ebur128_true_peaks(double *ch_peaks, const double *samples,
+;                            int nb_channels, int nb_samples)
+;------------------------------------------------------------------------------
+
+; %1 = tap, %2 = address of the input sample
+%macro TRUE_PEAK_TAP 2
+%if mmsize == 32
+%if %1 == 0
+    vbroadcastsd       m0, %2
+    mulpd              m0, [tp_coeffs]
+%else
+    vbroadcastsd       m1, %2
+    mulpd              m1, [tp_coeffs+%1*32]
+    addpd              m0, m1
+%endif
+%else ; mmsize == 16, phases 0-1 in m0 and 2-3 in m1
+%if %1 == 0
+    movddup            m1, %2
+    mulpd              m0, m1, [tp_coeffs]
+    mulpd              m1, [tp_coeffs+16]
+%else
+    movddup            m2, %2
+    mulpd              m3, m2, [tp_coeffs+%1*32]
+    mulpd              m2, [tp_coeffs+%1*32+16]
+    addpd              m0, m3
+    addpd              m1, m2
+%endif
+%endif
+%endmacro
+
+%macro TRUE_PEAKS 0
+cglobal ebur128_true_peaks, 4, 9, 4, ch_peaks, samples, nb_channels, len, stride, \
+                                     stride3, src4, src8, ch
+    movsxdifnidn nb_channelsq, nb_channelsd
+    imul             lend, nb_channelsd
+    lea           strideq, [nb_channelsq*8]
+    add         ch_peaksq, strideq
+    neg           strideq
+    lea          stride3q, [strideq*3]
+    mov               chq, strideq
+.loop:
+    ; the interleaved channels are processed one after the other, going back
+    ; 1 frame per tap
+    lea             src4q, [samplesq+strideq*4]
+    lea             src8q, [samplesq+strideq*8]
+    TRUE_PEAK_TAP       0, [samplesq]
+    TRUE_PEAK_TAP       1, [samplesq+strideq]
+    TRUE_PEAK_TAP       2, [samplesq+strideq*2]
+    TRUE_PEAK_TAP       3, [samplesq+stride3q]
+    TRUE_PEAK_TAP       4, [src4q]
+    TRUE_PEAK_TAP       5, [src4q+strideq]
+    TRUE_PEAK_TAP       6, [src4q+strideq*2]
+    TRUE_PEAK_TAP       7, [src4q+stride3q]
+    TRUE_PEAK_TAP       8, [src8q]
+    TRUE_PEAK_TAP       9, [src8q+strideq]
+    TRUE_PEAK_TAP      10, [src8q+strideq*2]
+    TRUE_PEAK_TAP      11, [src8q+stride3q]
+%if mmsize == 32
+    andpd              m0, [pd_abs]
+    vextractf128      xm1, m0, 1
+    maxpd             xm0, xm1
+%else
+    andpd              m0, [pd_abs]
+    andpd              m1, [pd_abs]
+    maxpd              m0, m1
+%endif
+    movhlps           xm1, xm0
+    maxsd             xm0, xm1
+    maxsd             xm0, [ch_peaksq+chq]
+    movsd [ch_peaksq+chq], xm0
+    add          samplesq, 8
+    add               chq, 8
+    cmovge            chq, strideq
+    dec              lend
+    jg .loop
+    RET
+%endmacro
+
+INIT_XMM sse3
+TRUE_PEAKS
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+TRUE_PEAKS
+%endif
+
+%endif ; ARCH_X86_64
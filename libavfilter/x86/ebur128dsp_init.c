@@ -0,0 +1,49 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/ebur128dsp.h"
+
+void ff_ebur128_filter_channels_sse2(double *x, double *y, double *z,
+                                     const double *samples,
+                                     double *cache_400, double *cache_3000,
+                                     double *sum_400, double *sum_3000,
+                                     int nb_channels);
+
+void ff_ebur128_true_peaks_sse3(double *ch_peaks, const double *samples,
+                                int nb_channels, int nb_samples);
+void ff_ebur128_true_peaks_avx(double *ch_peaks, const double *samples,
+                               int nb_channels, int nb_samples);
+
+av_cold void ff_ebur128_dsp_init_x86(EBUR128DSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (ARCH_X86_64 && EXTERNAL_SSE2(cpu_flags)) {
+        dsp->filter_channels = ff_ebur128_filter_channels_sse2;
+    }
+    if (ARCH_X86_64 && EXTERNAL_SSE3(cpu_flags)) {
+        dsp->true_peaks = ff_ebur128_true_peaks_sse3;
+    }
+    if (ARCH_X86_64 && EXTERNAL_AVX_FAST(cpu_flags)) {
+        dsp->true_peaks = ff_ebur128_true_peaks_avx;
+    }
+}
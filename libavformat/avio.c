@@ -433,6 +433,57 @@ int ffurl_write(URLContext *h, const unsigned char *buf, int size)
                                   h->prot->url_write);
 }
 
+int ffurl_writev(URLContext *h, const URLIOVec *vecs, int nb_vecs)
+{
+    int i, ret, written, total = 0, done = 0;
+
+    if (!(h->flags & AVIO_FLAG_WRITE))
+        return AVERROR(EIO);
+    for (i = 0; i < nb_vecs; i++) {
+        if (h->max_packet_size && vecs[i].size > h->max_packet_size)
+            return AVERROR(EIO);
+        total += vecs[i].size;
+    }
+
+    if (h->prot->url_writev && nb_vecs > 1) {
+        while (nb_vecs > 0) {
+            if (ff_check_interrupt(&h->interrupt_callback))
+                return AVERROR_EXIT;
+            ret = h->prot->url_writev(h, vecs, FFMIN(nb_vecs, URL_MAX_IOVECS));
+            if (ret == AVERROR(EINTR) || ret == AVERROR(EAGAIN))
+                ret = 0;
+            else if (ret < 0)
+                return ret;
+            done   += ret;
+            written = ret;
+            /* skip the fully written buffers */
+            while (nb_vecs > 0 && ret >= vecs->size) {
+                ret -= vecs->size;
+                vecs++;
+                nb_vecs--;
+            }
+            /* a partially written buffer is completed by ffurl_write(),
+             * which also takes care of waiting when nothing was written */
+            if (nb_vecs > 0 && (ret || !written)) {
+                int ret2 = ffurl_write(h, vecs->data + ret, vecs->size - ret);
+                if (ret2 < 0)
+                    return ret2;
+                done += ret2;
+                vecs++;
+                nb_vecs--;
+            }
+        }
+        return done;
+    }
+
+    for (i = 0; i < nb_vecs; i++) {
+        ret = ffurl_write(h, vecs[i].data, vecs[i].size);
+        if (ret < 0)
+            return ret;
+    }
+    return total;
+}
+
 int64_t ffurl_seek(URLContext *h, int64_t pos, int whence)
 {
     int64_t ret;
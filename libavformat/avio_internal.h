@@ -55,6 +55,14 @@ int ffio_read_indirect(AVIOContext *s, unsigned char *buf, int size, const unsig
 
 void ffio_fill(AVIOContext *s, int b, int count);
 
+/**
+ * Write nb_vecs buffers as if they were passed to avio_write() one after
+ * the other. When the data is large enough and the protocol supports it,
+ * the buffered data and the buffers are written with a single call and
+ * without being copied.
+ */
+void ffio_writev(AVIOContext *s, const URLIOVec *vecs, int nb_vecs);
+
 static av_always_inline void ffio_wfourcc(AVIOContext *pb, const uint8_t *s)
 {
     avio_wl32(pb, MKTAG(s[0], s[1], s[2], s[3]));
@@ -157,6 +157,27 @@ void avio_context_free(AVIOContext **ps)
     av_freep(ps);
 }
 
+static void writeout_done(AVIOContext *s, int len, int ret)
+{
+    if (ret < 0) {
+        s->error = ret;
+    } else {
+        if (s->pos + len > s->written)
+            s->written = s->pos + len;
+    }
+}
+
+static void writeout_end(AVIOContext *s, int len)
+{
+    if (s->current_type == AVIO_DATA_MARKER_SYNC_POINT ||
+        s->current_type == AVIO_DATA_MARKER_BOUNDARY_POINT) {
+        s->current_type = AVIO_DATA_MARKER_UNKNOWN;
+    }
+    s->last_time = AV_NOPTS_VALUE;
+    s->writeout_count ++;
+    s->pos += len;
+}
+
 static void writeout(AVIOContext *s, const uint8_t *data, int len)
 {
     if (!s->error) {
@@ -168,27 +189,82 @@ static void writeout(AVIOContext *s, const uint8_t *data, int len)
                                      s->last_time);
         else if (s->write_packet)
             ret = s->write_packet(s->opaque, (uint8_t *)data, len);
-        if (ret < 0) {
-            s->error = ret;
-        } else {
-            if (s->pos + len > s->written)
-                s->written = s->pos + len;
-        }
+        writeout_done(s, len, ret);
     }
-    if (s->current_type == AVIO_DATA_MARKER_SYNC_POINT ||
-        s->current_type == AVIO_DATA_MARKER_BOUNDARY_POINT) {
-        s->current_type = AVIO_DATA_MARKER_UNKNOWN;
+    writeout_end(s, len);
+}
+
+static int dyn_buf_write(void *opaque, uint8_t *buf, int buf_size);
+
+/**
+ * Check whether a write can bypass the buffer. This is only done for the
+ * contexts opened by lavf itself on top of a stream protocol or a dynamic
+ * buffer, and when no checksum or packet boundary needs the data to go
+ * through the buffer.
+ */
+static int can_write_through(AVIOContext *s, int size)
+{
+    if (size < s->buffer_size || s->update_checksum || s->write_data_type ||
+        s->max_packet_size && !s->min_packet_size || s->buf_ptr < s->buf_ptr_max)
+        return 0;
+    return s->write_packet == (int (*)(void *, uint8_t *, int))ffurl_write ||
+           s->write_packet == dyn_buf_write;
+}
+
+static URLContext *writev_context(AVIOContext *s)
+{
+    URLContext *h = s->opaque;
+    if (s->write_packet == (int (*)(void *, uint8_t *, int))ffurl_write &&
+        h->prot->url_writev)
+        return h;
+    return NULL;
+}
+
+static void write_vecs(AVIOContext *s, URLContext *h, const URLIOVec *vecs, int nb_vecs)
+{
+    int i, len = 0;
+
+    if (!h) {
+        for (i = 0; i < nb_vecs; i++)
+            writeout(s, vecs[i].data, vecs[i].size);
+        return;
     }
-    s->last_time = AV_NOPTS_VALUE;
-    s->writeout_count ++;
-    s->pos += len;
+    for (i = 0; i < nb_vecs; i++)
+        len += vecs[i].size;
+    if (!s->error)
+        writeout_done(s, len, ffurl_writev(h, vecs, nb_vecs));
+    writeout_end(s, len);
+}
+
+/* Write the buffered data of a context holding several packets, one
+ * packet of up to max_packet_size bytes per buffer. */
+static void writeout_packets(AVIOContext *s, const uint8_t *data, int len)
+{
+    URLIOVec v[URL_MAX_IOVECS];
+    int n = 0;
+
+    while (len > 0) {
+        if (n == URL_MAX_IOVECS) {
+            write_vecs(s, writev_context(s), v, n);
+            n = 0;
+        }
+        v[n].data = data;
+        v[n].size = FFMIN(len, s->max_packet_size);
+        data     += v[n].size;
+        len      -= v[n++].size;
+    }
+    write_vecs(s, writev_context(s), v, n);
 }
 
 static void flush_buffer(AVIOContext *s)
 {
     s->buf_ptr_max = FFMAX(s->buf_ptr, s->buf_ptr_max);
     if (s->write_flag && s->buf_ptr_max > s->buffer) {
-        writeout(s, s->buffer, s->buf_ptr_max - s->buffer);
+        if (s->max_packet_size && !s->min_packet_size &&
+            s->buf_ptr_max - s->buffer > s->max_packet_size)
+            writeout_packets(s, s->buffer, s->buf_ptr_max - s->buffer);
+        else
+            writeout(s, s->buffer, s->buf_ptr_max - s->buffer);
         if (s->update_checksum) {
             s->checksum     = s->update_checksum(s->checksum, s->checksum_ptr,
                                                  s->buf_ptr_max - s->checksum_ptr);
@@ -222,6 +298,41 @@ void ffio_fill(AVIOContext *s, int b, int count)
     }
 }
 
+/**
+ * Write the buffered data followed by vecs, with a single protocol call
+ * when possible. Must only be used when can_write_through() is true.
+ */
+static void write_through(AVIOContext *s, const URLIOVec *vecs, int nb_vecs)
+{
+    URLIOVec v[URL_MAX_IOVECS];
+    URLContext *h = writev_context(s);
+    int max_size = s->max_packet_size ? s->max_packet_size : INT_MAX;
+    int i, n = 0;
+
+    if (s->buf_ptr > s->buffer) {
+        v[n].data   = s->buffer;
+        v[n++].size = s->buf_ptr - s->buffer;
+    }
+    for (i = 0; i < nb_vecs; i++) {
+        const uint8_t *data = vecs[i].data;
+        int size = vecs[i].size;
+
+        /* protocols buffering up to max_packet_size take no larger writes */
+        while (size > 0) {
+            if (n == URL_MAX_IOVECS) {
+                write_vecs(s, h, v, n);
+                n = 0;
+            }
+            v[n].data = data;
+            v[n].size = FFMIN(size, max_size);
+            data     += v[n].size;
+            size     -= v[n++].size;
+        }
+    }
+    write_vecs(s, h, v, n);
+    s->buf_ptr = s->buf_ptr_max = s->buffer;
+}
+
 void avio_write(AVIOContext *s, const unsigned char *buf, int size)
 {
     if (s->direct && !s->update_checksum) {
@@ -229,6 +340,11 @@ void avio_write(AVIOContext *s, const unsigned char *buf, int size)
         writeout(s, buf, size);
         return;
     }
+    if (can_write_through(s, size)) {
+        URLIOVec vec = { buf, size };
+        write_through(s, &vec, 1);
+        return;
+    }
     while (size > 0) {
         int len = FFMIN(s->buf_end - s->buf_ptr, size);
         memcpy(s->buf_ptr, buf, len);
@@ -242,6 +358,23 @@ void avio_write(AVIOContext *s, const unsigned char *buf, int size)
     }
 }
 
+void ffio_writev(AVIOContext *s, const URLIOVec *vecs, int nb_vecs)
+{
+    int i, size = 0;
+
+    for (i = 0; i < nb_vecs; i++) {
+        if (vecs[i].size > INT_MAX - size)
+            break;
+        size += vecs[i].size;
+    }
+    if (i == nb_vecs && writev_context(s) && can_write_through(s, size)) {
+        write_through(s, vecs, nb_vecs);
+        return;
+    }
+    for (i = 0; i < nb_vecs; i++)
+        avio_write(s, vecs[i].data, vecs[i].size);
+}
+
 void avio_flush(AVIOContext *s)
 {
     int seekback = s->write_flag ? FFMIN(0, s->buf_ptr - s->buf_ptr_max) : 0;
@@ -928,6 +1061,14 @@ int ffio_fdopen(AVIOContext **s, URLContext *h)
     max_packet_size = h->max_packet_size;
     if (max_packet_size) {
         buffer_size = max_packet_size; /* no need to bufferize more than one packet */
+        /* unless the protocol can send several of them at once */
+        if (h->flags & AVIO_FLAG_WRITE && h->max_packets > 1 &&
+            !h->min_packet_size && h->prot->url_writev) {
+            int max_packets = FFMIN(h->max_packets, URL_MAX_IOVECS);
+            if (max_packet_size > INT_MAX / max_packets)
+                return AVERROR(EINVAL);
+            buffer_size *= max_packets;
+        }
     } else {
         buffer_size = IO_BUFFER_SIZE;
     }
@@ -46,6 +46,7 @@
 #endif
 #include "internal.h"
 #include "isom.h"
+#include "liveorigin.h"
 #include "os_support.h"
 #include "url.h"
 #include "vpcc.h"
@@ -199,6 +200,10 @@ typedef struct DASHContext {
     AVRational min_playback_rate;
     AVRational max_playback_rate;
     int64_t update_period;
+    char *origin_listen;
+    int origin_max_files;
+    int origin_wait;
+    LiveOrigin *origin;
 } DASHContext;
 
 static struct codec_string {
@@ -228,7 +233,9 @@ static int dashenc_io_open(AVFormatContext *s, AVIOContext **pb, char *filename,
     DASHContext *c = s->priv_data;
     int http_base_proto = filename ? ff_is_http_proto(filename) : 0;
     int err = AVERROR_MUXER_NOT_FOUND;
-    if (!*pb || !http_base_proto || !c->http_persistent) {
+    if (c->origin) {
+        err = ff_live_origin_io_open(c->origin, pb, filename);
+    } else if (!*pb || !http_base_proto || !c->http_persistent) {
         err = s->io_open(s, pb, filename, AVIO_FLAG_WRITE, options);
 #if CONFIG_HTTP_PROTOCOL
     } else {
@@ -249,7 +256,9 @@ static void dashenc_io_close(AVFormatContext *s, AVIOContext **pb, char *filenam
     if (!*pb)
         return;
 
-    if (!http_base_proto || !c->http_persistent) {
+    if (c->origin) {
+        ff_live_origin_io_close(c->origin, pb);
+    } else if (!http_base_proto || !c->http_persistent) {
         ff_format_io_close(s, pb);
 #if CONFIG_HTTP_PROTOCOL
     } else {
@@ -525,7 +534,7 @@ static void write_hls_media_playlist(OutputStream *os, AVFormatContext *s,
     int target_duration = 0;
     int ret = 0;
     const char *proto = avio_find_protocol_name(c->dirname);
-    int use_rename = proto && !strcmp(proto, "file");
+    int use_rename = proto && !strcmp(proto, "file") && !c->origin;
     int i, start_index, start_number;
     double prog_date_time = 0;
 
@@ -635,7 +644,7 @@ static void dash_free(AVFormatContext *s)
             else
                 avio_close(os->ctx->pb);
         }
-        ff_format_io_close(s, &os->out);
+        dashenc_io_close(s, &os->out, NULL);
         avformat_free_context(os->ctx);
         avcodec_free_context(&os->parser_avctx);
         av_parser_close(os->parser);
@@ -648,8 +657,9 @@ static void dash_free(AVFormatContext *s)
     }
     av_freep(&c->streams);
 
-    ff_format_io_close(s, &c->mpd_out);
-    ff_format_io_close(s, &c->m3u8_out);
+    dashenc_io_close(s, &c->mpd_out, NULL);
+    dashenc_io_close(s, &c->m3u8_out, NULL);
+    ff_live_origin_close(&c->origin);
 }
 
 static void output_segment_list(OutputStream *os, AVIOContext *out, AVFormatContext *s,
@@ -1148,12 +1158,12 @@ static int write_manifest(AVFormatContext *s, int final)
     char temp_filename[1024];
     int ret, i;
     const char *proto = avio_find_protocol_name(s->url);
-    int use_rename = proto && !strcmp(proto, "file");
+    int use_rename = proto && !strcmp(proto, "file") && !c->origin;
     static unsigned int warned_non_file = 0;
     AVDictionaryEntry *title = av_dict_get(s->metadata, "title", NULL, 0);
     AVDictionary *opts = NULL;
 
-    if (!use_rename && !warned_non_file++)
+    if (!use_rename && !c->origin && !warned_non_file++)
         av_log(s, AV_LOG_ERROR, "Cannot use rename on non file protocol, this may lead to races and temporary partial files\n");
 
     snprintf(temp_filename, sizeof(temp_filename), use_rename ? "%s.tmp" : "%s", s->url);
@@ -1450,6 +1460,17 @@ static int dash_init(AVFormatContext *s)
         c->min_playback_rate = c->max_playback_rate = (AVRational) {1, 1};
     }
 
+    if (c->origin_listen) {
+        if (c->single_file) {
+            av_log(s, AV_LOG_ERROR, "single_file cannot be served by the built-in origin\n");
+            return AVERROR(EINVAL);
+        }
+        ret = ff_live_origin_open(&c->origin, c->origin_listen, c->origin_max_files,
+                                  c->origin_wait, s);
+        if (ret < 0)
+            return ret;
+    }
+
     av_strlcpy(c->dirname, s->url, sizeof(c->dirname));
     ptr = strrchr(c->dirname, '/');
     if (ptr) {
@@ -1574,7 +1595,7 @@ static int dash_init(AVFormatContext *s)
         if (!c->single_file) {
             if ((ret = avio_open_dyn_buf(&ctx->pb)) < 0)
                 return ret;
-            ret = s->io_open(s, &os->out, filename, AVIO_FLAG_WRITE, &opts);
+            ret = dashenc_io_open(s, &os->out, filename, &opts);
         } else {
             ctx->url = av_strdup(filename);
             ret = avio_open2(&ctx->pb, filename, AVIO_FLAG_WRITE, NULL, &opts);
@@ -1839,7 +1860,9 @@ static void dashenc_delete_file(AVFormatContext *s, char *filename) {
     DASHContext *c = s->priv_data;
     int http_base_proto = ff_is_http_proto(filename);
 
-    if (http_base_proto) {
+    if (c->origin) {
+        ff_live_origin_delete(c->origin, filename);
+    } else if (http_base_proto) {
         AVIOContext *out = NULL;
         AVDictionary *http_opts = NULL;
 
@@ -1901,7 +1924,7 @@ static int dash_flush(AVFormatContext *s, int final, int stream)
     int i, ret = 0;
 
     const char *proto = avio_find_protocol_name(s->url);
-    int use_rename = proto && !strcmp(proto, "file");
+    int use_rename = proto && !strcmp(proto, "file") && !c->origin;
 
     int cur_flush_segment_index = 0, next_exp_index = -1;
     if (stream >= 0) {
@@ -2231,7 +2254,7 @@ static int dash_write_packet(AVFormatContext *s, AVPacket *pkt)
     if (!c->single_file && os->packets_written == 1) {
         AVDictionary *opts = NULL;
         const char *proto = avio_find_protocol_name(s->url);
-        int use_rename = proto && !strcmp(proto, "file");
+        int use_rename = proto && !strcmp(proto, "file") && !c->origin;
         if (os->segment_type == SEGMENT_TYPE_MP4)
             write_styp(os->ctx->pb);
         os->filename[0] = os->full_path[0] = os->temp_path[0] = '\0';
@@ -2384,6 +2407,9 @@ static const AVOption options[] = {
     { "min_playback_rate", "Set desired minimum playback rate", OFFSET(min_playback_rate), AV_OPT_TYPE_RATIONAL, { .dbl = 1.0 }, 0.5, 1.5, E },
     { "max_playback_rate", "Set desired maximum playback rate", OFFSET(max_playback_rate), AV_OPT_TYPE_RATIONAL, { .dbl = 1.0 }, 0.5, 1.5, E },
     { "update_period", "Set the mpd update interval", OFFSET(update_period), AV_OPT_TYPE_INT64, {.i64 = 0}, 0, INT64_MAX, E},
+    { "origin_listen", "serve the output from memory with a built-in HTTP server listening on [host]:port", OFFSET(origin_listen), AV_OPT_TYPE_STRING, { .str = NULL }, 0, 0, E },
+    { "origin_max_files", "maximum number of segments kept in memory by the built-in HTTP server", OFFSET(origin_max_files), AV_OPT_TYPE_INT, { .i64 = 16 }, 1, INT_MAX, E },
+    { "origin_wait", "how long (in milliseconds) a request for a file not created yet is held", OFFSET(origin_wait), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, INT_MAX, E },
     { NULL },
 };
 
@@ -34,6 +34,9 @@
 #include <unistd.h>
 #endif
 #include <sys/stat.h>
+#if HAVE_WRITEV
+#include <sys/uio.h>
+#endif
 #include <stdlib.h>
 #include "os_support.h"
 #include "url.h"
@@ -128,6 +131,23 @@ static int file_write(URLContext *h, const unsigned char *buf, int size)
     return (ret == -1) ? AVERROR(errno) : ret;
 }
 
+#if HAVE_WRITEV
+static int file_writev(URLContext *h, const URLIOVec *vecs, int nb_vecs)
+{
+    FileContext *c = h->priv_data;
+    struct iovec iov[URL_MAX_IOVECS];
+    int i, size = 0, ret;
+
+    for (i = 0; i < nb_vecs && size < c->blocksize; i++) {
+        iov[i].iov_base = (void *)vecs[i].data;
+        iov[i].iov_len  = FFMIN(vecs[i].size, c->blocksize - size);
+        size += iov[i].iov_len;
+    }
+    ret = writev(c->fd, iov, i);
+    return (ret == -1) ? AVERROR(errno) : ret;
+}
+#endif
+
 static int file_get_handle(URLContext *h)
 {
     FileContext *c = h->priv_data;
@@ -358,6 +378,9 @@ const URLProtocol ff_file_protocol = {
     .url_open            = file_open,
     .url_read            = file_read,
     .url_write           = file_write,
+#if HAVE_WRITEV
+    .url_writev          = file_writev,
+#endif
     .url_seek            = file_seek,
     .url_close           = file_close,
     .url_get_file_handle = file_get_handle,
@@ -404,6 +427,9 @@ const URLProtocol ff_pipe_protocol = {
     .url_open            = pipe_open,
     .url_read            = file_read,
     .url_write           = file_write,
+#if HAVE_WRITEV
+    .url_writev          = file_writev,
+#endif
     .url_get_file_handle = file_get_handle,
     .url_check           = file_check,
     .priv_data_size      = sizeof(FileContext),
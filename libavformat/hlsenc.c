@@ -51,6 +51,7 @@
 #endif
 #include "hlsplaylist.h"
 #include "internal.h"
+#include "liveorigin.h"
 #include "os_support.h"
 
 typedef enum {
@@ -72,6 +73,11 @@ typedef enum {
 #define BUFSIZE (16 * 1024)
 #define POSTFIX_PATTERN "_%d"
 
+typedef struct HLSPart {
+    double duration; /* in seconds */
+    int independent;
+} HLSPart;
+
 typedef struct HLSSegment {
     char filename[MAX_URL_SIZE];
     char sub_filename[MAX_URL_SIZE];
@@ -86,6 +92,9 @@ typedef struct HLSSegment {
     char key_uri[LINE_BUFFER_SIZE + 1];
     char iv_string[KEYSIZE*2 + 1];
 
+    HLSPart *parts;  /* partial segments, named after the segment */
+    int nb_parts;
+
     struct HLSSegment *next;
 } HLSSegment;
 
@@ -143,6 +152,13 @@ typedef struct VariantStream {
     int64_t start_pos;    // last segment starting position
     int64_t size;         // last segment size
     int nb_entries;
+
+    HLSPart *parts;       // partial segments of the current segment
+    int nb_parts;
+    int64_t part_start_pts;
+    int part_start_pos;   // start of the current part in the segment buffer
+    int part_independent;
+    int part_hint;        // the next part belongs to the current segment
     int discontinuity_set;
     int discontinuity;
     int reference_stream_index;
@@ -196,6 +212,7 @@ typedef struct HLSContext {
 
     float time;            // Set by a private option.
     float init_time;       // Set by a private option.
+    float part_time;       // Set by a private option.
     int max_nb_segments;   // Set by a private option.
     int hls_delete_threshold; // Set by a private option.
 #if FF_API_HLS_WRAP
@@ -256,6 +273,11 @@ typedef struct HLSContext {
     char *headers;
     int has_default_key; /* has DEFAULT field of var_stream_map */
     int has_video_m3u8; /* has video stream m3u8 list */
+
+    char *origin_listen;
+    int origin_max_files;
+    int origin_wait;
+    LiveOrigin *origin;
 } HLSContext;
 
 static int hlsenc_io_open(AVFormatContext *s, AVIOContext **pb, char *filename,
@@ -264,7 +286,9 @@ static int hlsenc_io_open(AVFormatContext *s, AVIOContext **pb, char *filename,
     HLSContext *hls = s->priv_data;
     int http_base_proto = filename ? ff_is_http_proto(filename) : 0;
     int err = AVERROR_MUXER_NOT_FOUND;
-    if (!*pb || !http_base_proto || !hls->http_persistent) {
+    if (hls->origin) {
+        err = ff_live_origin_io_open(hls->origin, pb, filename);
+    } else if (!*pb || !http_base_proto || !hls->http_persistent) {
         err = s->io_open(s, pb, filename, AVIO_FLAG_WRITE, options);
 #if CONFIG_HTTP_PROTOCOL
     } else {
@@ -286,7 +310,9 @@ static int hlsenc_io_close(AVFormatContext *s, AVIOContext **pb, char *filename)
     int ret = 0;
     if (!*pb)
         return ret;
-    if (!http_base_proto || !hls->http_persistent || hls->key_info_file || hls->encrypt) {
+    if (hls->origin) {
+        ff_live_origin_io_close(hls->origin, pb);
+    } else if (!http_base_proto || !hls->http_persistent || hls->key_info_file || hls->encrypt) {
         ff_format_io_close(s, pb);
 #if CONFIG_HTTP_PROTOCOL
     } else {
@@ -496,10 +522,46 @@ static void reflush_dynbuf(VariantStream *vs, int *range_length)
 #define SEPARATOR '/'
 #endif
 
+static void hls_free_segment(HLSSegment **en)
+{
+    av_freep(&(*en)->parts);
+    av_freep(en);
+}
+
+/* partial segment n of "name.ext" is "name.part<n>.ext" */
+static void hls_part_filename(char *buf, int size, const char *segment, int n)
+{
+    const char *ext = strrchr(segment, '.');
+
+    if (!ext || strchr(ext, '/'))
+        ext = segment + strlen(segment);
+    snprintf(buf, size, "%.*s.part%d%s", (int)(ext - segment), segment, n, ext);
+}
+
+/* final name of the segment being written, without the temp_file suffix */
+static void hls_current_segment_name(HLSContext *hls, VariantStream *vs,
+                                     char *buf, int size)
+{
+    size_t len;
+
+    av_strlcpy(buf, vs->avf->url, size);
+    len = strlen(buf);
+    if ((hls->flags & HLS_TEMP_FILE) && len > 4 && !strcmp(buf + len - 4, ".tmp"))
+        buf[len - 4] = '\0';
+}
+
+/* name of a segment file as listed in the playlist */
+static const char *hls_playlist_name(HLSContext *hls, const char *url)
+{
+    return hls->use_localtime_mkdir ? url : av_basename(url);
+}
+
 static int hls_delete_file(HLSContext *hls, AVFormatContext *avf,
                            const char *path, const char *proto)
 {
-    if (hls->method || (proto && !av_strcasecmp(proto, "http"))) {
+    if (hls->origin) {
+        ff_live_origin_delete(hls->origin, path);
+    } else if (hls->method || (proto && !av_strcasecmp(proto, "http"))) {
         AVDictionary *opt = NULL;
         AVIOContext  *out = NULL;
         int ret;
@@ -522,7 +584,7 @@ static int hls_delete_old_segments(AVFormatContext *s, HLSContext *hls,
 
     HLSSegment *segment, *previous_segment = NULL;
     float playlist_duration = 0.0f;
-    int ret = 0;
+    int ret = 0, i;
     int segment_cnt = 0;
     AVBPrint path;
     const char *dirname = NULL;
@@ -596,6 +658,14 @@ static int hls_delete_old_segments(AVFormatContext *s, HLSContext *hls,
         if (ret = hls_delete_file(hls, vs->avf, path.str, proto))
             goto fail;
 
+        for (i = 0; i < segment->nb_parts; i++) {
+            char part[MAX_URL_SIZE];
+
+            hls_part_filename(part, sizeof(part), path.str, i);
+            if (ret = hls_delete_file(hls, vs->avf, part, proto))
+                goto fail;
+        }
+
         if ((segment->sub_filename[0] != '\0')) {
             vtt_dirname_r = av_strdup(vs->vtt_avf->url);
             vtt_dirname = av_dirname(vtt_dirname_r);
@@ -616,7 +686,7 @@ static int hls_delete_old_segments(AVFormatContext *s, HLSContext *hls,
         av_bprint_clear(&path);
         previous_segment = segment;
         segment = previous_segment->next;
-        av_freep(&previous_segment);
+        hls_free_segment(&previous_segment);
     }
 
 fail:
@@ -1079,6 +1149,20 @@ static int hls_append_segment(struct AVFormatContext *s, HLSContext *hls,
     en->next     = NULL;
     en->discont  = 0;
 
+    en->parts    = vs->parts;
+    en->nb_parts = vs->nb_parts;
+    vs->parts    = NULL;
+    vs->nb_parts = 0;
+    vs->part_hint = 0;
+    if (en->nb_parts) {
+        /* the last part ends with the segment */
+        double last = duration;
+        int i;
+        for (i = 0; i < en->nb_parts - 1; i++)
+            last -= en->parts[i].duration;
+        en->parts[en->nb_parts - 1].duration = FFMAX(last, 0);
+    }
+
     if (vs->discontinuity) {
         en->discont = 1;
         vs->discontinuity = 0;
@@ -1115,7 +1199,7 @@ static int hls_append_segment(struct AVFormatContext *s, HLSContext *hls,
             if ((ret = hls_delete_old_segments(s, hls, vs)) < 0)
                 return ret;
         } else
-            av_freep(&en);
+            hls_free_segment(&en);
     } else
         vs->nb_entries++;
 
@@ -1225,7 +1309,7 @@ static void hls_free_segments(HLSSegment *p)
     while (p) {
         en = p;
         p = p->next;
-        av_freep(&en);
+        hls_free_segment(&en);
     }
 }
 
@@ -1295,7 +1379,7 @@ static int create_master_playlist(AVFormatContext *s,
     const char *sgroup = NULL;
     ClosedCaptionsStream *ccs;
     const char *proto = avio_find_protocol_name(hls->master_m3u8_url);
-    int is_file_proto = proto && !strcmp(proto, "file");
+    int is_file_proto = proto && !strcmp(proto, "file") && !hls->origin;
     int use_temp_file = is_file_proto && ((hls->flags & HLS_TEMP_FILE) || hls->master_publish_rate);
     char temp_filename[MAX_URL_SIZE];
 
@@ -1451,12 +1535,14 @@ static int hls_window(AVFormatContext *s, int last, VariantStream *vs)
     HLSContext *hls = s->priv_data;
     HLSSegment *en;
     int target_duration = 0;
-    int ret = 0;
+    int ret = 0, i;
     char temp_filename[MAX_URL_SIZE];
     char temp_vtt_filename[MAX_URL_SIZE];
+    char part[MAX_URL_SIZE];
+    double parts_duration = 0;
     int64_t sequence = FFMAX(hls->start_sequence, vs->sequence - vs->nb_entries);
     const char *proto = avio_find_protocol_name(vs->m3u8_name);
-    int is_file_proto = proto && !strcmp(proto, "file");
+    int is_file_proto = proto && !strcmp(proto, "file") && !hls->origin;
     int use_temp_file = is_file_proto && ((hls->flags & HLS_TEMP_FILE) || !(hls->pl_type == PLAYLIST_TYPE_VOD));
     static unsigned warned_non_file;
     char *key_uri = NULL;
@@ -1507,6 +1593,10 @@ static int hls_window(AVFormatContext *s, int last, VariantStream *vs)
     if (vs->has_video && (hls->flags & HLS_INDEPENDENT_SEGMENTS)) {
         avio_printf(byterange_mode ? hls->m3u8_out : vs->out, "#EXT-X-INDEPENDENT-SEGMENTS\n");
     }
+    if (hls->part_time > 0)
+        ff_hls_write_part_info(vs->out, hls->part_time, !!hls->origin);
+    for (en = vs->segments; en; en = en->next)
+        parts_duration += en->duration;
     for (en = vs->segments; en; en = en->next) {
         if ((hls->encrypt || hls->key_info_file) && (!key_uri || strcmp(en->key_uri, key_uri) ||
                                     av_strcasecmp(en->iv_string, iv_string))) {
@@ -1523,6 +1613,16 @@ static int hls_window(AVFormatContext *s, int last, VariantStream *vs)
                                    hls->flags & HLS_SINGLE_FILE, vs->init_range_length, 0);
         }
 
+        /* partial segments are only listed near the live edge */
+        if (!last && parts_duration <= 3 * target_duration) {
+            for (i = 0; i < en->nb_parts; i++) {
+                hls_part_filename(part, sizeof(part), en->filename, i);
+                ff_hls_write_part(vs->out, en->parts[i].duration, hls->baseurl,
+                                  part, en->parts[i].independent);
+            }
+        }
+        parts_duration -= en->duration;
+
         ret = ff_hls_write_file_entry(byterange_mode ? hls->m3u8_out : vs->out, en->discont, byterange_mode,
                                       en->duration, hls->flags & HLS_ROUND_DURATIONS,
                                       en->size, en->pos, hls->baseurl,
@@ -1532,6 +1632,19 @@ static int hls_window(AVFormatContext *s, int last, VariantStream *vs)
         }
     }
 
+    if (!last && vs->part_hint) {
+        char segment[MAX_URL_SIZE];
+
+        hls_current_segment_name(hls, vs, segment, sizeof(segment));
+        for (i = 0; i < vs->nb_parts; i++) {
+            hls_part_filename(part, sizeof(part), hls_playlist_name(hls, segment), i);
+            ff_hls_write_part(vs->out, vs->parts[i].duration, hls->baseurl,
+                              part, vs->parts[i].independent);
+        }
+        hls_part_filename(part, sizeof(part), hls_playlist_name(hls, segment), vs->nb_parts);
+        ff_hls_write_preload_hint(vs->out, hls->baseurl, part);
+    }
+
     if (last && (hls->flags & HLS_OMIT_ENDLIST)==0)
         ff_hls_write_end_list(byterange_mode ? hls->m3u8_out : vs->out);
 
@@ -1771,6 +1884,9 @@ static int hls_start(AVFormatContext *s, VariantStream *vs)
             return err;
     }
 
+    vs->part_start_pos = 0;
+    vs->part_hint      = c->part_time > 0;
+
     return 0;
 fail:
     av_dict_free(&options);
@@ -2315,6 +2431,86 @@ static int64_t append_single_file(AVFormatContext *s, VariantStream *vs)
 
     return ret;
 }
+static int hls_write_init_segment(AVFormatContext *s, VariantStream *vs)
+{
+    HLSContext *hls = s->priv_data;
+    AVFormatContext *oc = vs->avf;
+    int byterange_mode = (hls->flags & HLS_SINGLE_FILE) || (hls->max_seg_size > 0);
+    int range_length;
+
+    range_length = avio_close_dyn_buf(oc->pb, &vs->init_buffer);
+    if (range_length <= 0)
+        return AVERROR(EINVAL);
+    avio_write(vs->out, vs->init_buffer, range_length);
+    if (!hls->resend_init_file)
+        av_freep(&vs->init_buffer);
+    vs->init_range_length = range_length;
+    avio_open_dyn_buf(&oc->pb);
+    vs->packets_written = 0;
+    vs->start_pos = range_length;
+    vs->part_start_pos = 0;
+    if (!byterange_mode) {
+        hlsenc_io_close(s, &vs->out, vs->base_output_dirname);
+    }
+    return 0;
+}
+
+/**
+ * Cut the fragments muxed since the previous part into a new partial
+ * segment file. The segment buffer is left untouched so that the whole
+ * segment can still be written when it ends.
+ */
+static int hls_flush_part(AVFormatContext *s, VariantStream *vs, double duration)
+{
+    HLSContext *hls = s->priv_data;
+    AVFormatContext *oc = vs->avf;
+    AVDictionary *options = NULL;
+    AVIOContext *pb = NULL;
+    char segment[MAX_URL_SIZE], filename[MAX_URL_SIZE];
+    HLSPart *parts;
+    uint8_t *buf;
+    int size, ret;
+
+    av_write_frame(oc, NULL); /* Flush the pending fragment */
+    if (!vs->init_range_length) {
+        /* with delay_moov the first flush only writes the moov */
+        if ((ret = hls_write_init_segment(s, vs)) < 0)
+            return ret;
+        av_write_frame(oc, NULL);
+    }
+
+    size = avio_get_dyn_buf(oc->pb, &buf);
+    if (size <= vs->part_start_pos)
+        return 0;
+
+    parts = av_realloc_array(vs->parts, vs->nb_parts + 1, sizeof(*vs->parts));
+    if (!parts)
+        return AVERROR(ENOMEM);
+    vs->parts = parts;
+
+    hls_current_segment_name(hls, vs, segment, sizeof(segment));
+    hls_part_filename(filename, sizeof(filename), segment, vs->nb_parts);
+    set_http_options(s, &options, hls);
+    ret = hlsenc_io_open(s, &pb, filename, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        av_log(s, hls->ignore_io_errors ? AV_LOG_WARNING : AV_LOG_ERROR,
+               "Failed to open file '%s'\n", filename);
+        vs->part_start_pos = size;
+        return hls->ignore_io_errors ? 0 : ret;
+    }
+    avio_write(pb, buf + vs->part_start_pos, size - vs->part_start_pos);
+    ret = hlsenc_io_close(s, &pb, filename);
+    ff_format_io_close(s, &pb);
+
+    vs->parts[vs->nb_parts].duration    = duration;
+    vs->parts[vs->nb_parts].independent = vs->part_independent;
+    vs->nb_parts++;
+    vs->part_start_pos = size;
+
+    return hls->ignore_io_errors ? 0 : ret;
+}
+
 static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
 {
     HLSContext *hls = s->priv_data;
@@ -2412,19 +2608,15 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
         avio_flush(oc->pb);
         if (hls->segment_type == SEGMENT_TYPE_FMP4) {
             if (!vs->init_range_length) {
-                range_length = avio_close_dyn_buf(oc->pb, &vs->init_buffer);
-                if (range_length <= 0)
-                    return AVERROR(EINVAL);
-                avio_write(vs->out, vs->init_buffer, range_length);
-                if (!hls->resend_init_file)
-                    av_freep(&vs->init_buffer);
-                vs->init_range_length = range_length;
-                avio_open_dyn_buf(&oc->pb);
-                vs->packets_written = 0;
-                vs->start_pos = range_length;
-                if (!byterange_mode) {
-                    hlsenc_io_close(s, &vs->out, vs->base_output_dirname);
-                }
+                ret = hls_write_init_segment(s, vs);
+                if (ret < 0)
+                    return ret;
+            }
+            if (hls->part_time > 0) {
+                /* the duration of the last part is set with the segment's */
+                ret = hls_flush_part(s, vs, 0);
+                if (ret < 0)
+                    return ret;
             }
         }
         if (!byterange_mode) {
@@ -2491,7 +2683,7 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
                 if (ret < 0) {
                     av_log(s, AV_LOG_WARNING, "upload segment failed,"
                            " will retry with a new http session.\n");
-                    ff_format_io_close(s, &vs->out);
+                    hlsenc_io_close(s, &vs->out, NULL);
                     ret = hlsenc_io_open(s, &vs->out, filename, &options);
                     reflush_dynbuf(vs, &range_length);
                     ret = hlsenc_io_close(s, &vs->out, filename);
@@ -2525,7 +2717,7 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
         if (hls->pl_type != PLAYLIST_TYPE_VOD) {
             if ((ret = hls_window(s, 0, vs)) < 0) {
                 av_log(s, AV_LOG_WARNING, "upload playlist failed, will retry with a new http session.\n");
-                ff_format_io_close(s, &vs->out);
+                hlsenc_io_close(s, &vs->out, NULL);
                 if ((ret = hls_window(s, 0, vs)) < 0) {
                     av_freep(&old_filename);
                     return ret;
@@ -2560,7 +2752,12 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
             vs->start_pos = new_start_pos;
             sls_flag_file_rename(hls, vs, old_filename);
             ret = hls_start(s, vs);
+            /* announce the first part of the new segment */
+            if (ret >= 0 && hls->part_time > 0 && hls->pl_type != PLAYLIST_TYPE_VOD)
+                ret = hls_window(s, 0, vs);
         }
+        vs->part_start_pts   = pkt->pts;
+        vs->part_independent = !vs->has_video || (pkt->flags & AV_PKT_FLAG_KEY);
         vs->number++;
         av_freep(&old_filename);
 
@@ -2570,6 +2767,23 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
 
     }
 
+    if (hls->part_time > 0 && is_ref_pkt && oc == vs->avf) {
+        if (vs->part_start_pts == AV_NOPTS_VALUE) {
+            vs->part_start_pts   = pkt->pts;
+            vs->part_independent = 1;
+        } else if (vs->packets_written && pkt->pts > vs->part_start_pts &&
+                   av_compare_ts(pkt->pts + pkt->duration - vs->part_start_pts, st->time_base,
+                                 hls->part_time * AV_TIME_BASE, AV_TIME_BASE_Q) > 0) {
+            ret = hls_flush_part(s, vs, (pkt->pts - vs->part_start_pts) * av_q2d(st->time_base));
+            if (ret < 0)
+                return ret;
+            vs->part_start_pts   = pkt->pts;
+            vs->part_independent = !vs->has_video || (pkt->flags & AV_PKT_FLAG_KEY);
+            if (hls->pl_type != PLAYLIST_TYPE_VOD && (ret = hls_window(s, 0, vs)) < 0)
+                return ret;
+        }
+    }
+
     vs->packets_written++;
     if (oc->pb) {
         ret = ff_write_chained(oc, stream_index, pkt, s, 0);
@@ -2607,12 +2821,14 @@ static void hls_deinit(AVFormatContext *s)
             av_freep(&vs->init_buffer);
         hls_free_segments(vs->segments);
         hls_free_segments(vs->old_segments);
+        av_freep(&vs->parts);
         av_freep(&vs->m3u8_name);
         av_freep(&vs->streams);
     }
 
-    ff_format_io_close(s, &hls->m3u8_out);
-    ff_format_io_close(s, &hls->sub_m3u8_out);
+    hlsenc_io_close(s, &hls->m3u8_out, NULL);
+    hlsenc_io_close(s, &hls->sub_m3u8_out, NULL);
+    ff_live_origin_close(&hls->origin);
     av_freep(&hls->key_basename);
     av_freep(&hls->var_streams);
     av_freep(&hls->cc_streams);
@@ -2671,10 +2887,14 @@ static int hls_write_trailer(struct AVFormatContext *s)
                 vs->start_pos = range_length;
                 byterange_mode = (hls->flags & HLS_SINGLE_FILE) || (hls->max_seg_size > 0);
                 if (!byterange_mode) {
-                    ff_format_io_close(s, &vs->out);
                     hlsenc_io_close(s, &vs->out, vs->base_output_dirname);
                 }
             }
+            if (hls->part_time > 0) {
+                ret = hls_flush_part(s, vs, 0);
+                if (ret < 0)
+                    goto failed;
+            }
         }
         if (!(hls->flags & HLS_SINGLE_FILE)) {
             set_http_options(s, &options, hls);
@@ -2694,7 +2914,7 @@ static int hls_write_trailer(struct AVFormatContext *s)
         ret = hlsenc_io_close(s, &vs->out, filename);
         if (ret < 0) {
             av_log(s, AV_LOG_WARNING, "upload segment failed, will retry with a new http session.\n");
-            ff_format_io_close(s, &vs->out);
+            hlsenc_io_close(s, &vs->out, NULL);
             ret = hlsenc_io_open(s, &vs->out, filename, &options);
             if (ret < 0) {
                 av_log(s, AV_LOG_ERROR, "Failed to open file '%s'\n", oc->url);
@@ -2741,12 +2961,12 @@ failed:
             if (vtt_oc->pb)
                 av_write_trailer(vtt_oc);
             vs->size = avio_tell(vs->vtt_avf->pb) - vs->start_pos;
-            ff_format_io_close(s, &vtt_oc->pb);
+            hlsenc_io_close(s, &vtt_oc->pb, NULL);
         }
         ret = hls_window(s, 1, vs);
         if (ret < 0) {
             av_log(s, AV_LOG_WARNING, "upload playlist failed, will retry with a new http session.\n");
-            ff_format_io_close(s, &vs->out);
+            hlsenc_io_close(s, &vs->out, NULL);
             hls_window(s, 1, vs);
         }
         ffio_free_dyn_buf(&oc->pb);
@@ -2797,6 +3017,40 @@ static int hls_init(AVFormatContext *s)
     if (ret < 0)
         return ret;
 
+    if (hls->part_time > 0) {
+        if (hls->segment_type != SEGMENT_TYPE_FMP4 ||
+            (hls->flags & HLS_SINGLE_FILE) || hls->max_seg_size > 0 ||
+            hls->key_info_file || hls->encrypt) {
+            av_log(s, AV_LOG_ERROR, "Partial segments require unencrypted fmp4 "
+                   "segments in separate files\n");
+            return AVERROR(EINVAL);
+        }
+        if (hls->part_time > hls->time) {
+            av_log(s, AV_LOG_ERROR, "hls_part_time must not exceed hls_time\n");
+            return AVERROR(EINVAL);
+        }
+    }
+
+    if (hls->origin_listen) {
+        if ((hls->flags & HLS_SINGLE_FILE) || hls->max_seg_size > 0) {
+            av_log(s, AV_LOG_ERROR, "Byte range playlists cannot be served by the built-in origin\n");
+            return AVERROR(EINVAL);
+        }
+        if (hls->key_info_file || hls->encrypt || hls->resend_init_file ||
+            (hls->flags & (HLS_SECOND_LEVEL_SEGMENT_SIZE | HLS_SECOND_LEVEL_SEGMENT_DURATION))) {
+            av_log(s, AV_LOG_ERROR, "Encryption, resend_init_file and second_level_segment "
+                   "flags are not supported with origin_listen\n");
+            return AVERROR(EINVAL);
+        }
+        /* files are replaced atomically in the origin, and a segment must
+         * be reachable under its final name while it is being written */
+        hls->flags &= ~HLS_TEMP_FILE;
+        ret = ff_live_origin_open(&hls->origin, hls->origin_listen, hls->origin_max_files,
+                                  hls->origin_wait, s);
+        if (ret < 0)
+            return ret;
+    }
+
     if (hls->segment_filename) {
         ret = validate_name(hls->nb_varstreams, hls->segment_filename);
         if (ret < 0)
@@ -2864,6 +3118,7 @@ static int hls_init(AVFormatContext *s)
         vs->sequence  = hls->start_sequence;
         vs->start_pts = AV_NOPTS_VALUE;
         vs->end_pts   = AV_NOPTS_VALUE;
+        vs->part_start_pts = AV_NOPTS_VALUE;
         vs->current_segment_final_filename_fmt[0] = '\0';
         vs->initial_prog_date_time = initial_program_date_time;
 
@@ -3001,6 +3256,7 @@ static int hls_init(AVFormatContext *s)
 static const AVOption options[] = {
     {"start_number",  "set first number in the sequence",        OFFSET(start_sequence),AV_OPT_TYPE_INT64,  {.i64 = 0},     0, INT64_MAX, E},
     {"hls_time",      "set segment length in seconds",           OFFSET(time),    AV_OPT_TYPE_FLOAT,  {.dbl = 2},     0, FLT_MAX, E},
+    {"hls_part_time", "set partial segment length in seconds, enables low latency HLS", OFFSET(part_time), AV_OPT_TYPE_FLOAT, {.dbl = 0}, 0, FLT_MAX, E},
     {"hls_init_time", "set segment length in seconds at init list",           OFFSET(init_time),    AV_OPT_TYPE_FLOAT,  {.dbl = 0},     0, FLT_MAX, E},
     {"hls_list_size", "set maximum number of playlist entries",  OFFSET(max_nb_segments),    AV_OPT_TYPE_INT,    {.i64 = 5},     0, INT_MAX, E},
     {"hls_delete_threshold", "set number of unreferenced segments to keep before deleting",  OFFSET(hls_delete_threshold),    AV_OPT_TYPE_INT,    {.i64 = 1},     1, INT_MAX, E},
@@ -3066,6 +3322,9 @@ static const AVOption options[] = {
     {"timeout", "set timeout for socket I/O operations", OFFSET(timeout), AV_OPT_TYPE_DURATION, { .i64 = -1 }, -1, INT_MAX, .flags = E },
     {"ignore_io_errors", "Ignore IO errors for stable long-duration runs with network output", OFFSET(ignore_io_errors), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, E },
     {"headers", "set custom HTTP headers, can override built in default headers", OFFSET(headers), AV_OPT_TYPE_STRING, { .str = NULL }, 0, 0, E },
+    {"origin_listen", "serve the output from memory with a built-in HTTP server listening on [host]:port", OFFSET(origin_listen), AV_OPT_TYPE_STRING, { .str = NULL }, 0, 0, E },
+    {"origin_max_files", "maximum number of segments kept in memory by the built-in HTTP server", OFFSET(origin_max_files), AV_OPT_TYPE_INT, { .i64 = 16 }, 1, INT_MAX, E },
+    {"origin_wait", "how long (in milliseconds) a request for a file not created yet is held", OFFSET(origin_wait), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, INT_MAX, E },
     { NULL },
 };
 
@@ -0,0 +1,710 @@
+/*
+ * In-memory segment store with a built-in HTTP origin server
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "libavutil/avstring.h"
+#include "libavutil/mem.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/thread.h"
+#include "libavutil/time.h"
+#include "avformat.h"
+#include "internal.h"
+#include "liveorigin.h"
+#include "url.h"
+
+#if HAVE_THREADS
+
+#define IO_BUFFER_SIZE  4096
+#define REQUEST_MAX     4096
+#define CHUNK_MAX       65536
+
+typedef struct OriginFile {
+    char *name;
+    uint8_t *data;
+    size_t size;
+    unsigned int allocated;
+    int complete;
+    int refcount;           ///< the store, the writer and each reader
+} OriginFile;
+
+typedef struct OriginWriter {
+    LiveOrigin *origin;
+    OriginFile *file;
+} OriginWriter;
+
+typedef struct OriginClient {
+    LiveOrigin *origin;
+    URLContext *uc;
+    pthread_t thread;
+    int finished;           ///< the thread is done and can be joined
+} OriginClient;
+
+struct LiveOrigin {
+    void *log_ctx;
+    int max_files;
+    int wait_ms;
+
+    URLContext *listen;
+    AVIOInterruptCB interrupt_callback;
+    atomic_int abort;
+    pthread_t accept_thread;
+    int accept_thread_started;
+    OriginClient **clients; ///< client threads, owned by the accept thread
+    int nb_clients;
+
+    /** protects all the fields below and the contents of the files */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    OriginFile **files;     ///< published files, oldest first
+    int nb_files;
+};
+
+static const char *normalize_name(const char *name)
+{
+    while (1) {
+        if (*name == '/')
+            name++;
+        else if (name[0] == '.' && name[1] == '/')
+            name += 2;
+        else
+            return name;
+    }
+}
+
+static int is_manifest(const char *name)
+{
+    return av_match_ext(name, "m3u8,mpd");
+}
+
+static const char *content_type(const char *name)
+{
+    if (av_match_ext(name, "m3u8"))
+        return "application/vnd.apple.mpegurl";
+    if (av_match_ext(name, "mpd"))
+        return "application/dash+xml";
+    if (av_match_ext(name, "ts"))
+        return "video/mp2t";
+    if (av_match_ext(name, "mp4,m4s,m4v,m4a,cmfv,cmfa"))
+        return "video/mp4";
+    if (av_match_ext(name, "webm,chk"))
+        return "video/webm";
+    if (av_match_ext(name, "vtt"))
+        return "text/vtt";
+    return "application/octet-stream";
+}
+
+/* must be called with the lock held */
+static void file_unref(OriginFile *f)
+{
+    if (--f->refcount)
+        return;
+    av_freep(&f->name);
+    av_freep(&f->data);
+    av_free(f);
+}
+
+/* must be called with the lock held */
+static int find_file(LiveOrigin *o, const char *name)
+{
+    int i;
+
+    for (i = o->nb_files - 1; i >= 0; i--)
+        if (!strcmp(o->files[i]->name, name))
+            return i;
+    return -1;
+}
+
+/* must be called with the lock held */
+static void unpublish_file(LiveOrigin *o, int idx)
+{
+    file_unref(o->files[idx]);
+    memmove(o->files + idx, o->files + idx + 1,
+            (o->nb_files - idx - 1) * sizeof(*o->files));
+    o->nb_files--;
+}
+
+/**
+ * Wait for the store to change or for deadline, in av_gettime() time, to pass.
+ * Must be called with the lock held.
+ *
+ * @return 1 once the deadline has passed, 0 otherwise
+ */
+static int wait_change(LiveOrigin *o, int64_t deadline)
+{
+    struct timespec ts = { .tv_sec  =  deadline / 1000000,
+                           .tv_nsec = (deadline % 1000000) * 1000 };
+
+    return pthread_cond_timedwait(&o->cond, &o->lock, &ts) == ETIMEDOUT;
+}
+
+/* must be called with the lock held */
+static void trim_files(LiveOrigin *o)
+{
+    int i, nb_media = 0;
+
+    for (i = 0; i < o->nb_files; i++)
+        nb_media += !is_manifest(o->files[i]->name);
+
+    for (i = 0; i < o->nb_files && nb_media > o->max_files; ) {
+        OriginFile *f = o->files[i];
+        if (!is_manifest(f->name) && f->complete) {
+            unpublish_file(o, i);
+            nb_media--;
+        } else {
+            i++;
+        }
+    }
+}
+
+static int origin_write_packet(void *opaque, uint8_t *buf, int size)
+{
+    OriginWriter *w = opaque;
+    LiveOrigin *o = w->origin;
+    OriginFile *f = w->file;
+    uint8_t *data;
+
+    pthread_mutex_lock(&o->lock);
+    if (f->size + size > INT_MAX ||
+        !(data = av_fast_realloc(f->data, &f->allocated, f->size + size))) {
+        pthread_mutex_unlock(&o->lock);
+        return AVERROR(ENOMEM);
+    }
+    f->data = data;
+    memcpy(f->data + f->size, buf, size);
+    f->size += size;
+    pthread_cond_broadcast(&o->cond);
+    pthread_mutex_unlock(&o->lock);
+
+    return size;
+}
+
+int ff_live_origin_io_open(LiveOrigin *o, AVIOContext **pb, const char *name)
+{
+    OriginWriter *w = NULL;
+    OriginFile *f;
+    uint8_t *buffer = NULL;
+    int idx, ret;
+
+    if (!(f = av_mallocz(sizeof(*f))) ||
+        !(f->name = av_strdup(normalize_name(name))) ||
+        !(w = av_mallocz(sizeof(*w))) ||
+        !(buffer = av_malloc(IO_BUFFER_SIZE)))
+        goto fail;
+    f->refcount = 2;
+    w->origin   = o;
+    w->file     = f;
+
+    *pb = avio_alloc_context(buffer, IO_BUFFER_SIZE, 1, w, NULL, origin_write_packet, NULL);
+    if (!*pb)
+        goto fail;
+    (*pb)->seekable = 0;
+
+    pthread_mutex_lock(&o->lock);
+    if ((idx = find_file(o, f->name)) >= 0)
+        unpublish_file(o, idx);
+    ret = av_dynarray_add_nofree(&o->files, &o->nb_files, f);
+    if (ret < 0) {
+        pthread_mutex_unlock(&o->lock);
+        avio_context_free(pb);
+        goto fail;
+    }
+    trim_files(o);
+    pthread_cond_broadcast(&o->cond);
+    pthread_mutex_unlock(&o->lock);
+
+    return 0;
+fail:
+    if (f)
+        av_free(f->name);
+    av_free(f);
+    av_free(w);
+    av_free(buffer);
+    return AVERROR(ENOMEM);
+}
+
+void ff_live_origin_io_close(LiveOrigin *o, AVIOContext **pb)
+{
+    OriginWriter *w;
+
+    if (!*pb)
+        return;
+    avio_flush(*pb);
+    w = (*pb)->opaque;
+
+    pthread_mutex_lock(&o->lock);
+    w->file->complete = 1;
+    file_unref(w->file);
+    pthread_cond_broadcast(&o->cond);
+    pthread_mutex_unlock(&o->lock);
+
+    av_freep(&(*pb)->buffer);
+    av_free(w);
+    avio_context_free(pb);
+}
+
+int ff_live_origin_delete(LiveOrigin *o, const char *name)
+{
+    int idx;
+
+    pthread_mutex_lock(&o->lock);
+    idx = find_file(o, normalize_name(name));
+    if (idx >= 0)
+        unpublish_file(o, idx);
+    pthread_mutex_unlock(&o->lock);
+
+    return idx < 0 ? AVERROR(ENOENT) : 0;
+}
+
+static int send_status(URLContext *uc, int code, const char *reason)
+{
+    char buf[256];
+    int len = snprintf(buf, sizeof(buf),
+                       "HTTP/1.1 %d %s\r\n"
+                       "Content-Length: 0\r\n"
+                       "Connection: close\r\n"
+                       "\r\n", code, reason);
+    return ffurl_write(uc, buf, len);
+}
+
+static int send_file(LiveOrigin *o, URLContext *uc, OriginFile *f, int head)
+{
+    uint8_t *chunk = NULL;
+    char buf[256];
+    size_t pos = 0;
+    int len, ret, complete;
+
+    pthread_mutex_lock(&o->lock);
+    complete = f->complete;
+    pthread_mutex_unlock(&o->lock);
+
+    /* the data of a complete file does not change anymore */
+    if (complete) {
+        len = snprintf(buf, sizeof(buf),
+                       "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: %s\r\n"
+                       "Content-Length: %"SIZE_SPECIFIER"\r\n"
+                       "Cache-Control: no-cache\r\n"
+                       "Connection: close\r\n"
+                       "\r\n", content_type(f->name), f->size);
+        if ((ret = ffurl_write(uc, buf, len)) < 0 || head || !f->size)
+            return ret;
+        return ffurl_write(uc, f->data, f->size);
+    }
+
+    len = snprintf(buf, sizeof(buf),
+                   "HTTP/1.1 200 OK\r\n"
+                   "Content-Type: %s\r\n"
+                   "Transfer-Encoding: chunked\r\n"
+                   "Cache-Control: no-cache\r\n"
+                   "Connection: close\r\n"
+                   "\r\n", content_type(f->name));
+    if ((ret = ffurl_write(uc, buf, len)) < 0 || head)
+        return ret;
+
+    if (!(chunk = av_malloc(CHUNK_MAX)))
+        return AVERROR(ENOMEM);
+
+    while (1) {
+        size_t size;
+
+        pthread_mutex_lock(&o->lock);
+        while (f->size == pos && !f->complete && !atomic_load(&o->abort))
+            pthread_cond_wait(&o->cond, &o->lock);
+        if (atomic_load(&o->abort)) {
+            pthread_mutex_unlock(&o->lock);
+            ret = AVERROR_EXIT;
+            break;
+        }
+        size = FFMIN(f->size - pos, CHUNK_MAX);
+        memcpy(chunk, f->data + pos, size);
+        pos += size;
+        complete = f->complete && pos == f->size;
+        pthread_mutex_unlock(&o->lock);
+
+        if (size) {
+            len = snprintf(buf, sizeof(buf), "%x\r\n", (unsigned)size);
+            if ((ret = ffurl_write(uc, buf, len))   < 0 ||
+                (ret = ffurl_write(uc, chunk, size)) < 0 ||
+                (ret = ffurl_write(uc, "\r\n", 2))  < 0)
+                break;
+        }
+        if (complete) {
+            ret = ffurl_write(uc, "0\r\n\r\n", 5);
+            break;
+        }
+    }
+
+    av_free(chunk);
+    return ret;
+}
+
+/**
+ * Check whether a media playlist contains the segment msn, or its partial
+ * segment part if part >= 0, as requested by a blocking playlist reload.
+ *
+ * @return 1 if it does, 0 if not yet, AVERROR(EINVAL) if the request is
+ *         too far ahead of the playlist
+ */
+static int playlist_ready(const OriginFile *f, int64_t msn, int part, int *target)
+{
+    const char *p = f->data, *end = p + f->size;
+    int64_t seq = 0, nb_segments = 0, last;
+    int nb_parts = 0;
+
+    while (p < end) {
+        const char *eol = memchr(p, '\n', end - p);
+        char line[128], *val;
+        size_t len = eol ? eol - p : end - p;
+
+        av_strlcpy(line, p, FFMIN(len + 1, sizeof(line)));
+        p += len + 1;
+
+        if (av_strstart(line, "#EXT-X-MEDIA-SEQUENCE:", (const char **)&val)) {
+            seq = strtoll(val, NULL, 10);
+        } else if (av_strstart(line, "#EXT-X-TARGETDURATION:", (const char **)&val)) {
+            *target = atoi(val);
+        } else if (av_strstart(line, "#EXTINF:", NULL)) {
+            nb_segments++;
+            nb_parts = 0;
+        } else if (av_strstart(line, "#EXT-X-PART:", NULL)) {
+            nb_parts++;
+        } else if (av_strstart(line, "#EXT-X-ENDLIST", NULL)) {
+            return 1;
+        }
+    }
+
+    last = seq + nb_segments - 1;
+    if (msn > last + 2)
+        return AVERROR(EINVAL);
+    if (msn <= last)
+        return 1;
+    return msn == last + 1 && part >= 0 && part < nb_parts;
+}
+
+/**
+ * Wait until the playlist name is complete and satisfies a blocking reload
+ * request, and return a new reference to it.
+ */
+static int wait_playlist(LiveOrigin *o, const char *name, int64_t msn, int part,
+                         OriginFile **file)
+{
+    int64_t start = av_gettime();
+    int64_t deadline = start + FFMAX(o->wait_ms * 1000LL, 10000000);
+    int ready = 0, target = 0, idx;
+
+    pthread_mutex_lock(&o->lock);
+    while (!atomic_load(&o->abort)) {
+        if ((idx = find_file(o, name)) >= 0 && o->files[idx]->complete) {
+            ready = playlist_ready(o->files[idx], msn, part, &target);
+            if (ready) {
+                if (ready > 0) {
+                    *file = o->files[idx];
+                    (*file)->refcount++;
+                }
+                break;
+            }
+            /* the request is answered within three target durations */
+            if (target > 0)
+                deadline = start + 3 * target * 1000000LL;
+        }
+        if (wait_change(o, deadline))
+            break;
+    }
+    pthread_mutex_unlock(&o->lock);
+
+    return ready;
+}
+
+static int handle_request(LiveOrigin *o, URLContext *uc)
+{
+    char request[REQUEST_MAX];
+    char *method, *path, *query = NULL, *saveptr = NULL;
+    char arg[32];
+    OriginFile *f = NULL;
+    int64_t deadline, msn = -1;
+    int len = 0, ret, idx, head, part = -1;
+
+    while (1) {
+        ret = ffurl_read(uc, request + len, sizeof(request) - 1 - len);
+        if (ret <= 0)
+            return ret ? ret : AVERROR_EOF;
+        len += ret;
+        request[len] = 0;
+        if (strstr(request, "\r\n\r\n"))
+            break;
+        if (len == sizeof(request) - 1)
+            return send_status(uc, 431, "Request Header Fields Too Large");
+    }
+
+    method = av_strtok(request, " ", &saveptr);
+    path   = av_strtok(NULL,    " ", &saveptr);
+    if (!method || !path)
+        return send_status(uc, 400, "Bad Request");
+    head = !strcmp(method, "HEAD");
+    if (!head && strcmp(method, "GET"))
+        return send_status(uc, 405, "Method Not Allowed");
+    if ((query = strchr(path, '?')))
+        *query++ = 0;
+    path = (char *)normalize_name(path);
+
+    av_log(o->log_ctx, AV_LOG_DEBUG, "origin: %s /%s\n", method, path);
+
+    if (query && av_match_ext(path, "m3u8")) {
+        if (av_find_info_tag(arg, sizeof(arg), "_HLS_msn", query))
+            msn = strtoll(arg, NULL, 10);
+        if (av_find_info_tag(arg, sizeof(arg), "_HLS_part", query))
+            part = strtol(arg, NULL, 10);
+    }
+
+    if (msn >= 0) {
+        ret = wait_playlist(o, path, msn, part, &f);
+        if (ret < 0)
+            return send_status(uc, 400, "Bad Request");
+        if (!ret)
+            return send_status(uc, 503, "Service Unavailable");
+        goto send;
+    }
+
+    deadline = av_gettime() + o->wait_ms * 1000LL;
+    pthread_mutex_lock(&o->lock);
+    /* the file may be announced before it is created, e.g. as a
+     * preload hint, wait a bit for the muxer to open it */
+    while ((idx = find_file(o, path)) < 0 && !atomic_load(&o->abort))
+        if (wait_change(o, deadline))
+            break;
+    if (idx >= 0) {
+        f = o->files[idx];
+        f->refcount++;
+    }
+    pthread_mutex_unlock(&o->lock);
+
+    if (!f)
+        return send_status(uc, 404, "Not Found");
+
+send:
+    ret = send_file(o, uc, f, head);
+
+    pthread_mutex_lock(&o->lock);
+    file_unref(f);
+    pthread_mutex_unlock(&o->lock);
+
+    return ret;
+}
+
+static void *client_thread(void *arg)
+{
+    OriginClient *client = arg;
+    LiveOrigin *o = client->origin;
+
+    handle_request(o, client->uc);
+    ffurl_closep(&client->uc);
+
+    pthread_mutex_lock(&o->lock);
+    client->finished = 1;
+    pthread_mutex_unlock(&o->lock);
+
+    return NULL;
+}
+
+/**
+ * Join the client threads, only the finished ones unless all is set.
+ */
+static void join_clients(LiveOrigin *o, int all)
+{
+    int i;
+
+    for (i = 0; i < o->nb_clients; i++) {
+        OriginClient *client = o->clients[i];
+
+        if (!all) {
+            int finished;
+            pthread_mutex_lock(&o->lock);
+            finished = client->finished;
+            pthread_mutex_unlock(&o->lock);
+            if (!finished)
+                continue;
+        }
+        pthread_join(client->thread, NULL);
+        av_free(client);
+        o->clients[i--] = o->clients[--o->nb_clients];
+    }
+}
+
+static void *accept_thread(void *arg)
+{
+    LiveOrigin *o = arg;
+
+    while (!atomic_load(&o->abort)) {
+        OriginClient *client;
+        URLContext *uc = NULL;
+        int ret;
+
+        ret = ffurl_accept(o->listen, &uc);
+        if (ret < 0) {
+            if (!atomic_load(&o->abort)) {
+                int64_t deadline = av_gettime() + 100000;
+                av_log(o->log_ctx, AV_LOG_WARNING, "origin: accept failed: %s\n",
+                       av_err2str(ret));
+                pthread_mutex_lock(&o->lock);
+                while (!atomic_load(&o->abort))
+                    if (wait_change(o, deadline))
+                        break;
+                pthread_mutex_unlock(&o->lock);
+            }
+            continue;
+        }
+        join_clients(o, 0);
+
+        if (!(client = av_mallocz(sizeof(*client)))) {
+            ffurl_closep(&uc);
+            continue;
+        }
+        client->origin = o;
+        client->uc     = uc;
+
+        if (av_dynarray_add_nofree(&o->clients, &o->nb_clients, client) < 0) {
+            ffurl_closep(&client->uc);
+            av_free(client);
+            continue;
+        }
+        ret = pthread_create(&client->thread, NULL, client_thread, client);
+        if (ret) {
+            ffurl_closep(&client->uc);
+            av_free(client);
+            o->nb_clients--;
+        }
+    }
+
+    return NULL;
+}
+
+static int origin_interrupt_cb(void *opaque)
+{
+    LiveOrigin *o = opaque;
+    return atomic_load(&o->abort);
+}
+
+int ff_live_origin_open(LiveOrigin **origin, const char *listen, int max_files,
+                        int wait_ms, void *log_ctx)
+{
+    LiveOrigin *o;
+    char url[1024];
+    int ret;
+
+    if (!(o = av_mallocz(sizeof(*o))))
+        return AVERROR(ENOMEM);
+    o->log_ctx   = log_ctx;
+    o->max_files = max_files;
+    o->wait_ms   = wait_ms;
+    o->interrupt_callback.callback = origin_interrupt_cb;
+    o->interrupt_callback.opaque   = o;
+    atomic_init(&o->abort, 0);
+
+    if (!av_strstart(listen, "http://", &listen))
+        av_strstart(listen, "tcp://", &listen);
+    snprintf(url, sizeof(url), "tcp://%s?listen=2", listen);
+
+    ret = ffurl_open_whitelist(&o->listen, url, AVIO_FLAG_READ_WRITE,
+                               &o->interrupt_callback, NULL, NULL, NULL, NULL);
+    if (ret < 0) {
+        av_log(log_ctx, AV_LOG_ERROR, "origin: cannot listen on %s: %s\n",
+               listen, av_err2str(ret));
+        av_free(o);
+        return ret;
+    }
+
+    pthread_mutex_init(&o->lock, NULL);
+    pthread_cond_init(&o->cond, NULL);
+
+    ret = pthread_create(&o->accept_thread, NULL, accept_thread, o);
+    if (ret) {
+        ret = AVERROR(ret);
+        ff_live_origin_close(&o);
+        return ret;
+    }
+    o->accept_thread_started = 1;
+
+    av_log(log_ctx, AV_LOG_INFO, "origin: serving on http://%s/\n", listen);
+    *origin = o;
+    return 0;
+}
+
+void ff_live_origin_close(LiveOrigin **origin)
+{
+    LiveOrigin *o = *origin;
+    int i;
+
+    if (!o)
+        return;
+
+    pthread_mutex_lock(&o->lock);
+    atomic_store(&o->abort, 1);
+    pthread_cond_broadcast(&o->cond);
+    pthread_mutex_unlock(&o->lock);
+    if (o->accept_thread_started)
+        pthread_join(o->accept_thread, NULL);
+    join_clients(o, 1);
+    av_freep(&o->clients);
+
+    pthread_mutex_lock(&o->lock);
+    for (i = 0; i < o->nb_files; i++)
+        file_unref(o->files[i]);
+    av_freep(&o->files);
+    o->nb_files = 0;
+    pthread_mutex_unlock(&o->lock);
+
+    ffurl_closep(&o->listen);
+    pthread_cond_destroy(&o->cond);
+    pthread_mutex_destroy(&o->lock);
+    av_freep(origin);
+}
+
+#else /* HAVE_THREADS */
+
+int ff_live_origin_open(LiveOrigin **origin, const char *listen, int max_files,
+                        int wait_ms, void *log_ctx)
+{
+    av_log(log_ctx, AV_LOG_ERROR, "The live origin requires threading support\n");
+    return AVERROR(ENOSYS);
+}
+
+void ff_live_origin_close(LiveOrigin **origin)
+{
+}
+
+int ff_live_origin_io_open(LiveOrigin *origin, AVIOContext **pb, const char *name)
+{
+    return AVERROR(ENOSYS);
+}
+
+void ff_live_origin_io_close(LiveOrigin *origin, AVIOContext **pb)
+{
+}
+
+int ff_live_origin_delete(LiveOrigin *origin, const char *name)
+{
+    return AVERROR(ENOSYS);
+}
+
+#endif /* HAVE_THREADS */
@@ -0,0 +1,72 @@
+/*
+ * In-memory segment store with a built-in HTTP origin server
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFORMAT_LIVEORIGIN_H
+#define AVFORMAT_LIVEORIGIN_H
+
+#include "avio.h"
+
+/**
+ * A live origin keeps the files written by a segmenting muxer (playlists,
+ * manifests, init and media segments) in memory and serves them over HTTP.
+ *
+ * Files are published as soon as they are opened: a client requesting a file
+ * that is still being written receives it with chunked transfer encoding as
+ * the data is produced, and a client requesting a file that does not exist
+ * yet is held for a while in case it is about to be created (preload hints).
+ * Each file is reference counted, so replacing or deleting it does not affect
+ * the clients currently reading it.
+ */
+typedef struct LiveOrigin LiveOrigin;
+
+/**
+ * Create an origin and start listening for HTTP clients.
+ *
+ * @param listen    address to listen on, as [host]:port
+ * @param max_files maximum number of media files kept, playlists and
+ *                  manifests are always kept
+ * @param wait_ms   how long a request for a missing file is held
+ * @param log_ctx   context used for logging, must outlive the origin
+ */
+int ff_live_origin_open(LiveOrigin **origin, const char *listen, int max_files,
+                        int wait_ms, void *log_ctx);
+
+/**
+ * Stop the server, disconnect the clients and free all the files.
+ */
+void ff_live_origin_close(LiveOrigin **origin);
+
+/**
+ * Create or replace the file name and open it for writing.
+ * The returned context must be closed with ff_live_origin_io_close().
+ */
+int ff_live_origin_io_open(LiveOrigin *origin, AVIOContext **pb, const char *name);
+
+/**
+ * Complete a file opened with ff_live_origin_io_open() and free *pb.
+ */
+void ff_live_origin_io_close(LiveOrigin *origin, AVIOContext **pb);
+
+/**
+ * Remove a file, clients currently reading it are not affected.
+ */
+int ff_live_origin_delete(LiveOrigin *origin, const char *name);
+
+#endif /* AVFORMAT_LIVEORIGIN_H */
@@ -3758,6 +3758,52 @@ static void mov_fix_index(MOVContext *mov, AVStream *st)
     msc->current_index = msc->index_ranges[0].start;
 }
 
+/**
+ * Set the start offsets of a track from its edit list, before its index is
+ * built.
+ */
+static void mov_set_edit_list_start(MOVContext *mov, AVStream *st)
+{
+    MOVStreamContext *sc = st->priv_data;
+    int i, edit_start_index = 0, multiple_edits = 0;
+    int64_t empty_duration = 0; // empty duration of the first edit list entry
+    int64_t start_time = 0; // start time of the media
+
+    if (!sc->elst_count)
+        return;
+
+    for (i = 0; i < sc->elst_count; i++) {
+        const MOVElst *e = &sc->elst_data[i];
+        if (i == 0 && e->time == -1) {
+            /* if empty, the first entry is the start time of the stream
+             * relative to the presentation itself */
+            empty_duration = e->duration;
+            edit_start_index = 1;
+        } else if (i == edit_start_index && e->time >= 0) {
+            start_time = e->time;
+        } else {
+            multiple_edits = 1;
+        }
+    }
+
+    if (multiple_edits && !mov->advanced_editlist)
+        av_log(mov->fc, AV_LOG_WARNING, "multiple edit list entries, "
+               "Use -advanced_editlist to correctly decode otherwise "
+               "a/v desync might occur\n");
+
+    /* adjust first dts according to edit list */
+    if ((empty_duration || start_time) && mov->time_scale > 0) {
+        if (empty_duration)
+            empty_duration = av_rescale(empty_duration, sc->time_scale, mov->time_scale);
+        sc->time_offset = start_time - empty_duration;
+        sc->min_corrected_pts = start_time;
+    }
+
+    if (!multiple_edits && !mov->advanced_editlist &&
+        st->codecpar->codec_id == AV_CODEC_ID_AAC && start_time > 0)
+        sc->start_pad = start_time;
+}
+
 static void mov_build_index(MOVContext *mov, AVStream *st)
 {
     MOVStreamContext *sc = st->priv_data;
@@ -3772,44 +3818,9 @@ static void mov_build_index(MOVContext *mov, AVStream *st)
     MOVStts *ctts_data_old = sc->ctts_data;
     unsigned int ctts_count_old = sc->ctts_count;
 
-    if (sc->elst_count) {
-        int i, edit_start_index = 0, multiple_edits = 0;
-        int64_t empty_duration = 0; // empty duration of the first edit list entry
-        int64_t start_time = 0; // start time of the media
-
-        for (i = 0; i < sc->elst_count; i++) {
-            const MOVElst *e = &sc->elst_data[i];
-            if (i == 0 && e->time == -1) {
-                /* if empty, the first entry is the start time of the stream
-                 * relative to the presentation itself */
-                empty_duration = e->duration;
-                edit_start_index = 1;
-            } else if (i == edit_start_index && e->time >= 0) {
-                start_time = e->time;
-            } else {
-                multiple_edits = 1;
-            }
-        }
-
-        if (multiple_edits && !mov->advanced_editlist)
-            av_log(mov->fc, AV_LOG_WARNING, "multiple edit list entries, "
-                   "Use -advanced_editlist to correctly decode otherwise "
-                   "a/v desync might occur\n");
-
-        /* adjust first dts according to edit list */
-        if ((empty_duration || start_time) && mov->time_scale > 0) {
-            if (empty_duration)
-                empty_duration = av_rescale(empty_duration, sc->time_scale, mov->time_scale);
-            sc->time_offset = start_time - empty_duration;
-            sc->min_corrected_pts = start_time;
-            if (!mov->advanced_editlist)
-                current_dts = -sc->time_offset;
-        }
-
-        if (!multiple_edits && !mov->advanced_editlist &&
-            st->codecpar->codec_id == AV_CODEC_ID_AAC && start_time > 0)
-            sc->start_pad = start_time;
-    }
+    /* start at the offset set by the edit list */
+    if (!mov->advanced_editlist)
+        current_dts = -sc->time_offset;
 
     /* only use old uncompressed audio chunk demuxing when stts specifies it */
     if (!(st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO &&
@@ -4197,6 +4208,62 @@ static void fix_timescale(MOVContext *c, MOVStreamContext *sc)
     }
 }
 
+/* Do not need those anymore once the index is built. */
+static void mov_free_sample_tables(MOVStreamContext *sc)
+{
+    av_freep(&sc->chunk_offsets);
+    av_freep(&sc->sample_sizes);
+    av_freep(&sc->keyframes);
+    av_freep(&sc->stts_data);
+    av_freep(&sc->stps_data);
+    av_freep(&sc->elst_data);
+    av_freep(&sc->rap_group);
+}
+
+/**
+ * Set the bit rate of a track from its sample tables, as mov_build_index()
+ * would, without building its index.
+ */
+static void mov_set_bit_rate(AVStream *st)
+{
+    MOVStreamContext *sc = st->priv_data;
+    uint64_t stream_size = 0;
+    unsigned int i;
+
+    if (st->duration <= 0 ||
+        (st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO &&
+         sc->stts_count == 1 && sc->stts_data[0].duration == 1))
+        return;
+
+    if (sc->stsz_sample_size > 0)
+        stream_size = (uint64_t)sc->stsz_sample_size * sc->sample_count;
+    else if (sc->sample_sizes)
+        for (i = 0; i < sc->sample_count; i++)
+            stream_size += sc->sample_sizes[i];
+    st->codecpar->bit_rate = stream_size*8*sc->time_scale/st->duration;
+}
+
+/**
+ * Expand the sample tables of a track whose index was deferred by the
+ * lazy_index option, on first use of the track.
+ */
+static void mov_build_deferred_index(MOVContext *c, AVStream *st)
+{
+    MOVStreamContext *sc = st->priv_data;
+
+    if (!sc->index_deferred)
+        return;
+    sc->index_deferred = 0;
+    c->nb_deferred_indexes--;
+
+    mov_build_index(c, st);
+    mov_free_sample_tables(sc);
+
+    if (st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO &&
+        st->codecpar->codec_id   == AV_CODEC_ID_AAC)
+        st->skip_samples = sc->start_pad;
+}
+
 static int mov_read_trak(MOVContext *c, AVIOContext *pb, MOVAtom atom)
 {
     AVStream *st;
@@ -4244,7 +4311,14 @@ static int mov_read_trak(MOVContext *c, AVIOContext *pb, MOVAtom atom)
 
     avpriv_set_pts_info(st, 64, 1, sc->time_scale);
 
-    mov_build_index(c, st);
+    mov_set_edit_list_start(c, st);
+    if (c->lazy_index) {
+        sc->index_deferred = 1;
+        c->nb_deferred_indexes++;
+        mov_set_bit_rate(st);
+    } else {
+        mov_build_index(c, st);
+    }
 
     if (sc->dref_id-1 < sc->drefs_count && sc->drefs[sc->dref_id-1].path) {
         MOVDref *dref = &sc->drefs[sc->dref_id - 1];
@@ -4314,14 +4388,8 @@ static int mov_read_trak(MOVContext *c, AVIOContext *pb, MOVAtom atom)
         && sc->time_scale == st->codecpar->sample_rate) {
             st->need_parsing = AVSTREAM_PARSE_FULL;
     }
-    /* Do not need those anymore. */
-    av_freep(&sc->chunk_offsets);
-    av_freep(&sc->sample_sizes);
-    av_freep(&sc->keyframes);
-    av_freep(&sc->stts_data);
-    av_freep(&sc->stps_data);
-    av_freep(&sc->elst_data);
-    av_freep(&sc->rap_group);
+    if (!sc->index_deferred)
+        mov_free_sample_tables(sc);
 
     return 0;
 }
@@ -4769,6 +4837,8 @@ static int mov_read_trun(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     if (sc->pseudo_stream_id+1 != frag->stsd_id && sc->pseudo_stream_id != -1)
         return 0;
 
+    mov_build_deferred_index(c, st);
+
     // Find the next frag_index index that has a valid index_entry for
     // the current track_id.
     //
@@ -7169,6 +7239,7 @@ static void mov_read_chapters(AVFormatContext *s)
 
         sc = st->priv_data;
         cur_pos = avio_tell(sc->pb);
+        mov_build_deferred_index(mov, st);
 
         if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
             st->disposition |= AV_DISPOSITION_ATTACHED_PIC | AV_DISPOSITION_TIMED_THUMBNAILS;
@@ -7265,6 +7336,7 @@ static int mov_read_rtmd_track(AVFormatContext *s, AVStream *st)
     int64_t cur_pos = avio_tell(sc->pb);
     int hh, mm, ss, ff, drop;
 
+    mov_build_deferred_index(s->priv_data, st);
     if (!st->nb_index_entries)
         return -1;
 
@@ -7290,6 +7362,7 @@ static int mov_read_timecode_track(AVFormatContext *s, AVStream *st)
     int64_t cur_pos = avio_tell(sc->pb);
     uint32_t value;
 
+    mov_build_deferred_index(s->priv_data, st);
     if (!st->nb_index_entries)
         return -1;
 
@@ -7863,6 +7936,57 @@ static int get_eia608_packet(AVIOContext *pb, AVPacket *pkt, int size)
     return 0;
 }
 
+static int mov_seek_stream(AVFormatContext *s, AVStream *st, int64_t timestamp, int flags);
+
+/**
+ * Build the deferred indexes of the streams that are not discarded. A stream
+ * enabled after reading has started begins at its first keyframe at or after
+ * the next sample to be read.
+ */
+static void mov_build_selected_indexes(AVFormatContext *s)
+{
+    MOVContext *mov = s->priv_data;
+    AVIndexEntry *next = NULL;
+    AVStream *next_st = NULL;
+    int64_t next_ts = 0;
+    int i, started = 0, built = 0, pending = 0;
+
+    if (!mov->nb_deferred_indexes)
+        return;
+
+    for (i = 0; i < s->nb_streams; i++) {
+        AVStream *st = s->streams[i];
+        MOVStreamContext *sc = st->priv_data;
+        started |= sc->current_sample > 0;
+        pending |= sc->index_deferred && st->discard != AVDISCARD_ALL;
+    }
+    if (!pending)
+        return;
+    if (started)
+        next = mov_find_next_sample(s, &next_st);
+    if (next)
+        next_ts = next->timestamp;
+
+    for (i = 0; i < s->nb_streams; i++) {
+        AVStream *st = s->streams[i];
+        MOVStreamContext *sc = st->priv_data;
+
+        if (!sc->index_deferred || st->discard == AVDISCARD_ALL)
+            continue;
+        mov_build_deferred_index(mov, st);
+        /* mov_seek_stream() takes a pts and, without AVSEEK_FLAG_BACKWARD,
+         * picks the first keyframe at or after it */
+        if (started &&
+            (!next || mov_seek_stream(s, st, av_rescale_q(next_ts, next_st->time_base,
+                                                          st->time_base) +
+                                             sc->min_corrected_pts + sc->dts_shift, 0) < 0))
+            mov_current_sample_set(sc, st->nb_index_entries);
+        built = 1;
+    }
+    if (built)
+        ff_configure_buffers_for_index(s, AV_TIME_BASE);
+}
+
 static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
 {
     MOVContext *mov = s->priv_data;
@@ -7872,6 +7996,7 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
     int64_t current_index;
     int ret;
     mov->fc = s;
+    mov_build_selected_indexes(s);
  retry:
     sample = mov_find_next_sample(s, &st);
     if (!sample || (mov->next_root_atom && sample->pos > mov->next_root_atom)) {
@@ -8092,6 +8217,11 @@ static int mov_read_seek(AVFormatContext *s, int stream_index, int64_t sample_ti
     if (stream_index >= s->nb_streams)
         return AVERROR_INVALIDDATA;
 
+    if (mc->lazy_index) {
+        mov_build_deferred_index(mc, s->streams[stream_index]);
+        mov_build_selected_indexes(s);
+    }
+
     st = s->streams[stream_index];
     sample = mov_seek_stream(s, st, sample_time, flags);
     if (sample < 0)
@@ -8177,6 +8307,9 @@ static const AVOption mov_options[] = {
     { "decryption_key", "The media decryption key (hex)", OFFSET(decryption_key), AV_OPT_TYPE_BINARY, .flags = AV_OPT_FLAG_DECODING_PARAM },
     { "enable_drefs", "Enable external track support.", OFFSET(enable_drefs), AV_OPT_TYPE_BOOL,
         {.i64 = 0}, 0, 1, FLAGS },
+    { "lazy_index", "Build the index of a track only when it is read or seeked. "
+        "The start time and edit list duration of a track are only known after that.", OFFSET(lazy_index), AV_OPT_TYPE_BOOL,
+        {.i64 = 0}, 0, 1, FLAGS },
 
     { NULL },
 };
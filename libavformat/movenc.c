@@ -5230,24 +5230,158 @@ static void mov_parse_truehd_frame(AVPacket *pkt, MOVTrack *trk)
     return;
 }
 
-static int mov_flush_fragment_interleaving(AVFormatContext *s, MOVTrack *track)
+static int64_t frag_data_size(MOVFragmentData *fd)
 {
-    MOVMuxContext *mov = s->priv_data;
-    int ret, buf_size;
+    return fd->size + (fd->dyn_buf ? avio_tell(fd->dyn_buf) : 0);
+}
+
+static int frag_data_append(MOVFragmentData *fd, AVBufferRef *buf,
+                            const uint8_t *data, int size)
+{
+    MOVFragmentChunk *chunks;
+
+    chunks = av_fast_realloc(fd->chunks, &fd->chunks_allocated,
+                             (fd->nb_chunks + 1) * sizeof(*fd->chunks));
+    if (!chunks) {
+        av_buffer_unref(&buf);
+        return AVERROR(ENOMEM);
+    }
+    fd->chunks = chunks;
+    chunks[fd->nb_chunks].buf  = buf;
+    chunks[fd->nb_chunks].data = data;
+    chunks[fd->nb_chunks].size = size;
+    fd->nb_chunks++;
+    fd->size += size;
+    return 0;
+}
+
+/* move the rewritten data to the list of chunks */
+static int frag_data_close_dyn_buf(MOVFragmentData *fd)
+{
+    AVBufferRef *ref;
     uint8_t *buf;
-    int i, offset;
+    int size;
 
-    if (!track->mdat_buf)
+    if (!fd->dyn_buf)
         return 0;
-    if (!mov->mdat_buf) {
-        if ((ret = avio_open_dyn_buf(&mov->mdat_buf)) < 0)
-            return ret;
+    size = avio_close_dyn_buf(fd->dyn_buf, &buf);
+    fd->dyn_buf = NULL;
+    if (!size) {
+        av_free(buf);
+        return 0;
+    }
+    ref = av_buffer_create(buf, size, NULL, NULL, 0);
+    if (!ref) {
+        av_free(buf);
+        return AVERROR(ENOMEM);
+    }
+    return frag_data_append(fd, ref, buf, size);
+}
+
+static int frag_data_get_pb(MOVFragmentData *fd, AVIOContext **pb)
+{
+    int ret;
+
+    if (!fd->dyn_buf && (ret = avio_open_dyn_buf(&fd->dyn_buf)) < 0)
+        return ret;
+    *pb = fd->dyn_buf;
+    return 0;
+}
+
+/* add sample data without copying it when the packet is reference counted */
+static int frag_data_add(MOVFragmentData *fd, AVBufferRef *buf,
+                         const uint8_t *data, int size)
+{
+    AVBufferRef *ref;
+    int ret;
+
+    if (fd->dyn_buf && avio_tell(fd->dyn_buf) &&
+        (ret = frag_data_close_dyn_buf(fd)) < 0)
+        return ret;
+    if (buf) {
+        ref = av_buffer_ref(buf);
+        if (!ref)
+            return AVERROR(ENOMEM);
+    } else {
+        ref = av_buffer_alloc(size);
+        if (!ref)
+            return AVERROR(ENOMEM);
+        memcpy(ref->data, data, size);
+        data = ref->data;
     }
-    buf_size = avio_get_dyn_buf(track->mdat_buf, &buf);
+    return frag_data_append(fd, ref, data, size);
+}
 
-    offset = avio_tell(mov->mdat_buf);
-    avio_write(mov->mdat_buf, buf, buf_size);
-    ffio_free_dyn_buf(&track->mdat_buf);
+/* append all the data of src to dst */
+static int frag_data_move(MOVFragmentData *dst, MOVFragmentData *src)
+{
+    int i, ret;
+
+    if ((ret = frag_data_close_dyn_buf(dst)) < 0 ||
+        (ret = frag_data_close_dyn_buf(src)) < 0)
+        return ret;
+    for (i = 0; i < src->nb_chunks; i++) {
+        MOVFragmentChunk *c = &src->chunks[i];
+        ret = frag_data_append(dst, c->buf, c->data, c->size);
+        c->buf = NULL;
+        if (ret < 0)
+            break;
+    }
+    for (; i < src->nb_chunks; i++)
+        av_buffer_unref(&src->chunks[i].buf);
+    src->nb_chunks = 0;
+    src->size      = 0;
+    return ret;
+}
+
+static void frag_data_free(MOVFragmentData *fd)
+{
+    int i;
+
+    for (i = 0; i < fd->nb_chunks; i++)
+        av_buffer_unref(&fd->chunks[i].buf);
+    av_freep(&fd->chunks);
+    fd->chunks_allocated = 0;
+    fd->nb_chunks        = 0;
+    fd->size             = 0;
+    ffio_free_dyn_buf(&fd->dyn_buf);
+}
+
+/* write the data straight from the chunks and release them */
+static int frag_data_write(AVIOContext *pb, MOVFragmentData *fd)
+{
+    URLIOVec vecs[URL_MAX_IOVECS];
+    int i, n = 0, ret;
+
+    if ((ret = frag_data_close_dyn_buf(fd)) < 0)
+        return ret;
+    for (i = 0; i < fd->nb_chunks; i++) {
+        vecs[n].data   = fd->chunks[i].data;
+        vecs[n++].size = fd->chunks[i].size;
+        if (n == URL_MAX_IOVECS || i == fd->nb_chunks - 1) {
+            ffio_writev(pb, vecs, n);
+            n = 0;
+        }
+    }
+    for (i = 0; i < fd->nb_chunks; i++)
+        av_buffer_unref(&fd->chunks[i].buf);
+    fd->nb_chunks = 0;
+    fd->size      = 0;
+    return 0;
+}
+
+static int mov_flush_fragment_interleaving(AVFormatContext *s, MOVTrack *track)
+{
+    MOVMuxContext *mov = s->priv_data;
+    int64_t offset;
+    int i, ret;
+
+    if (!frag_data_size(&track->frag_data))
+        return 0;
+
+    offset = frag_data_size(&mov->frag_data);
+    if ((ret = frag_data_move(&mov->frag_data, &track->frag_data)) < 0)
+        return ret;
 
     for (i = track->entries_flushed; i < track->entry; i++)
         track->cluster[i].pos += offset;
@@ -5316,8 +5450,7 @@ static int mov_flush_fragment(AVFormatContext *s, int force)
 
     if (!mov->moov_written) {
         int64_t pos = avio_tell(s->pb);
-        uint8_t *buf;
-        int buf_size, moov_size;
+        int moov_size;
 
         for (i = 0; i < mov->nb_streams; i++)
             if (!mov->tracks[i].entry && !is_cover_image(mov->tracks[i].st))
@@ -5344,11 +5477,10 @@ static int mov_flush_fragment(AVFormatContext *s, int force)
             return 0;
         }
 
-        buf_size = avio_get_dyn_buf(mov->mdat_buf, &buf);
-        avio_wb32(s->pb, buf_size + 8);
+        avio_wb32(s->pb, frag_data_size(&mov->frag_data) + 8);
         ffio_wfourcc(s->pb, "mdat");
-        avio_write(s->pb, buf, buf_size);
-        ffio_free_dyn_buf(&mov->mdat_buf);
+        if ((ret = frag_data_write(s->pb, &mov->frag_data)) < 0)
+            return ret;
 
         if (mov->flags & FF_MOV_FLAG_GLOBAL_SIDX)
             mov->reserved_header_pos = avio_tell(s->pb);
@@ -5375,9 +5507,9 @@ static int mov_flush_fragment(AVFormatContext *s, int force)
                 return ret;
         }
 
-        if (!mov->mdat_buf)
+        mdat_size = frag_data_size(&mov->frag_data);
+        if (!mdat_size)
             return 0;
-        mdat_size = avio_tell(mov->mdat_buf);
     }
 
     for (i = 0; i < mov->nb_streams; i++) {
@@ -5396,8 +5528,7 @@ static int mov_flush_fragment(AVFormatContext *s, int force)
         }
         if (!track->entry)
             continue;
-        if (track->mdat_buf)
-            mdat_size += avio_tell(track->mdat_buf);
+        mdat_size += frag_data_size(&track->frag_data);
         if (first_track < 0)
             first_track = i;
     }
@@ -5411,17 +5542,16 @@ static int mov_flush_fragment(AVFormatContext *s, int force)
 
     for (i = 0; i < mov->nb_streams; i++) {
         MOVTrack *track = &mov->tracks[i];
-        int buf_size, write_moof = 1, moof_tracks = -1;
-        uint8_t *buf;
+        int write_moof = 1, moof_tracks = -1;
         int64_t duration = 0;
 
         if (track->entry)
             duration = track->start_dts + track->track_duration -
                        track->cluster[0].dts;
         if (mov->flags & FF_MOV_FLAG_SEPARATE_MOOF) {
-            if (!track->mdat_buf)
+            mdat_size = frag_data_size(&track->frag_data);
+            if (!mdat_size)
                 continue;
-            mdat_size = avio_tell(track->mdat_buf);
             moof_tracks = i;
         } else {
             write_moof = i == first_track;
@@ -5442,20 +5572,10 @@ static int mov_flush_fragment(AVFormatContext *s, int force)
         track->entry = 0;
         track->entries_flushed = 0;
         track->end_reliable = 0;
-        if (!mov->frag_interleave) {
-            if (!track->mdat_buf)
-                continue;
-            buf_size = avio_close_dyn_buf(track->mdat_buf, &buf);
-            track->mdat_buf = NULL;
-        } else {
-            if (!mov->mdat_buf)
-                continue;
-            buf_size = avio_close_dyn_buf(mov->mdat_buf, &buf);
-            mov->mdat_buf = NULL;
-        }
-
-        avio_write(s->pb, buf, buf_size);
-        av_free(buf);
+        ret = frag_data_write(s->pb, mov->frag_interleave ? &mov->frag_data
+                                                          : &track->frag_data);
+        if (ret < 0)
+            return ret;
     }
 
     mov->mdat_size = 0;
@@ -5527,6 +5647,7 @@ int ff_mov_write_packet(AVFormatContext *s, AVPacket *pkt)
     int size = pkt->size, ret = 0, offset = 0;
     int prft_size;
     uint8_t *reformatted_data = NULL;
+    MOVFragmentData *frag = NULL;
 
     ret = check_pkt(s, pkt);
     if (ret < 0)
@@ -5542,18 +5663,12 @@ int ff_mov_write_packet(AVFormatContext *s, AVPacket *pkt)
                 }
             }
 
-            if (!trk->mdat_buf) {
-                if ((ret = avio_open_dyn_buf(&trk->mdat_buf)) < 0)
-                    return ret;
-            }
-            pb = trk->mdat_buf;
+            frag = &trk->frag_data;
         } else {
-            if (!mov->mdat_buf) {
-                if ((ret = avio_open_dyn_buf(&mov->mdat_buf)) < 0)
-                    return ret;
-            }
-            pb = mov->mdat_buf;
+            frag = &mov->frag_data;
         }
+        if ((ret = frag_data_get_pb(frag, &pb)) < 0)
+            return ret;
     }
 
     if (par->codec_id == AV_CODEC_ID_AMR_NB) {
@@ -5703,6 +5818,10 @@ int ff_mov_write_packet(AVFormatContext *s, AVPacket *pkt)
             if (ret) {
                 goto err;
             }
+        } else if (frag) {
+            ret = frag_data_add(frag, pkt->buf, pkt->data, size);
+            if (ret < 0)
+                goto err;
         } else {
             avio_write(pb, pkt->data, size);
         }
@@ -5718,7 +5837,7 @@ int ff_mov_write_packet(AVFormatContext *s, AVPacket *pkt)
         trk->cluster_capacity = new_capacity;
     }
 
-    trk->cluster[trk->entry].pos              = avio_tell(pb) - size;
+    trk->cluster[trk->entry].pos              = (frag ? frag_data_size(frag) : avio_tell(pb)) - size;
     trk->cluster[trk->entry].samples_in_chunk = samples_in_chunk;
     trk->cluster[trk->entry].chunkNum         = 0;
     trk->cluster[trk->entry].size             = size;
@@ -6280,11 +6399,11 @@ static void mov_free(AVFormatContext *s)
             av_freep(&mov->tracks[i].vos_data);
 
         ff_mov_cenc_free(&mov->tracks[i].cenc);
-        ffio_free_dyn_buf(&mov->tracks[i].mdat_buf);
+        frag_data_free(&mov->tracks[i].frag_data);
     }
 
     av_freep(&mov->tracks);
-    ffio_free_dyn_buf(&mov->mdat_buf);
+    frag_data_free(&mov->frag_data);
 }
 
 static uint32_t rgb_to_yuv(uint32_t rgb)
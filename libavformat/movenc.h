@@ -81,6 +81,25 @@ typedef struct MOVFragmentInfo {
     int size;
 } MOVFragmentInfo;
 
+typedef struct MOVFragmentChunk {
+    AVBufferRef   *buf;
+    const uint8_t *data;
+    int            size;
+} MOVFragmentChunk;
+
+/**
+ * Sample data of a fragment, kept as references to the packet buffers until
+ * the fragment is written. Data that has to be rewritten (bitstream format
+ * conversion, encryption, ...) is collected in dyn_buf first.
+ */
+typedef struct MOVFragmentData {
+    MOVFragmentChunk *chunks;
+    unsigned int      chunks_allocated;
+    int               nb_chunks;
+    int64_t           size;     ///< size of the data in chunks
+    AVIOContext      *dyn_buf;
+} MOVFragmentData;
+
 typedef struct MOVTrack {
     int         mode;
     int         entry;
@@ -136,7 +155,7 @@ typedef struct MOVTrack {
     HintSampleQueue sample_queue;
     AVPacket cover_image;
 
-    AVIOContext *mdat_buf;
+    MOVFragmentData frag_data;
     int64_t     data_offset;
     int64_t     frag_start;
     int         frag_discont;
@@ -202,7 +221,7 @@ typedef struct MOVMuxContext {
     int min_fragment_duration;
     int max_fragment_size;
     int ism_lookahead;
-    AVIOContext *mdat_buf;
+    MOVFragmentData frag_data;
     int first_trun;
 
     int video_track_timescale;
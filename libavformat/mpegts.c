@@ -153,6 +153,7 @@ struct MpegTSContext {
 
     int resync_size;
     int merge_pmt_versions;
+    int skip_unselected;
 
     /******************************************/
     /* private mpegts data */
@@ -189,6 +190,8 @@ static const AVOption options[] = {
      {.i64 = 0}, 0, 1, 0 },
     {"skip_clear", "skip clearing programs", offsetof(MpegTSContext, skip_clear), AV_OPT_TYPE_BOOL,
      {.i64 = 0}, 0, 1, 0 },
+    {"skip_unselected", "skip parsing sections not belonging to a selected program", offsetof(MpegTSContext, skip_unselected), AV_OPT_TYPE_BOOL,
+     {.i64 = 0}, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
     { NULL },
 };
 
@@ -371,7 +374,8 @@ static void update_av_program_info(AVFormatContext *s, unsigned int programid,
  *                      to caller's programs selection
  * @param ts    : - TS context
  * @param pid   : - pid
- * @return 1 if the pid is only comprised in programs that have .discard=AVDISCARD_ALL
+ * @return 1 if the pid is only comprised in programs that have .discard=AVDISCARD_ALL,
+ *           or carries tables outside of any program with skip_unselected
  *         0 otherwise
  */
 static int discard_pid(MpegTSContext *ts, unsigned int pid)
@@ -405,6 +409,15 @@ static int discard_pid(MpegTSContext *ts, unsigned int pid)
         }
     }
 
+    if (!used && !discarded && ts->skip_unselected &&
+        !(ts->stream->ctx_flags & AVFMTCTX_NOHEADER)) {
+        /* tables outside of any program (SDT, NIT, ...), the EIT is kept
+         * as long as the EPG stream is wanted */
+        if (ts->pids[pid] && ts->pids[pid]->type == MPEGTS_SECTION &&
+            (pid != EIT_PID || (ts->epg_stream && ts->epg_stream->discard == AVDISCARD_ALL)))
+            return 1;
+    }
+
     return !used && discarded;
 }
 
@@ -2856,6 +2869,18 @@ static int mpegts_resync(AVFormatContext *s, int seekback, const uint8_t *curren
     avio_seek(pb, -back, SEEK_CUR);
 
     for (i = 0; i < ts->resync_size; i++) {
+        /* look for the sync byte in the whole buffered data at once,
+         * memchr() is vectorized by the C library */
+        int len = FFMIN(pb->buf_end - pb->buf_ptr, ts->resync_size - i);
+        if (len > 0) {
+            const uint8_t *sync = memchr(pb->buf_ptr, 0x47, len);
+            if (sync)
+                len = sync - pb->buf_ptr;
+            avio_skip(pb, len);
+            i += len;
+            if (i >= ts->resync_size)
+                break;
+        }
         c = avio_r8(pb);
         if (avio_feof(pb))
             return AVERROR_EOF;
@@ -2915,13 +2940,44 @@ static void finished_reading_packet(AVFormatContext *s, int raw_packet_size)
         avio_skip(pb, skip);
 }
 
+/**
+ * Skip the packets available in the I/O buffer that handle_packet() would
+ * ignore because their PID has no filter or is discarded, without copying
+ * them or going through the generic packet handling.
+ *
+ * @return number of packets skipped
+ */
+static int skip_discarded_packets(MpegTSContext *ts, int64_t max_packets)
+{
+    AVIOContext *pb = ts->stream->pb;
+    const uint8_t *p = pb->buf_ptr;
+    int64_t nb = FFMIN((pb->buf_end - p) / ts->raw_packet_size, max_packets);
+    int i;
+
+    for (i = 0; i < nb; i++, p += ts->raw_packet_size) {
+        MpegTSFilter *tss;
+        int is_start;
+
+        if (p[0] != 0x47)
+            break;
+        tss      = ts->pids[AV_RB16(p + 1) & 0x1fff];
+        is_start = p[1] & 0x40;
+        /* the discard state is only updated at the start of a unit */
+        if (tss ? !tss->discard || is_start : ts->auto_guess && is_start)
+            break;
+    }
+    if (i)
+        avio_skip(pb, p - pb->buf_ptr);
+    return i;
+}
+
 static int handle_packets(MpegTSContext *ts, int64_t nb_packets)
 {
     AVFormatContext *s = ts->stream;
     uint8_t packet[TS_PACKET_SIZE + AV_INPUT_BUFFER_PADDING_SIZE];
     const uint8_t *data;
     int64_t packet_num;
-    int ret = 0;
+    int skipped, ret = 0;
 
     if (avio_tell(s->pb) != ts->last_pos) {
         int i;
@@ -2956,6 +3012,12 @@ static int handle_packets(MpegTSContext *ts, int64_t nb_packets)
         if (ts->stop_parse > 0)
             break;
 
+        skipped = skip_discarded_packets(ts, nb_packets ? nb_packets - packet_num : INT64_MAX);
+        if (skipped) {
+            packet_num += skipped - 1;
+            continue;
+        }
+
         ret = read_packet(s, packet, ts->raw_packet_size, &data);
         if (ret != 0)
             break;
@@ -836,7 +836,7 @@ static int64_t get_pcr(const MpegTSWrite *ts, AVIOContext *pb)
            ts->first_pcr;
 }
 
-static void write_packet(AVFormatContext *s, const uint8_t *packet)
+static void write_tp_extra_header(AVFormatContext *s)
 {
     MpegTSWrite *ts = s->priv_data;
     if (ts->m2ts_mode) {
@@ -846,9 +846,24 @@ static void write_packet(AVFormatContext *s, const uint8_t *packet)
         avio_write(s->pb, (unsigned char *) &tp_extra_header,
                    sizeof(tp_extra_header));
     }
+}
+
+static void write_packet(AVFormatContext *s, const uint8_t *packet)
+{
+    write_tp_extra_header(s);
     avio_write(s->pb, packet, TS_PACKET_SIZE);
 }
 
+/* Write a TS packet made of the first TS_PACKET_SIZE - len bytes of header
+ * followed by len bytes of payload, without assembling it first. */
+static void write_packet_payload(AVFormatContext *s, const uint8_t *header,
+                                 const uint8_t *payload, int len)
+{
+    write_tp_extra_header(s);
+    avio_write(s->pb, header, TS_PACKET_SIZE - len);
+    avio_write(s->pb, payload, len);
+}
+
 static void section_write_packet(MpegTSSection *s, const uint8_t *packet)
 {
     AVFormatContext *ctx = s->opaque;
@@ -1568,13 +1583,13 @@ static void mpegts_write_pes(AVFormatContext *s, AVStream *st,
         if (is_dvb_subtitle && payload_size == len) {
             memcpy(buf + TS_PACKET_SIZE - len, payload, len - 1);
             buf[TS_PACKET_SIZE - 1] = 0xff; /* end_of_PES_data_field_marker: an 8-bit field with fixed contents 0xff for DVB subtitle */
+            write_packet(s, buf);
         } else {
-            memcpy(buf + TS_PACKET_SIZE - len, payload, len);
+            write_packet_payload(s, buf, payload, len);
         }
 
         payload      += len;
         payload_size -= len;
-        write_packet(s, buf);
     }
     ts_st->prev_payload_key = key;
 }
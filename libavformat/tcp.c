@@ -261,6 +261,30 @@ static int tcp_write(URLContext *h, const uint8_t *buf, int size)
     return ret < 0 ? ff_neterrno() : ret;
 }
 
+#if HAVE_STRUCT_MSGHDR_MSG_FLAGS
+static int tcp_writev(URLContext *h, const URLIOVec *vecs, int nb_vecs)
+{
+    TCPContext *s = h->priv_data;
+    struct iovec iov[URL_MAX_IOVECS];
+    struct msghdr msg = { 0 };
+    int i, ret;
+
+    if (!(h->flags & AVIO_FLAG_NONBLOCK)) {
+        ret = ff_network_wait_fd_timeout(s->fd, 1, h->rw_timeout, &h->interrupt_callback);
+        if (ret)
+            return ret;
+    }
+    for (i = 0; i < nb_vecs; i++) {
+        iov[i].iov_base = (void *)vecs[i].data;
+        iov[i].iov_len  = vecs[i].size;
+    }
+    msg.msg_iov    = iov;
+    msg.msg_iovlen = nb_vecs;
+    ret = sendmsg(s->fd, &msg, MSG_NOSIGNAL);
+    return ret < 0 ? ff_neterrno() : ret;
+}
+#endif
+
 static int tcp_shutdown(URLContext *h, int flags)
 {
     TCPContext *s = h->priv_data;
@@ -316,6 +340,9 @@ const URLProtocol ff_tcp_protocol = {
     .url_accept          = tcp_accept,
     .url_read            = tcp_read,
     .url_write           = tcp_write,
+#if HAVE_STRUCT_MSGHDR_MSG_FLAGS
+    .url_writev          = tcp_writev,
+#endif
     .url_close           = tcp_close,
     .url_get_file_handle = tcp_get_file_handle,
     .url_get_short_seek  = tcp_get_window_size,
@@ -23,6 +23,9 @@
 #include "libavutil/avutil.h"
 #include "libavutil/avstring.h"
 #include "libavutil/opt.h"
+#include "libavutil/thread.h"
+#include "libavutil/threadmessage.h"
+#include "libavutil/time.h"
 #include "internal.h"
 #include "avformat.h"
 #include "avio_internal.h"
@@ -35,6 +38,19 @@ typedef enum {
 
 #define DEFAULT_SLAVE_FAILURE_POLICY ON_SLAVE_FAILURE_ABORT
 
+typedef enum {
+    ON_QUEUE_FULL_BLOCK = 1,
+    ON_QUEUE_FULL_DROP  = 2
+} SlaveQueuePolicy;
+
+#define DEFAULT_QUEUE_SIZE 256
+
+typedef struct TeeMessage {
+    AVPacket pkt;
+    int flush;               ///< flush the slave instead of writing pkt
+    int64_t time;            ///< av_gettime_relative() when queued
+} TeeMessage;
+
 typedef struct {
     AVFormatContext *avf;
     AVBSFContext **bsfs; ///< bitstream filters per stream
@@ -47,6 +63,26 @@ typedef struct {
      * disabled output streams are set to -1 */
     int *stream_map;
     int header_written;
+
+    int use_thread;
+    int queue_size;
+    SlaveQueuePolicy on_full;
+#if HAVE_THREADS
+    AVFormatContext *parent;
+    AVThreadMessageQueue *queue;
+    pthread_t thread;
+    int thread_started;
+    int thread_ret;
+#endif
+    /** per input stream, set after a drop until the next keyframe */
+    uint8_t *wait_keyframe;
+
+    /* writer thread statistics */
+    int64_t nb_written;
+    int64_t nb_dropped;
+    int     max_queued;
+    int64_t latency_sum;
+    int64_t latency_max;
 } TeeSlave;
 
 typedef struct TeeContext {
@@ -56,6 +92,9 @@ typedef struct TeeContext {
     TeeSlave *slaves;
     int use_fifo;
     AVDictionary *fifo_options;
+    int use_threads;
+    int queue_size;
+    int on_full;
 } TeeContext;
 
 static const char *const slave_delim     = "|";
@@ -68,6 +107,14 @@ static const AVOption options[] = {
          OFFSET(use_fifo), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, AV_OPT_FLAG_ENCODING_PARAM},
         {"fifo_options", "fifo pseudo-muxer options", OFFSET(fifo_options),
          AV_OPT_TYPE_DICT, {.str = NULL}, 0, 0, AV_OPT_FLAG_ENCODING_PARAM},
+        {"use_threads", "Write each slave from its own thread",
+         OFFSET(use_threads), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, AV_OPT_FLAG_ENCODING_PARAM},
+        {"queue_size", "Maximum number of packets queued for each slave thread",
+         OFFSET(queue_size), AV_OPT_TYPE_INT, {.i64 = DEFAULT_QUEUE_SIZE}, 1, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM},
+        {"onfull", "Behaviour when the queue of a slave thread is full",
+         OFFSET(on_full), AV_OPT_TYPE_INT, {.i64 = ON_QUEUE_FULL_BLOCK}, ON_QUEUE_FULL_BLOCK, ON_QUEUE_FULL_DROP, AV_OPT_FLAG_ENCODING_PARAM, "onfull"},
+            {"block", "Wait for the slave to catch up", 0, AV_OPT_TYPE_CONST, {.i64 = ON_QUEUE_FULL_BLOCK}, 0, 0, AV_OPT_FLAG_ENCODING_PARAM, "onfull"},
+            {"drop",  "Drop packets until the next keyframe", 0, AV_OPT_TYPE_CONST, {.i64 = ON_QUEUE_FULL_DROP}, 0, 0, AV_OPT_FLAG_ENCODING_PARAM, "onfull"},
         {NULL}
 };
 
@@ -95,6 +142,40 @@ static inline int parse_slave_failure_policy_option(const char *opt, TeeSlave *t
     return AVERROR(EINVAL);
 }
 
+static int parse_slave_thread_options(const char *use_thread, const char *queue_size,
+                                      const char *on_full, TeeSlave *tee_slave)
+{
+    if (use_thread) {
+        if (av_match_name(use_thread, "true,y,yes,enable,enabled,on,1")) {
+            tee_slave->use_thread = 1;
+        } else if (av_match_name(use_thread, "false,n,no,disable,disabled,off,0")) {
+            tee_slave->use_thread = 0;
+        } else {
+            return AVERROR(EINVAL);
+        }
+    }
+
+    if (queue_size) {
+        char *end;
+        long size = strtol(queue_size, &end, 10);
+        if (*end || size < 1 || size > INT_MAX)
+            return AVERROR(EINVAL);
+        tee_slave->queue_size = size;
+    }
+
+    if (on_full) {
+        if (!av_strcasecmp("block", on_full)) {
+            tee_slave->on_full = ON_QUEUE_FULL_BLOCK;
+        } else if (!av_strcasecmp("drop", on_full)) {
+            tee_slave->on_full = ON_QUEUE_FULL_DROP;
+        } else {
+            return AVERROR(EINVAL);
+        }
+    }
+
+    return 0;
+}
+
 static int parse_slave_fifo_options(const char *use_fifo,
                                     const char *fifo_options, TeeSlave *tee_slave)
 {
@@ -118,6 +199,133 @@ static int parse_slave_fifo_options(const char *use_fifo,
     return ret;
 }
 
+static int write_slave_packet(void *log_ctx, TeeSlave *tee_slave, AVPacket *pkt)
+{
+    AVFormatContext *avf2 = tee_slave->avf;
+    AVBSFContext *bsfs;
+    int ret;
+
+    /* Flush slave if pkt is NULL*/
+    if (!pkt)
+        return av_interleaved_write_frame(avf2, NULL);
+
+    bsfs = tee_slave->bsfs[pkt->stream_index];
+
+    ret = av_bsf_send_packet(bsfs, pkt);
+    if (ret < 0) {
+        av_log(log_ctx, AV_LOG_ERROR, "Error while sending packet to bitstream filter: %s\n",
+               av_err2str(ret));
+        av_packet_unref(pkt);
+        return ret;
+    }
+
+    while(1) {
+        ret = av_bsf_receive_packet(bsfs, pkt);
+        if (ret == AVERROR(EAGAIN)) {
+            ret = 0;
+            break;
+        } else if (ret < 0) {
+            break;
+        }
+
+        av_packet_rescale_ts(pkt, bsfs->time_base_out,
+                             avf2->streams[pkt->stream_index]->time_base);
+        ret = av_interleaved_write_frame(avf2, pkt);
+        if (ret < 0)
+            break;
+    };
+
+    return ret;
+}
+
+#if HAVE_THREADS
+static void free_message(void *msg)
+{
+    TeeMessage *tee_msg = msg;
+
+    av_packet_unref(&tee_msg->pkt);
+}
+
+static void *slave_writer_thread(void *arg)
+{
+    TeeSlave *tee_slave = arg;
+    TeeMessage msg;
+    int ret;
+
+    while (1) {
+        ret = av_thread_message_queue_recv(tee_slave->queue, &msg, 0);
+        if (ret < 0)
+            break;
+
+        ret = write_slave_packet(tee_slave->parent, tee_slave, msg.flush ? NULL : &msg.pkt);
+        if (!msg.flush) {
+            int64_t latency = av_gettime_relative() - msg.time;
+
+            tee_slave->nb_written++;
+            tee_slave->latency_sum += latency;
+            tee_slave->latency_max  = FFMAX(tee_slave->latency_max, latency);
+        }
+        if (ret < 0) {
+            /* make the next packet sent to this slave fail with this error */
+            av_thread_message_queue_set_err_send(tee_slave->queue, ret);
+            break;
+        }
+    }
+
+    tee_slave->thread_ret = ret == AVERROR_EOF ? 0 : ret;
+    return NULL;
+}
+
+static int start_slave_thread(AVFormatContext *avf, TeeSlave *tee_slave)
+{
+    int ret;
+
+    tee_slave->parent = avf;
+    tee_slave->wait_keyframe = av_mallocz(avf->nb_streams);
+    if (!tee_slave->wait_keyframe)
+        return AVERROR(ENOMEM);
+
+    ret = av_thread_message_queue_alloc(&tee_slave->queue, tee_slave->queue_size,
+                                        sizeof(TeeMessage));
+    if (ret < 0)
+        return ret;
+    av_thread_message_queue_set_free_func(tee_slave->queue, free_message);
+
+    ret = pthread_create(&tee_slave->thread, NULL, slave_writer_thread, tee_slave);
+    if (ret) {
+        av_log(avf, AV_LOG_ERROR, "Failed to start thread: %s\n", av_err2str(AVERROR(ret)));
+        return AVERROR(ret);
+    }
+    tee_slave->thread_started = 1;
+
+    return 0;
+}
+
+static int stop_slave_thread(TeeSlave *tee_slave)
+{
+    int ret = 0;
+
+    if (tee_slave->thread_started) {
+        /* the thread drains the queued packets before it sees this */
+        av_thread_message_queue_set_err_recv(tee_slave->queue, AVERROR_EOF);
+        pthread_join(tee_slave->thread, NULL);
+        tee_slave->thread_started = 0;
+        ret = tee_slave->thread_ret;
+
+        av_log(tee_slave->parent, AV_LOG_VERBOSE,
+               "Slave '%s': %"PRId64" packets written, %"PRId64" dropped, "
+               "max queued %d/%d, latency avg %.3f ms max %.3f ms\n",
+               tee_slave->avf->url, tee_slave->nb_written, tee_slave->nb_dropped,
+               tee_slave->max_queued, tee_slave->queue_size,
+               tee_slave->nb_written ? tee_slave->latency_sum / 1000.0 / tee_slave->nb_written : 0.0,
+               tee_slave->latency_max / 1000.0);
+    }
+    av_thread_message_queue_free(&tee_slave->queue);
+
+    return ret;
+}
+#endif
+
 static int close_slave(TeeSlave *tee_slave)
 {
     AVFormatContext *avf;
@@ -128,8 +336,16 @@ static int close_slave(TeeSlave *tee_slave)
     if (!avf)
         return 0;
 
-    if (tee_slave->header_written)
-        ret = av_write_trailer(avf);
+#if HAVE_THREADS
+    ret = stop_slave_thread(tee_slave);
+#endif
+    av_freep(&tee_slave->wait_keyframe);
+
+    if (tee_slave->header_written) {
+        int ret2 = av_write_trailer(avf);
+        if (!ret)
+            ret = ret2;
+    }
 
     if (tee_slave->bsfs) {
         for (i = 0; i < avf->nb_streams; ++i)
@@ -163,6 +379,7 @@ static int open_slave(AVFormatContext *avf, char *slave, TeeSlave *tee_slave)
     char *filename;
     char *format = NULL, *select = NULL, *on_fail = NULL;
     char *use_fifo = NULL, *fifo_options_str = NULL;
+    char *use_thread = NULL, *queue_size = NULL, *on_full = NULL;
     AVFormatContext *avf2 = NULL;
     AVStream *st, *st2;
     int stream_count;
@@ -185,6 +402,9 @@ static int open_slave(AVFormatContext *avf, char *slave, TeeSlave *tee_slave)
     STEAL_OPTION("onfail", on_fail);
     STEAL_OPTION("use_fifo", use_fifo);
     STEAL_OPTION("fifo_options", fifo_options_str);
+    STEAL_OPTION("use_thread", use_thread);
+    STEAL_OPTION("queue_size", queue_size);
+    STEAL_OPTION("onfull", on_full);
     entry = NULL;
     while ((entry = av_dict_get(options, "bsfs", entry, AV_DICT_IGNORE_SUFFIX))) {
         /* trim out strlen("bsfs") characters from key */
@@ -205,6 +425,19 @@ static int open_slave(AVFormatContext *avf, char *slave, TeeSlave *tee_slave)
         goto end;
     }
 
+    ret = parse_slave_thread_options(use_thread, queue_size, on_full, tee_slave);
+    if (ret < 0) {
+        av_log(avf, AV_LOG_ERROR, "Invalid use_thread, queue_size or onfull option value\n");
+        goto end;
+    }
+#if !HAVE_THREADS
+    if (tee_slave->use_thread) {
+        av_log(avf, AV_LOG_ERROR, "Slave threads are not supported in this build\n");
+        ret = AVERROR(ENOSYS);
+        goto end;
+    }
+#endif
+
     if (tee_slave->use_fifo) {
 
         if (options) {
@@ -399,10 +632,18 @@ static int open_slave(AVFormatContext *avf, char *slave, TeeSlave *tee_slave)
         goto end;
     }
 
+#if HAVE_THREADS
+    if (tee_slave->use_thread)
+        ret = start_slave_thread(avf, tee_slave);
+#endif
+
 end:
     av_free(format);
     av_free(select);
     av_free(on_fail);
+    av_free(use_thread);
+    av_free(queue_size);
+    av_free(on_full);
     av_dict_free(&options);
     av_dict_free(&bsf_options);
     av_freep(&tmp_select);
@@ -427,6 +668,9 @@ static void log_slave(TeeSlave *slave, void *log_ctx, int log_level)
                    bsf->filter->priv_class->item_name(bsf) : bsf->filter->name;
         av_log(log_ctx, log_level, " bsfs: %s\n", bsf_name);
     }
+    if (slave->use_thread)
+        av_log(log_ctx, log_level, "    thread queue:%d onfull:%s\n", slave->queue_size,
+               slave->on_full == ON_QUEUE_FULL_DROP ? "drop" : "block");
 }
 
 static int tee_process_slave_failure(AVFormatContext *avf, unsigned slave_idx, int err_n)
@@ -482,7 +726,10 @@ static int tee_write_header(AVFormatContext *avf)
 
     for (i = 0; i < nb_slaves; i++) {
 
-        tee->slaves[i].use_fifo = tee->use_fifo;
+        tee->slaves[i].use_fifo   = tee->use_fifo;
+        tee->slaves[i].use_thread = tee->use_threads;
+        tee->slaves[i].queue_size = tee->queue_size;
+        tee->slaves[i].on_full    = tee->on_full;
         ret = av_dict_copy(&tee->slaves[i].fifo_options, tee->fifo_options, 0);
         if (ret < 0)
             goto fail;
@@ -534,68 +781,93 @@ static int tee_write_trailer(AVFormatContext *avf)
     return ret_all;
 }
 
+#if HAVE_THREADS
+static int queue_slave_packet(AVFormatContext *avf, TeeSlave *tee_slave, AVPacket *pkt)
+{
+    TeeMessage msg = { .flush = !pkt };
+    int flags = 0;
+    int ret;
+
+    if (pkt) {
+        unsigned s = pkt->stream_index;
+
+        if (tee_slave->on_full == ON_QUEUE_FULL_DROP) {
+            if (tee_slave->wait_keyframe[s] && !(pkt->flags & AV_PKT_FLAG_KEY)) {
+                tee_slave->nb_dropped++;
+                return 0;
+            }
+            flags = AV_THREAD_MESSAGE_NONBLOCK;
+        }
+
+        if ((ret = av_packet_ref(&msg.pkt, pkt)) < 0)
+            return ret;
+        msg.pkt.stream_index = tee_slave->stream_map[s];
+        msg.time = av_gettime_relative();
+
+        ret = av_thread_message_queue_send(tee_slave->queue, &msg, flags);
+        if (ret == AVERROR(EAGAIN)) {
+            if (!tee_slave->nb_dropped)
+                av_log(avf, AV_LOG_WARNING, "Slave '%s' is too slow, dropping packets\n",
+                       tee_slave->avf->url);
+            av_packet_unref(&msg.pkt);
+            tee_slave->nb_dropped++;
+            tee_slave->wait_keyframe[s] = 1;
+            return 0;
+        } else if (ret < 0) {
+            av_packet_unref(&msg.pkt);
+            return ret;
+        }
+        tee_slave->wait_keyframe[s] = 0;
+    } else {
+        ret = av_thread_message_queue_send(tee_slave->queue, &msg, 0);
+        if (ret < 0)
+            return ret;
+    }
+
+    tee_slave->max_queued = FFMAX(tee_slave->max_queued,
+                                  av_thread_message_queue_nb_elems(tee_slave->queue));
+    return 0;
+}
+#endif
+
 static int tee_write_packet(AVFormatContext *avf, AVPacket *pkt)
 {
     TeeContext *tee = avf->priv_data;
-    AVFormatContext *avf2;
-    AVBSFContext *bsfs;
     AVPacket pkt2;
     int ret_all = 0, ret;
     unsigned i, s;
     int s2;
 
     for (i = 0; i < tee->nb_slaves; i++) {
-        if (!(avf2 = tee->slaves[i].avf))
-            continue;
-
-        /* Flush slave if pkt is NULL*/
-        if (!pkt) {
-            ret = av_interleaved_write_frame(avf2, NULL);
-            if (ret < 0) {
-                ret = tee_process_slave_failure(avf, i, ret);
-                if (!ret_all && ret < 0)
-                    ret_all = ret;
-            }
-            continue;
-        }
+        TeeSlave *tee_slave = &tee->slaves[i];
 
-        s = pkt->stream_index;
-        s2 = tee->slaves[i].stream_map[s];
-        if (s2 < 0)
+        if (!tee_slave->avf)
             continue;
 
-        if ((ret = av_packet_ref(&pkt2, pkt)) < 0)
-            if (!ret_all) {
-                ret_all = ret;
+        if (pkt) {
+            s = pkt->stream_index;
+            s2 = tee_slave->stream_map[s];
+            if (s2 < 0)
                 continue;
-            }
-        bsfs = tee->slaves[i].bsfs[s2];
-        pkt2.stream_index = s2;
-
-        ret = av_bsf_send_packet(bsfs, &pkt2);
-        if (ret < 0) {
-            av_log(avf, AV_LOG_ERROR, "Error while sending packet to bitstream filter: %s\n",
-                   av_err2str(ret));
-            ret = tee_process_slave_failure(avf, i, ret);
-            if (!ret_all && ret < 0)
-                ret_all = ret;
         }
 
-        while(1) {
-            ret = av_bsf_receive_packet(bsfs, &pkt2);
-            if (ret == AVERROR(EAGAIN)) {
-                ret = 0;
-                break;
-            } else if (ret < 0) {
-                break;
-            }
+#if HAVE_THREADS
+        if (tee_slave->use_thread) {
+            ret = queue_slave_packet(avf, tee_slave, pkt);
+        } else
+#endif
+        if (!pkt) {
+            ret = write_slave_packet(avf, tee_slave, NULL);
+        } else {
+            if ((ret = av_packet_ref(&pkt2, pkt)) < 0)
+                if (!ret_all) {
+                    ret_all = ret;
+                    continue;
+                }
+            pkt2.stream_index = s2;
 
-            av_packet_rescale_ts(&pkt2, bsfs->time_base_out,
-                                 avf2->streams[s2]->time_base);
-            ret = av_interleaved_write_frame(avf2, &pkt2);
-            if (ret < 0)
-                break;
-        };
+            ret = write_slave_packet(avf, tee_slave, &pkt2);
+        }
 
         if (ret < 0) {
             ret = tee_process_slave_failure(avf, i, ret);
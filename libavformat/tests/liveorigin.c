@@ -0,0 +1,110 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavformat/avformat.h"
+#include "libavformat/liveorigin.h"
+
+static const char playlist[] =
+    "#EXTM3U\n"
+    "#EXT-X-VERSION:3\n"
+    "#EXT-X-TARGETDURATION:2\n"
+    "#EXT-X-MEDIA-SEQUENCE:0\n"
+    "#EXTINF:2.000000,\n"
+    "seg0.ts\n";
+
+static int publish(LiveOrigin *o, const char *name, const uint8_t *data, int size)
+{
+    AVIOContext *pb;
+    int ret = ff_live_origin_io_open(o, &pb, name);
+
+    if (ret < 0)
+        return ret;
+    avio_write(pb, data, size);
+    ff_live_origin_io_close(o, &pb);
+    return 0;
+}
+
+static void fetch(int port, const char *name, const uint8_t *data, int size)
+{
+    AVIOContext *pb = NULL;
+    uint8_t *buf;
+    char url[256];
+    int ret, len = 0;
+
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/%s", port, name);
+    ret = avio_open2(&pb, url, AVIO_FLAG_READ, NULL, NULL);
+    if (ret < 0) {
+        printf("%s: %s\n", name, ret == AVERROR_HTTP_NOT_FOUND ? "not found" : "error");
+        return;
+    }
+    if (!(buf = av_malloc(size + 1))) {
+        avio_closep(&pb);
+        return;
+    }
+    while (len <= size && (ret = avio_read(pb, buf + len, size + 1 - len)) > 0)
+        len += ret;
+    avio_closep(&pb);
+
+    printf("%s: %d bytes, %s\n", name, len,
+           len == size && !memcmp(buf, data, size) ? "match" : "mismatch");
+    av_free(buf);
+}
+
+int main(void)
+{
+    LiveOrigin *o = NULL;
+    uint8_t segment[3 * 4096 + 100];
+    char listen[64];
+    int i, port, ret = -1;
+
+    av_log_set_level(AV_LOG_FATAL);
+
+    for (i = 0; i < sizeof(segment); i++)
+        segment[i] = i * 13 + (i >> 8);
+
+    for (port = 38420; port < 38520 && ret < 0; port++) {
+        snprintf(listen, sizeof(listen), "127.0.0.1:%d", port);
+        ret = ff_live_origin_open(&o, listen, 4, 100, NULL);
+    }
+    if (ret < 0) {
+        fprintf(stderr, "Cannot open the origin\n");
+        return 1;
+    }
+    port--;
+
+    if (publish(o, "live.m3u8", playlist, strlen(playlist)) < 0 ||
+        publish(o, "seg0.ts", segment, sizeof(segment)) < 0) {
+        fprintf(stderr, "Cannot publish the files\n");
+        ff_live_origin_close(&o);
+        return 1;
+    }
+
+    fetch(port, "live.m3u8", playlist, strlen(playlist));
+    fetch(port, "seg0.ts", segment, sizeof(segment));
+    fetch(port, "seg1.ts", segment, sizeof(segment));
+
+    ff_live_origin_delete(o, "seg0.ts");
+    fetch(port, "seg0.ts", segment, sizeof(segment));
+
+    ff_live_origin_close(&o);
+    return 0;
+}
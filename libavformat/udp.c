@@ -26,6 +26,7 @@
 
 #define _DEFAULT_SOURCE
 #define _BSD_SOURCE     /* Needed for using struct ip_mreq with recent glibc */
+#define _GNU_SOURCE     /* Needed for sendmmsg() and recvmmsg() with glibc */
 
 #include "avformat.h"
 #include "avio_internal.h"
@@ -42,6 +43,9 @@
 #include "os_support.h"
 #include "url.h"
 #include "ip.h"
+#if HAVE_SENDMMSG || HAVE_RECVMMSG
+#include <netinet/udp.h>
+#endif
 
 #ifdef __APPLE__
 #include "TargetConditionals.h"
@@ -79,6 +83,11 @@
 #define UDP_RX_BUF_SIZE 393216
 #define UDP_MAX_PKT_SIZE 65536
 #define UDP_HEADER_SIZE 8
+#define UDP_GSO_MAX_SIZE (65535 - UDP_HEADER_SIZE - 40)
+#define UDP_GSO_MAX_SEGMENTS 64
+#define TS_PACKET_SIZE 188
+#define PCR_MAX       ((INT64_C(1) << 33) * 300)
+#define PCR_MAX_DELTA 27000000  /* larger gaps between PCRs are discontinuities */
 
 typedef struct UDPContext {
     const AVClass *class;
@@ -117,6 +126,30 @@ typedef struct UDPContext {
     char *sources;
     char *block;
     IPSourceFilters filters;
+
+    int batch_size;
+    int gso;
+    int gro;
+    uint8_t *batch_buf;     ///< datagrams moved in or out of the fifo by the thread
+    int64_t packets;        ///< number of datagrams sent or received
+    int64_t syscalls;       ///< number of system calls used for them
+
+    /* PCR pacing, done by the transmit thread */
+    int pcr_pacing;
+    int pacing_delay;
+    int pacing_spin;
+    int pcr_pid;
+    int64_t last_pcr;       ///< last PCR sent, in 27 MHz units
+    int64_t last_pcr_time;  ///< time at which its packet is due
+    int64_t pcr_bytes;      ///< bytes queued since the packet holding last_pcr
+    int64_t pcr_bitrate;    ///< rate measured between the last two PCRs
+    int resyncs;
+
+    /* pacing statistics, lateness of the paced sends in microseconds */
+    int64_t paced;
+    int64_t late_sum;
+    int64_t late_max;
+    double late_sq_sum;
 } UDPContext;
 
 #define OFFSET(x) offsetof(UDPContext, x)
@@ -141,6 +174,12 @@ static const AVOption options[] = {
     { "timeout",        "set raise error timeout (only in read mode)",     OFFSET(timeout),        AV_OPT_TYPE_INT,    { .i64 = 0 },      0, INT_MAX, D },
     { "sources",        "Source list",                                     OFFSET(sources),        AV_OPT_TYPE_STRING, { .str = NULL },               .flags = D|E },
     { "block",          "Block list",                                      OFFSET(block),          AV_OPT_TYPE_STRING, { .str = NULL },               .flags = D|E },
+    { "batch_size",     "Maximum number of packets per system call",        OFFSET(batch_size),     AV_OPT_TYPE_INT,    { .i64 = 1 },      1, URL_MAX_IOVECS, .flags = D|E },
+    { "gso",            "Let the kernel split batches of packets (UDP GSO)", OFFSET(gso),          AV_OPT_TYPE_BOOL,   { .i64 = 0 },      0, 1,       E },
+    { "gro",            "Let the kernel coalesce received packets (UDP GRO)", OFFSET(gro),         AV_OPT_TYPE_BOOL,   { .i64 = 0 },      0, 1,       D },
+    { "pcr_pacing",     "Send MPEG-TS packets at the time given by their PCR", OFFSET(pcr_pacing),   AV_OPT_TYPE_BOOL,   { .i64 = 0 },      0, 1,       E },
+    { "pacing_delay",   "Delay added to the PCR schedule to absorb input jitter, in microseconds", OFFSET(pacing_delay), AV_OPT_TYPE_INT, { .i64 = 100000 }, 0, 10000000, E },
+    { "pacing_spin",    "Busy wait for this many microseconds before paced sends", OFFSET(pacing_spin), AV_OPT_TYPE_INT, { .i64 = 0 },     0, 10000,   E },
     { NULL }
 };
 
@@ -459,7 +498,190 @@ static int udp_get_file_handle(URLContext *h)
     return s->udp_fd;
 }
 
+#ifdef UDP_SEGMENT
+/* Number of leading packets that can be sent as a single GSO datagram: all
+ * of the same size, except the last one which may be shorter. */
+static int udp_gso_segments(const URLIOVec *vecs, int nb_vecs)
+{
+    int i, size = 0;
+
+    for (i = 0; i < nb_vecs && i < UDP_GSO_MAX_SEGMENTS; i++) {
+        if (vecs[i].size > vecs[0].size || size + vecs[i].size > UDP_GSO_MAX_SIZE)
+            break;
+        size += vecs[i].size;
+        if (vecs[i].size < vecs[0].size)
+            return i + 1;
+    }
+    return i;
+}
+#endif
+
+/**
+ * Send up to nb_vecs packets with a single system call.
+ * @return the total size of the packets sent or a negative error code
+ */
+static int udp_send_packets(URLContext *h, const URLIOVec *vecs, int nb_vecs)
+{
+    UDPContext *s = h->priv_data;
+    int ret;
+#if HAVE_SENDMMSG
+    struct iovec iov[URL_MAX_IOVECS];
+    int i, size = 0;
+
+    for (i = 0; i < nb_vecs; i++) {
+        iov[i].iov_base = (void *)vecs[i].data;
+        iov[i].iov_len  = vecs[i].size;
+    }
+
+#ifdef UDP_SEGMENT
+    if (s->gso && nb_vecs > 1) {
+        int nb_segs = udp_gso_segments(vecs, nb_vecs);
+        if (nb_segs > 1) {
+            union {
+                char buf[CMSG_SPACE(sizeof(uint16_t))];
+                struct cmsghdr align;
+            } control = { { 0 } };
+            struct msghdr msg = { 0 };
+            struct cmsghdr *cmsg;
+            uint16_t gso_size = vecs[0].size;
+
+            msg.msg_iov        = iov;
+            msg.msg_iovlen     = nb_segs;
+            msg.msg_control    = control.buf;
+            msg.msg_controllen = sizeof(control.buf);
+            if (!s->is_connected) {
+                msg.msg_name    = &s->dest_addr;
+                msg.msg_namelen = s->dest_addr_len;
+            }
+            cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = IPPROTO_UDP;
+            cmsg->cmsg_type  = UDP_SEGMENT;
+            cmsg->cmsg_len   = CMSG_LEN(sizeof(gso_size));
+            memcpy(CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+
+            ret = sendmsg(s->udp_fd, &msg, 0);
+            if (ret >= 0) {
+                s->packets += nb_segs;
+                s->syscalls++;
+                return ret;
+            }
+            ret = ff_neterrno();
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR(EINTR))
+                return ret;
+            av_log(h, AV_LOG_WARNING, "UDP GSO is not usable (%s), disabling it\n",
+                   av_err2str(ret));
+            s->gso = 0;
+        }
+    }
+#endif
+
+    if (nb_vecs > 1) {
+        struct mmsghdr msgs[URL_MAX_IOVECS];
+
+        memset(msgs, 0, nb_vecs * sizeof(*msgs));
+        for (i = 0; i < nb_vecs; i++) {
+            msgs[i].msg_hdr.msg_iov    = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            if (!s->is_connected) {
+                msgs[i].msg_hdr.msg_name    = &s->dest_addr;
+                msgs[i].msg_hdr.msg_namelen = s->dest_addr_len;
+            }
+        }
+        ret = sendmmsg(s->udp_fd, msgs, nb_vecs, 0);
+        if (ret < 0)
+            return ff_neterrno();
+        s->packets += ret;
+        s->syscalls++;
+        for (i = 0; i < ret; i++)
+            size += vecs[i].size;
+        return size;
+    }
+#endif
+
+    if (!s->is_connected) {
+        ret = sendto (s->udp_fd, vecs[0].data, vecs[0].size, 0,
+                      (struct sockaddr *) &s->dest_addr,
+                      s->dest_addr_len);
+    } else
+        ret = send(s->udp_fd, vecs[0].data, vecs[0].size, 0);
+    if (ret < 0)
+        return ff_neterrno();
+    s->packets++;
+    s->syscalls++;
+    return ret;
+}
+
 #if HAVE_PTHREAD_CANCEL
+/**
+ * Receive up to nb datagrams, each in a buffer of UDP_MAX_PKT_SIZE bytes.
+ * With GRO, a datagram may hold several packets of seg_sizes[i] bytes.
+ * @return the number of datagrams received or a negative error code
+ */
+static int udp_recv_packets(UDPContext *s, uint8_t *buf, int nb,
+                            struct sockaddr_storage *addrs, int *sizes,
+                            int *seg_sizes)
+{
+    socklen_t addr_len = sizeof(*addrs);
+    int ret;
+
+#if HAVE_RECVMMSG
+    if (nb > 1 || s->gro) {
+        struct mmsghdr msgs[URL_MAX_IOVECS];
+        struct iovec iov[URL_MAX_IOVECS];
+        union {
+            char buf[CMSG_SPACE(sizeof(int))];
+            struct cmsghdr align;
+        } control[URL_MAX_IOVECS];
+        int i;
+
+        memset(msgs, 0, nb * sizeof(*msgs));
+        for (i = 0; i < nb; i++) {
+            iov[i].iov_base = buf + i * UDP_MAX_PKT_SIZE;
+            iov[i].iov_len  = UDP_MAX_PKT_SIZE;
+            msgs[i].msg_hdr.msg_iov        = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen     = 1;
+            msgs[i].msg_hdr.msg_name       = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen    = sizeof(*addrs);
+            msgs[i].msg_hdr.msg_control    = control[i].buf;
+            msgs[i].msg_hdr.msg_controllen = sizeof(control[i].buf);
+        }
+        ret = recvmmsg(s->udp_fd, msgs, nb, MSG_WAITFORONE, NULL);
+        if (ret < 0)
+            return ff_neterrno();
+        s->syscalls++;
+        for (i = 0; i < ret; i++) {
+#ifdef UDP_GRO
+            struct cmsghdr *cmsg;
+#endif
+
+            sizes[i]     = msgs[i].msg_len;
+            seg_sizes[i] = sizes[i];
+#ifdef UDP_GRO
+            for (cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg;
+                 cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+                if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+                    int gso_size;
+                    memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+                    if (gso_size > 0)
+                        seg_sizes[i] = gso_size;
+                }
+            }
+#endif
+            s->packets += seg_sizes[i] ? (sizes[i] + seg_sizes[i] - 1) / seg_sizes[i] : 1;
+        }
+        return ret;
+    }
+#endif
+
+    ret = recvfrom(s->udp_fd, buf, UDP_MAX_PKT_SIZE, 0, (struct sockaddr *)addrs, &addr_len);
+    if (ret < 0)
+        return ff_neterrno();
+    sizes[0] = seg_sizes[0] = ret;
+    s->packets++;
+    s->syscalls++;
+    return 1;
+}
+
 static void *circular_buffer_task_rx( void *_URLContext)
 {
     URLContext *h = _URLContext;
@@ -474,44 +696,57 @@ static void *circular_buffer_task_rx( void *_URLContext)
         goto end;
     }
     while(1) {
-        int len;
-        struct sockaddr_storage addr;
-        socklen_t addr_len = sizeof(addr);
+        struct sockaddr_storage addrs[URL_MAX_IOVECS];
+        int sizes[URL_MAX_IOVECS], seg_sizes[URL_MAX_IOVECS];
+        uint8_t *buf = s->batch_buf ? s->batch_buf : s->tmp + 4;
+        int i, nb;
 
         pthread_mutex_unlock(&s->mutex);
         /* Blocking operations are always cancellation points;
            see "General Information" / "Thread Cancelation Overview"
            in Single Unix. */
         pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_cancelstate);
-        len = recvfrom(s->udp_fd, s->tmp+4, sizeof(s->tmp)-4, 0, (struct sockaddr *)&addr, &addr_len);
+        nb = udp_recv_packets(s, buf, s->batch_size, addrs, sizes, seg_sizes);
         pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_cancelstate);
         pthread_mutex_lock(&s->mutex);
-        if (len < 0) {
-            if (ff_neterrno() != AVERROR(EAGAIN) && ff_neterrno() != AVERROR(EINTR)) {
-                s->circular_buffer_error = ff_neterrno();
+        if (nb < 0) {
+            if (nb != AVERROR(EAGAIN) && nb != AVERROR(EINTR)) {
+                s->circular_buffer_error = nb;
                 goto end;
             }
             continue;
         }
-        if (ff_ip_check_source_lists(&addr, &s->filters))
-            continue;
-        AV_WL32(s->tmp, len);
+        for (i = 0; i < nb; i++, buf += UDP_MAX_PKT_SIZE) {
+            const uint8_t *p = buf, *end = buf + sizes[i];
 
-        if(av_fifo_space(s->fifo) < len + 4) {
-            /* No Space left */
-            if (s->overrun_nonfatal) {
-                av_log(h, AV_LOG_WARNING, "Circular buffer overrun. "
-                        "Surviving due to overrun_nonfatal option\n");
+            if (ff_ip_check_source_lists(&addrs[i], &s->filters))
                 continue;
-            } else {
-                av_log(h, AV_LOG_ERROR, "Circular buffer overrun. "
-                        "To avoid, increase fifo_size URL option. "
-                        "To survive in such case, use overrun_nonfatal option\n");
-                s->circular_buffer_error = AVERROR(EIO);
-                goto end;
-            }
+
+            /* split the datagrams coalesced by GRO */
+            do {
+                int len = FFMIN(seg_sizes[i], end - p);
+                uint8_t tmp[4];
+
+                if(av_fifo_space(s->fifo) < len + 4) {
+                    /* No Space left */
+                    if (s->overrun_nonfatal) {
+                        av_log(h, AV_LOG_WARNING, "Circular buffer overrun. "
+                                "Surviving due to overrun_nonfatal option\n");
+                        break;
+                    } else {
+                        av_log(h, AV_LOG_ERROR, "Circular buffer overrun. "
+                                "To avoid, increase fifo_size URL option. "
+                                "To survive in such case, use overrun_nonfatal option\n");
+                        s->circular_buffer_error = AVERROR(EIO);
+                        goto end;
+                    }
+                }
+                AV_WL32(tmp, len);
+                av_fifo_generic_write(s->fifo, tmp, 4, NULL);
+                av_fifo_generic_write(s->fifo, (uint8_t *)p, len, NULL);
+                p += len;
+            } while (p < end);
         }
-        av_fifo_generic_write(s->fifo, s->tmp, len+4, NULL);
         pthread_cond_signal(&s->cond);
     }
 
@@ -521,6 +756,88 @@ end:
     return NULL;
 }
 
+/* Return the PCR of an MPEG-TS packet, or -1 if it has none. */
+static int64_t ts_packet_pcr(const uint8_t *p, int *pid, int *discontinuity)
+{
+    if (p[0] != 0x47 || !(p[3] & 0x20) || p[4] < 7 || !(p[5] & 0x10))
+        return -1;
+    *pid           = AV_RB16(p + 1) & 0x1fff;
+    *discontinuity = p[5] & 0x80;
+    return (AV_RB32(p + 6) * 2LL + (p[10] >> 7)) * 300 + ((p[10] & 1) << 8 | p[11]);
+}
+
+/**
+ * Track the PCRs of the first PCR PID found in the packets and compute
+ * the time at which the first packet is due: the PCRs give the time of
+ * their own packets, the bitrate measured between the last two PCRs the
+ * time of the packets in between.
+ *
+ * @return the time at which the packets are due or AV_NOPTS_VALUE when
+ * it is not known yet
+ */
+static int64_t udp_pcr_target(URLContext *h, const URLIOVec *vecs, int nb_vecs)
+{
+    UDPContext *s = h->priv_data;
+    int64_t target = AV_NOPTS_VALUE, start_bytes = s->pcr_bytes;
+    int i, pos, found = 0;
+
+    if (s->pcr_bitrate)
+        target = s->last_pcr_time + av_rescale(s->pcr_bytes, 8000000, s->pcr_bitrate);
+
+    for (i = 0; i < nb_vecs; i++) {
+        for (pos = 0; pos + TS_PACKET_SIZE <= vecs[i].size; pos += TS_PACKET_SIZE) {
+            int pid, discontinuity;
+            int64_t pcr = ts_packet_pcr(vecs[i].data + pos, &pid, &discontinuity);
+            int64_t delta, pcr_time;
+
+            if (pcr < 0 || s->pcr_pid >= 0 && pid != s->pcr_pid)
+                continue;
+            s->pcr_pid = pid;
+
+            delta = (pcr - s->last_pcr + PCR_MAX) % PCR_MAX;
+            if (s->last_pcr >= 0 && !discontinuity && delta && delta < PCR_MAX_DELTA) {
+                s->pcr_bitrate = av_rescale(s->pcr_bytes + pos, 8 * 27000000LL, delta);
+                pcr_time = s->last_pcr_time + delta / 27;
+            } else {
+                /* first PCR or discontinuity, start over from now */
+                pcr_time = av_gettime_relative() + s->pacing_delay;
+                s->pcr_bitrate = 0;
+            }
+            /* the first PCR found gives the time of the first packet */
+            if (!found++) {
+                target = pcr_time;
+                if (s->pcr_bitrate)
+                    target -= av_rescale(s->pcr_bytes + pos - start_bytes, 8000000, s->pcr_bitrate);
+            }
+
+            s->last_pcr      = pcr;
+            s->last_pcr_time = pcr_time;
+            s->pcr_bytes     = -pos;
+        }
+        s->pcr_bytes += vecs[i].size;
+    }
+
+    if (target != AV_NOPTS_VALUE && av_gettime_relative() - target > s->pacing_delay) {
+        /* the input stalled for longer than the delay absorbs, start over
+         * with a full delay instead of bursting to catch up */
+        int64_t shift = av_gettime_relative() - target + s->pacing_delay;
+        s->last_pcr_time += shift;
+        target           += shift;
+        s->resyncs++;
+    }
+    return target;
+}
+
+static void udp_wait_until(UDPContext *s, int64_t target)
+{
+    int64_t delay = target - av_gettime_relative();
+
+    if (delay > s->pacing_spin)
+        av_usleep(delay - s->pacing_spin);
+    if (s->pacing_spin)
+        while (av_gettime_relative() < target);
+}
+
 static void *circular_buffer_task_tx( void *_URLContext)
 {
     URLContext *h = _URLContext;
@@ -540,10 +857,11 @@ static void *circular_buffer_task_tx( void *_URLContext)
     }
 
     for(;;) {
-        int len;
-        const uint8_t *p;
+        URLIOVec vecs[URL_MAX_IOVECS];
+        uint8_t *buf = s->batch_buf ? s->batch_buf : s->tmp;
+        int i, len, nb = 0;
         uint8_t tmp[4];
-        int64_t timestamp;
+        int64_t timestamp, target = AV_NOPTS_VALUE;
 
         len=av_fifo_size(s->fifo);
 
@@ -556,17 +874,27 @@ static void *circular_buffer_task_tx( void *_URLContext)
             len=av_fifo_size(s->fifo);
         }
 
-        av_fifo_generic_read(s->fifo, tmp, 4, NULL);
-        len=AV_RL32(tmp);
+        /* take all the queued packets, up to batch_size */
+        len = 0;
+        do {
+            av_fifo_generic_read(s->fifo, tmp, 4, NULL);
+            vecs[nb].size = AV_RL32(tmp);
 
-        av_assert0(len >= 0);
-        av_assert0(len <= sizeof(s->tmp));
+            av_assert0(vecs[nb].size >= 0);
+            av_assert0(vecs[nb].size <= (s->batch_buf ? h->max_packet_size : sizeof(s->tmp)));
 
-        av_fifo_generic_read(s->fifo, s->tmp, len, NULL);
+            av_fifo_generic_read(s->fifo, buf, vecs[nb].size, NULL);
+            vecs[nb].data = buf;
+            buf += vecs[nb].size;
+            len += vecs[nb++].size;
+        } while (nb < s->batch_size && av_fifo_size(s->fifo) >= 4);
 
         pthread_mutex_unlock(&s->mutex);
 
-        if (s->bitrate) {
+        if (s->pcr_pacing)
+            target = udp_pcr_target(h, vecs, nb);
+
+        if (target == AV_NOPTS_VALUE && s->bitrate) {
             timestamp = av_gettime_relative();
             if (timestamp < target_timestamp) {
                 int64_t delay = target_timestamp - timestamp;
@@ -575,7 +903,7 @@ static void *circular_buffer_task_tx( void *_URLContext)
                     start_timestamp = timestamp + delay;
                     sent_bits = 0;
                 }
-                av_usleep(delay);
+                target = timestamp + delay;
             } else {
                 if (timestamp - burst_interval > target_timestamp) {
                     start_timestamp = timestamp - burst_interval;
@@ -586,21 +914,26 @@ static void *circular_buffer_task_tx( void *_URLContext)
             target_timestamp = start_timestamp + sent_bits * 1000000 / s->bitrate;
         }
 
-        p = s->tmp;
-        while (len) {
-            int ret;
-            av_assert0(len > 0);
-            if (!s->is_connected) {
-                ret = sendto (s->udp_fd, p, len, 0,
-                            (struct sockaddr *) &s->dest_addr,
-                            s->dest_addr_len);
-            } else
-                ret = send(s->udp_fd, p, len, 0);
+        if (target != AV_NOPTS_VALUE) {
+            int64_t late;
+
+            udp_wait_until(s, target);
+            late = av_gettime_relative() - target;
+            s->paced++;
+            s->late_sum    += late;
+            s->late_sq_sum += (double)late * late;
+            s->late_max     = FFMAX(s->late_max, late);
+        }
+
+        i = 0;
+        while (i < nb) {
+            int ret = udp_send_packets(h, vecs + i, nb - i);
             if (ret >= 0) {
-                len -= ret;
-                p   += ret;
+                /* only whole packets are sent */
+                do {
+                    ret -= vecs[i++].size;
+                } while (ret > 0);
             } else {
-                ret = ff_neterrno();
                 if (ret != AVERROR(EAGAIN) && ret != AVERROR(EINTR)) {
                     pthread_mutex_lock(&s->mutex);
                     s->circular_buffer_error = ret;
@@ -635,6 +968,8 @@ static int udp_open(URLContext *h, const char *uri, int flags)
     socklen_t len;
 
     h->is_streamed = 1;
+    s->pcr_pid  = -1;
+    s->last_pcr = -1;
 
     is_output = !(flags & AVIO_FLAG_READ);
     if (s->buffer_size < 0)
@@ -721,6 +1056,18 @@ static int udp_open(URLContext *h, const char *uri, int flags)
         }
         if (!is_output && av_find_info_tag(buf, sizeof(buf), "timeout", p))
             s->timeout = strtol(buf, NULL, 10);
+        if (av_find_info_tag(buf, sizeof(buf), "batch_size", p))
+            s->batch_size = av_clip(strtol(buf, NULL, 10), 1, URL_MAX_IOVECS);
+        if (is_output && av_find_info_tag(buf, sizeof(buf), "gso", p))
+            s->gso = strtol(buf, NULL, 10);
+        if (is_output && av_find_info_tag(buf, sizeof(buf), "pcr_pacing", p))
+            s->pcr_pacing = strtol(buf, NULL, 10);
+        if (is_output && av_find_info_tag(buf, sizeof(buf), "pacing_delay", p))
+            s->pacing_delay = av_clip(strtol(buf, NULL, 10), 0, 10000000);
+        if (is_output && av_find_info_tag(buf, sizeof(buf), "pacing_spin", p))
+            s->pacing_spin = av_clip(strtol(buf, NULL, 10), 0, 10000);
+        if (!is_output && av_find_info_tag(buf, sizeof(buf), "gro", p))
+            s->gro = strtol(buf, NULL, 10);
         if (is_output && av_find_info_tag(buf, sizeof(buf), "broadcast", p))
             s->is_broadcast = strtol(buf, NULL, 10);
     }
@@ -728,6 +1075,7 @@ static int udp_open(URLContext *h, const char *uri, int flags)
     s->circular_buffer_size *= 188;
     if (flags & AVIO_FLAG_WRITE) {
         h->max_packet_size = s->pkt_size;
+        h->max_packets     = s->batch_size;
     } else {
         h->max_packet_size = UDP_MAX_PKT_SIZE;
     }
@@ -863,6 +1211,22 @@ static int udp_open(URLContext *h, const char *uri, int flags)
                 av_log(h, AV_LOG_WARNING, "attempted to set receive buffer to size %d but it only ended up set as %d\n", s->buffer_size, tmp);
         }
 
+        if (s->gro) {
+#if defined(UDP_GRO) && HAVE_RECVMMSG && HAVE_PTHREAD_CANCEL
+            tmp = 1;
+            if (!s->circular_buffer_size) {
+                av_log(h, AV_LOG_WARNING, "'gro' option requires 'fifo_size', ignoring it\n");
+                s->gro = 0;
+            } else if (setsockopt(udp_fd, IPPROTO_UDP, UDP_GRO, &tmp, sizeof(tmp)) < 0) {
+                ff_log_net_error(h, AV_LOG_WARNING, "setsockopt(UDP_GRO)");
+                s->gro = 0;
+            }
+#else
+            av_log(h, AV_LOG_WARNING, "'gro' option is not supported on this build\n");
+            s->gro = 0;
+#endif
+        }
+
         /* make the socket non-blocking */
         ff_socket_nonblock(udp_fd, 1);
     }
@@ -882,16 +1246,24 @@ static int udp_open(URLContext *h, const char *uri, int flags)
       2. Output and bitrate and circular_buffer_size is set
     */
 
-    if (is_output && s->bitrate && !s->circular_buffer_size) {
+    if (is_output && (s->bitrate || s->pcr_pacing) && !s->circular_buffer_size) {
         /* Warn user in case of 'circular_buffer_size' is not set */
-        av_log(h, AV_LOG_WARNING,"'bitrate' option was set but 'circular_buffer_size' is not, but required\n");
+        av_log(h, AV_LOG_WARNING,"'%s' option was set but 'circular_buffer_size' is not, but required\n",
+               s->bitrate ? "bitrate" : "pcr_pacing");
     }
 
-    if ((!is_output && s->circular_buffer_size) || (is_output && s->bitrate && s->circular_buffer_size)) {
+    if ((!is_output && s->circular_buffer_size) ||
+        (is_output && (s->bitrate || s->pcr_pacing) && s->circular_buffer_size)) {
         int ret;
 
         /* start the task going */
         s->fifo = av_fifo_alloc(s->circular_buffer_size);
+        if (s->batch_size > 1 || s->gro) {
+            s->batch_buf = av_malloc_array(s->batch_size,
+                                           is_output ? h->max_packet_size : UDP_MAX_PKT_SIZE);
+            if (!s->batch_buf)
+                goto fail;
+        }
         ret = pthread_mutex_init(&s->mutex, NULL);
         if (ret != 0) {
             av_log(h, AV_LOG_ERROR, "pthread_mutex_init failed : %s\n", strerror(ret));
@@ -922,6 +1294,7 @@ static int udp_open(URLContext *h, const char *uri, int flags)
     if (udp_fd >= 0)
         closesocket(udp_fd);
     av_fifo_freep(&s->fifo);
+    av_freep(&s->batch_buf);
     ff_ip_reset_filters(&s->filters);
     return AVERROR(EIO);
 }
@@ -996,6 +1369,8 @@ static int udp_read(URLContext *h, uint8_t *buf, int size)
     ret = recvfrom(s->udp_fd, buf, size, 0, (struct sockaddr *)&addr, &addr_len);
     if (ret < 0)
         return ff_neterrno();
+    s->packets++;
+    s->syscalls++;
     if (ff_ip_check_source_lists(&addr, &s->filters))
         return AVERROR(EINTR);
     return ret;
@@ -1004,6 +1379,7 @@ static int udp_read(URLContext *h, uint8_t *buf, int size)
 static int udp_write(URLContext *h, const uint8_t *buf, int size)
 {
     UDPContext *s = h->priv_data;
+    URLIOVec vec = { buf, size };
     int ret;
 
 #if HAVE_PTHREAD_CANCEL
@@ -1041,14 +1417,31 @@ static int udp_write(URLContext *h, const uint8_t *buf, int size)
             return ret;
     }
 
-    if (!s->is_connected) {
-        ret = sendto (s->udp_fd, buf, size, 0,
-                      (struct sockaddr *) &s->dest_addr,
-                      s->dest_addr_len);
-    } else
-        ret = send(s->udp_fd, buf, size, 0);
+    return udp_send_packets(h, &vec, 1);
+}
+
+static int udp_writev(URLContext *h, const URLIOVec *vecs, int nb_vecs)
+{
+    UDPContext *s = h->priv_data;
+    int i, ret, size = 0;
+
+    if (!s->fifo) {
+        if (!(h->flags & AVIO_FLAG_NONBLOCK)) {
+            ret = ff_network_wait_fd(s->udp_fd, 1);
+            if (ret < 0)
+                return ret;
+        }
+        return udp_send_packets(h, vecs, nb_vecs);
+    }
 
-    return ret < 0 ? ff_neterrno() : ret;
+    /* the packets are queued one by one for the transmit thread */
+    for (i = 0; i < nb_vecs; i++) {
+        ret = udp_write(h, vecs[i].data, vecs[i].size);
+        if (ret < 0)
+            return size ? size : ret;
+        size += ret;
+    }
+    return size;
 }
 
 static int udp_close(URLContext *h)
@@ -1089,8 +1482,19 @@ static int udp_close(URLContext *h)
         pthread_cond_destroy(&s->cond);
     }
 #endif
+    if (s->syscalls)
+        av_log(h, AV_LOG_VERBOSE, "%"PRId64" packets %s in %"PRId64" system calls\n",
+               s->packets, h->flags & AVIO_FLAG_READ ? "received" : "sent", s->syscalls);
+    if (s->paced) {
+        double mean = (double)s->late_sum / s->paced;
+        av_log(h, AV_LOG_VERBOSE, "%"PRId64" paced sends, lateness mean %.1f us, "
+               "stddev %.1f us, max %"PRId64" us, %d resyncs\n", s->paced, mean,
+               sqrt(FFMAX(s->late_sq_sum / s->paced - mean * mean, 0)), s->late_max,
+               s->resyncs);
+    }
     closesocket(s->udp_fd);
     av_fifo_freep(&s->fifo);
+    av_freep(&s->batch_buf);
     ff_ip_reset_filters(&s->filters);
     return 0;
 }
@@ -1100,6 +1504,7 @@ const URLProtocol ff_udp_protocol = {
     .url_open            = udp_open,
     .url_read            = udp_read,
     .url_write           = udp_write,
+    .url_writev          = udp_writev,
     .url_close           = udp_close,
     .url_get_file_handle = udp_get_file_handle,
     .priv_data_size      = sizeof(UDPContext),
@@ -1112,6 +1517,7 @@ const URLProtocol ff_udplite_protocol = {
     .url_open            = udplite_open,
     .url_read            = udp_read,
     .url_write           = udp_write,
+    .url_writev          = udp_writev,
     .url_close           = udp_close,
     .url_get_file_handle = udp_get_file_handle,
     .priv_data_size      = sizeof(UDPContext),
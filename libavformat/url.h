@@ -49,8 +49,22 @@ typedef struct URLContext {
     const char *protocol_whitelist;
     const char *protocol_blacklist;
     int min_packet_size;        /**< if non zero, the stream is packetized with this min packet size */
+    int max_packets;            /**< if greater than 1, number of packets that url_writev can take at once */
 } URLContext;
 
+/**
+ * A buffer written with ffurl_writev() or ffio_writev().
+ */
+typedef struct URLIOVec {
+    const uint8_t *data;
+    int size;
+} URLIOVec;
+
+/**
+ * Maximum number of buffers passed to url_writev at once.
+ */
+#define URL_MAX_IOVECS 64
+
 typedef struct URLProtocol {
     const char *name;
     int     (*url_open)( URLContext *h, const char *url, int flags);
@@ -77,6 +91,15 @@ typedef struct URLProtocol {
      */
     int     (*url_read)( URLContext *h, unsigned char *buf, int size);
     int     (*url_write)(URLContext *h, const unsigned char *buf, int size);
+    /**
+     * Write several buffers with a single call, nb_vecs is at most
+     * URL_MAX_IOVECS. Stream protocols write the buffers back to back,
+     * packet protocols send each buffer as one packet.
+     * Return the number of bytes written, which may stop before the end of
+     * a buffer for stream protocols and is always at a buffer boundary for
+     * packet protocols, or a negative error code.
+     */
+    int     (*url_writev)(URLContext *h, const URLIOVec *vecs, int nb_vecs);
     int64_t (*url_seek)( URLContext *h, int64_t pos, int whence);
     int     (*url_close)(URLContext *h);
     int (*url_read_pause)(URLContext *h, int pause);
@@ -202,6 +225,16 @@ int ffurl_read_complete(URLContext *h, unsigned char *buf, int size);
  */
 int ffurl_write(URLContext *h, const unsigned char *buf, int size);
 
+/**
+ * Write nb_vecs buffers to the resource accessed by h, with a single
+ * call to the protocol when it supports it. For packet protocols, each
+ * buffer is one packet.
+ *
+ * @return the total number of bytes written, or a negative value
+ * corresponding to an AVERROR code in case of failure
+ */
+int ffurl_writev(URLContext *h, const URLIOVec *vecs, int nb_vecs);
+
 /**
  * Change the position that will be used by the next read/write
  * operation on the resource accessed by h.
@@ -426,10 +426,12 @@ av_cold int swri_rematrix_init(SwrContext *s){
         if (maxsum <= 32768) {
             s->mix_1_1_f = (mix_1_1_func_type*)copy_s16;
             s->mix_2_1_f = (mix_2_1_func_type*)sum2_s16;
+            s->mix_n_1_f = (mix_n_1_func_type*)mix_n_1_s16;
             s->mix_any_f = (mix_any_func_type*)get_mix_any_func_s16(s);
         } else {
             s->mix_1_1_f = (mix_1_1_func_type*)copy_clip_s16;
             s->mix_2_1_f = (mix_2_1_func_type*)sum2_clip_s16;
+            s->mix_n_1_f = (mix_n_1_func_type*)mix_n_1_clip_s16;
             s->mix_any_f = (mix_any_func_type*)get_mix_any_func_clip_s16(s);
         }
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_FLTP){
@@ -443,6 +445,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         *((float*)s->native_one) = 1.0;
         s->mix_1_1_f = (mix_1_1_func_type*)copy_float;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_float;
+        s->mix_n_1_f = (mix_n_1_func_type*)mix_n_1_float;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_float(s);
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_DBLP){
         s->native_matrix = av_calloc(nb_in * nb_out, sizeof(double));
@@ -455,6 +458,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         *((double*)s->native_one) = 1.0;
         s->mix_1_1_f = (mix_1_1_func_type*)copy_double;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_double;
+        s->mix_n_1_f = (mix_n_1_func_type*)mix_n_1_double;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_double(s);
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_S32P){
         s->native_one    = av_mallocz(sizeof(int));
@@ -477,6 +481,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         *((int*)s->native_one) = 32768;
         s->mix_1_1_f = (mix_1_1_func_type*)copy_s32;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_s32;
+        s->mix_n_1_f = (mix_n_1_func_type*)mix_n_1_s32;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_s32(s);
     }else
         av_assert0(0);
@@ -491,6 +496,22 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->matrix_ch[i][0]= ch_in;
     }
 
+    /* coefficients of the general mixing path, packed per output channel */
+    s->native_packed_matrix = av_calloc(nb_in * nb_out, FFMAX(sizeof(int), sizeof(double)));
+    if (!s->native_packed_matrix)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < nb_out; i++) {
+        for (j = 0; j < s->matrix_ch[i][0]; j++) {
+            int in_i = s->matrix_ch[i][1 + j];
+            int idx  = i * nb_in + j;
+            switch (s->midbuf.fmt) {
+            case AV_SAMPLE_FMT_FLTP: ((float  *)s->native_packed_matrix)[idx] = s->matrix_flt[i][in_i]; break;
+            case AV_SAMPLE_FMT_DBLP: ((double *)s->native_packed_matrix)[idx] = s->matrix[i][in_i];     break;
+            default:                 ((int    *)s->native_packed_matrix)[idx] = s->matrix32[i][in_i];   break;
+            }
+        }
+    }
+
     if(HAVE_X86ASM && HAVE_MMX)
         return swri_rematrix_init_x86(s);
 
@@ -502,27 +523,30 @@ av_cold void swri_rematrix_free(SwrContext *s){
     av_freep(&s->native_one);
     av_freep(&s->native_simd_matrix);
     av_freep(&s->native_simd_one);
+    av_freep(&s->native_packed_matrix);
 }
 
-int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
-    int out_i, in_i, i, j;
-    int len1 = 0;
-    int off = 0;
-
-    if(s->mix_any_f) {
-        s->mix_any_f(out->ch, (const uint8_t **)in->ch, s->native_matrix, len);
-        return 0;
-    }
+typedef struct RematrixThreadData {
+    AudioData *out;
+    const AudioData *in;
+    int len, len1, off;
+    int mustcopy;
+} RematrixThreadData;
 
-    if(s->mix_2_1_simd || s->mix_1_1_simd){
-        len1= len&~15;
-        off = len1 * out->bps;
-    }
-
-    av_assert0(!s->out_ch_layout || out->ch_count == av_get_channel_layout_nb_channels(s->out_ch_layout));
-    av_assert0(!s-> in_ch_layout || in ->ch_count == av_get_channel_layout_nb_channels(s-> in_ch_layout));
-
-    for(out_i=0; out_i<out->ch_count; out_i++){
+static void rematrix_channels(SwrContext *s, void *arg, int jobnr, int nb_jobs)
+{
+    RematrixThreadData *td = arg;
+    AudioData *out = td->out;
+    const AudioData *in = td->in;
+    int len  = td->len;
+    int len1 = td->len1;
+    int off  = td->off;
+    int mustcopy = td->mustcopy;
+    int start = out->ch_count *  jobnr      / nb_jobs;
+    int end   = out->ch_count * (jobnr + 1) / nb_jobs;
+    int out_i, in_i, j;
+
+    for(out_i=start; out_i<end; out_i++){
         switch(s->matrix_ch[out_i][0]){
         case 0:
             if(mustcopy)
@@ -551,36 +575,43 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
             if(len != len1)
                 s->mix_2_1_f   (out->ch[out_i]+off, in->ch[in_i1]+off, in->ch[in_i2]+off, s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len-len1);
             break;}
-        default:
-            if(s->int_sample_fmt == AV_SAMPLE_FMT_FLTP){
-                for(i=0; i<len; i++){
-                    float v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((float*)in->ch[in_i])[i] * s->matrix_flt[out_i][in_i];
-                    }
-                    ((float*)out->ch[out_i])[i]= v;
-                }
-            }else if(s->int_sample_fmt == AV_SAMPLE_FMT_DBLP){
-                for(i=0; i<len; i++){
-                    double v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((double*)in->ch[in_i])[i] * s->matrix[out_i][in_i];
-                    }
-                    ((double*)out->ch[out_i])[i]= v;
-                }
-            }else{
-                for(i=0; i<len; i++){
-                    int v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((int16_t*)in->ch[in_i])[i] * s->matrix32[out_i][in_i];
-                    }
-                    ((int16_t*)out->ch[out_i])[i]= (v + 16384)>>15;
-                }
+        default: {
+            const uint8_t *in_ch[SWR_CH_MAX];
+            int nb_in = s->matrix_ch[out_i][0];
+            int index = in->ch_count*out_i;
+            int done  = s->mix_n_1_simd ? len1 : 0;
+
+            for(j=0; j<nb_in; j++)
+                in_ch[j]= in->ch[s->matrix_ch[out_i][1+j]];
+            if(done)
+                s->mix_n_1_simd(out->ch[out_i], in_ch, s->native_packed_matrix, index, nb_in, done);
+            if(len != done){
+                for(j=0; j<nb_in; j++)
+                    in_ch[j] += done * out->bps;
+                s->mix_n_1_f(out->ch[out_i] + done * out->bps, in_ch, s->native_packed_matrix, index, nb_in, len-done);
             }
+            break;}
         }
     }
+}
+
+int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
+    RematrixThreadData td = { .out = out, .in = in, .len = len, .mustcopy = mustcopy };
+
+    if(s->mix_any_f) {
+        s->mix_any_f(out->ch, (const uint8_t **)in->ch, s->native_matrix, len);
+        return 0;
+    }
+
+    if(s->mix_2_1_simd || s->mix_1_1_simd){
+        td.len1= len&~15;
+        td.off = td.len1 * out->bps;
+    }
+
+    av_assert0(!s->out_ch_layout || out->ch_count == av_get_channel_layout_nb_channels(s->out_ch_layout));
+    av_assert0(!s-> in_ch_layout || in ->ch_count == av_get_channel_layout_nb_channels(s-> in_ch_layout));
+
+    swri_execute(s, rematrix_channels, &td, swri_nb_jobs(s, out->ch_count));
+
     return 0;
 }
@@ -67,6 +67,18 @@ static void RENAME(copy)(SAMPLE *out, const SAMPLE *in, COEFF *coeffp, integer i
         out[i] = R(coeff*in[i]);
 }
 
+static void RENAME(mix_n_1)(SAMPLE *out, const SAMPLE **in, COEFF *coeffp, integer index, integer nb_in, integer len){
+    int i, j;
+    coeffp += index;
+
+    for(i=0; i<len; i++) {
+        INTER v = 0;
+        for(j=0; j<nb_in; j++)
+            v += in[j][i] * (INTER)coeffp[j];
+        out[i] = R(v);
+    }
+}
+
 static void RENAME(mix6to2)(SAMPLE **out, const SAMPLE **in, COEFF *coeffp, integer len){
     int i;
 
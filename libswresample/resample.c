@@ -344,7 +344,7 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
         c->linear        = linear;
         c->factor        = factor;
         c->filter_length = filter_length;
-        c->filter_alloc  = FFALIGN(c->filter_length, 8);
+        c->filter_alloc  = FFALIGN(c->filter_length, 16);
         c->filter_bank   = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
         c->filter_type   = filter_type;
         c->kaiser_beta   = kaiser_beta;
@@ -353,7 +353,7 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
             goto error;
         if (build_filter(c, (void*)c->filter_bank, factor, c->filter_length, c->filter_alloc, phase_count, 1<<c->filter_shift, filter_type, kaiser_beta))
             goto error;
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_alloc-1)*c->felem_size);
+        memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_length-1)*c->felem_size);
         memcpy(c->filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, c->filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
     }
 
@@ -402,7 +402,7 @@ static int rebuild_filter_bank_with_compensation(ResampleContext *c)
         av_freep(&new_filter_bank);
         return ret;
     }
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, new_filter_bank, (c->filter_alloc-1)*c->felem_size);
+    memcpy(new_filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, new_filter_bank, (c->filter_length-1)*c->felem_size);
     memcpy(new_filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, new_filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
 
     if (!av_reduce(&new_src_incr, &new_dst_incr, c->src_incr,
@@ -449,8 +449,49 @@ static int set_compensation(ResampleContext *c, int sample_delta, int compensati
     return 0;
 }
 
-static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
+typedef struct ResampleThreadData {
+    ResampleContext *c;
+    AudioData *dst;
+    const AudioData *src;
+    int n;
+    int need_emms;
+    int (*resample_func)(struct ResampleContext *c, void *dst,
+                         const void *src, int n, int update_ctx);
+    int64_t index, incr;    ///< resample_one() position and increment
+    ResampleContext last;   ///< context updated by the last channel
+    int consumed;
+} ResampleThreadData;
+
+static void resample_channels(SwrContext *s, void *arg, int jobnr, int nb_jobs)
+{
+    ResampleThreadData *td = arg;
+    int ch_count = td->dst->ch_count;
+    int start = ch_count *  jobnr      / nb_jobs;
+    int end   = ch_count * (jobnr + 1) / nb_jobs;
     int i;
+
+    for (i = start; i < end; i++) {
+        if (td->resample_func) {
+            /* Only the last channel updates the context. It does so in a
+             * copy so that the other jobs keep reading the initial state. */
+            if (i + 1 == ch_count) {
+                td->last     = *td->c;
+                td->consumed = td->resample_func(&td->last, td->dst->ch[i], td->src->ch[i], td->n, 1);
+            } else {
+                td->resample_func(td->c, td->dst->ch[i], td->src->ch[i], td->n, 0);
+            }
+        } else {
+            td->c->dsp.resample_one(td->dst->ch[i], td->src->ch[i], td->n, td->index, td->incr);
+        }
+    }
+
+    if (td->need_emms)
+        emms_c();
+}
+
+static int multiple_resample(SwrContext *s, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
+    ResampleContext *c = s->resample;
+    ResampleThreadData td = { .c = c, .dst = dst, .src = src };
     int av_unused mm_flags = av_get_cpu_flags();
     int need_emms = c->format == AV_SAMPLE_FMT_S16P && ARCH_X86_32 &&
                     (mm_flags & (AV_CPU_FLAG_MMX2 | AV_CPU_FLAG_SSE2)) == AV_CPU_FLAG_MMX2;
@@ -469,33 +510,36 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
 
         dst_size = FFMAX(FFMIN(dst_size, new_size), 0);
         if (dst_size > 0) {
-            for (i = 0; i < dst->ch_count; i++) {
-                c->dsp.resample_one(dst->ch[i], src->ch[i], dst_size, index2, incr);
-                if (i+1 == dst->ch_count) {
-                    c->index += dst_size * c->dst_incr_div;
-                    c->index += (c->frac + dst_size * (int64_t)c->dst_incr_mod) / c->src_incr;
-                    av_assert2(c->index >= 0);
-                    *consumed = c->index;
-                    c->frac   = (c->frac + dst_size * (int64_t)c->dst_incr_mod) % c->src_incr;
-                    c->index = 0;
-                }
-            }
+            td.n     = dst_size;
+            td.index = index2;
+            td.incr  = incr;
+            swri_execute(s, resample_channels, &td, swri_nb_jobs(s, dst->ch_count));
+
+            c->index += dst_size * c->dst_incr_div;
+            c->index += (c->frac + dst_size * (int64_t)c->dst_incr_mod) / c->src_incr;
+            av_assert2(c->index >= 0);
+            *consumed = c->index;
+            c->frac   = (c->frac + dst_size * (int64_t)c->dst_incr_mod) % c->src_incr;
+            c->index = 0;
         }
     } else {
         int64_t end_index = (1LL + src_size - c->filter_length) * c->phase_count;
         int64_t delta_frac = (end_index - c->index) * c->src_incr - c->frac;
         int delta_n = (delta_frac + c->dst_incr - 1) / c->dst_incr;
-        int (*resample_func)(struct ResampleContext *c, void *dst,
-                             const void *src, int n, int update_ctx);
 
         dst_size = FFMAX(FFMIN(dst_size, delta_n), 0);
         if (dst_size > 0) {
             /* resample_linear and resample_common should have same behavior
              * when frac and dst_incr_mod are zero */
-            resample_func = (c->linear && (c->frac || c->dst_incr_mod)) ?
-                            c->dsp.resample_linear : c->dsp.resample_common;
-            for (i = 0; i < dst->ch_count; i++)
-                *consumed = resample_func(c, dst->ch[i], src->ch[i], dst_size, i+1 == dst->ch_count);
+            td.resample_func = (c->linear && (c->frac || c->dst_incr_mod)) ?
+                               c->dsp.resample_linear : c->dsp.resample_common;
+            td.n             = dst_size;
+            td.need_emms     = need_emms;
+            swri_execute(s, resample_channels, &td, swri_nb_jobs(s, dst->ch_count));
+
+            *consumed = td.consumed;
+            c->index  = td.last.index;
+            c->frac   = td.last.frac;
         }
     }
 
@@ -24,6 +24,7 @@
 #include "libavutil/avassert.h"
 #include "libavutil/channel_layout.h"
 #include "libavutil/internal.h"
+#include "libavutil/slicethread.h"
 
 #include <float.h>
 
@@ -129,11 +130,62 @@ static void clear_context(SwrContext *s){
     swri_audio_convert_free(&s->out_convert);
     swri_audio_convert_free(&s->full_convert);
     swri_rematrix_free(s);
+    avpriv_slicethread_free(&s->slicethread);
+    s->nb_threads = 1;
 
     s->delayed_samples_fixup = 0;
     s->flushed = 0;
 }
 
+static void execute_worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    SwrContext *s = priv;
+
+    s->job_func(s, s->job_arg, jobnr, nb_jobs);
+}
+
+void swri_execute(SwrContext *s, swri_job_func func, void *arg, int nb_jobs)
+{
+    int i;
+
+    if (s->slicethread && nb_jobs > 1) {
+        s->job_func = func;
+        s->job_arg  = arg;
+        avpriv_slicethread_execute(s->slicethread, nb_jobs, 0);
+    } else {
+        for (i = 0; i < nb_jobs; i++)
+            func(s, arg, i, nb_jobs);
+    }
+}
+
+int swri_nb_jobs(SwrContext *s, int ch_count)
+{
+    return FFMAX(FFMIN(s->nb_threads, ch_count), 1);
+}
+
+static av_cold int init_threads(SwrContext *s)
+{
+    int ret;
+
+    if (s->threads == 1)
+        return 0;
+
+    ret = avpriv_slicethread_create(&s->slicethread, s, execute_worker, NULL, s->threads);
+    if (ret == AVERROR(ENOSYS)) {
+        av_log(s, AV_LOG_WARNING, "Threading is not supported, using a single thread\n");
+        return 0;
+    } else if (ret < 0) {
+        return ret;
+    } else if (ret < 2) {
+        avpriv_slicethread_free(&s->slicethread);
+        return 0;
+    }
+
+    s->nb_threads = ret;
+    av_log(s, AV_LOG_DEBUG, "Using %d threads\n", s->nb_threads);
+    return 0;
+}
+
 av_cold void swr_free(SwrContext **ss){
     SwrContext *s= *ss;
     if(s){
@@ -390,6 +442,9 @@ av_assert0(s->out.ch_count);
             goto fail;
     }
 
+    if ((ret = init_threads(s)) < 0)
+        goto fail;
+
     return 0;
 fail:
     swr_close(s);
@@ -514,7 +569,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
         int ret, size, consumed;
         if(!s->resample_in_constraint && s->in_buffer_count){
             buf_set(&tmp, &s->in_buffer, s->in_buffer_index);
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &tmp, s->in_buffer_count, &consumed);
+            ret= s->resampler->multiple_resample(s, &out, out_count, &tmp, s->in_buffer_count, &consumed);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
@@ -534,7 +589,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
 
         if((s->flushed || in_count > padless) && !s->in_buffer_count){
             s->in_buffer_index=0;
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed);
+            ret= s->resampler->multiple_resample(s, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
@@ -41,6 +41,13 @@ typedef void (mix_1_1_func_type)(void *out, const void *in, void *coeffp, intege
 typedef void (mix_2_1_func_type)(void *out, const void *in1, const void *in2, void *coeffp, integer index1, integer index2, integer len);
 
 typedef void (mix_any_func_type)(uint8_t **out, const uint8_t **in1, void *coeffp, integer len);
+typedef void (mix_n_1_func_type)(void *out, const uint8_t **in, void *coeffp, integer index, integer nb_in, integer len);
+
+/**
+ * Function run by swri_execute() for each job, jobs process disjoint
+ * groups of channels.
+ */
+typedef void (*swri_job_func)(struct SwrContext *s, void *arg, int jobnr, int nb_jobs);
 
 typedef struct AudioData{
     uint8_t *ch[SWR_CH_MAX];    ///< samples buffer per channel
@@ -71,7 +78,7 @@ struct DitherContext {
 typedef struct ResampleContext * (* resample_init_func)(struct ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta, double precision, int cheby, int exact_rational);
 typedef void    (* resample_free_func)(struct ResampleContext **c);
-typedef int     (* multiple_resample_func)(struct ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
+typedef int     (* multiple_resample_func)(struct SwrContext *s, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
 typedef int     (* resample_flush_func)(struct SwrContext *c);
 typedef int     (* set_compensation_func)(struct ResampleContext *c, int sample_delta, int compensation_distance);
 typedef int64_t (* get_delay_func)(struct SwrContext *s, int64_t base);
@@ -113,6 +120,7 @@ struct SwrContext {
     const int *channel_map;                         ///< channel index (or -1 if muted channel) map
     int used_ch_count;                              ///< number of used input channels (mapped channel count if channel_map, otherwise in.ch_count)
     int engine;
+    int threads;                                    ///< number of threads requested, 0 for automatic
 
     int user_in_ch_count;                           ///< User set input channel count
     int user_out_ch_count;                          ///< User set output channel count
@@ -184,12 +192,32 @@ struct SwrContext {
 
     mix_any_func_type *mix_any_f;
 
+    mix_n_1_func_type *mix_n_1_f;
+    mix_n_1_func_type *mix_n_1_simd;
+    uint8_t *native_packed_matrix;                  ///< per output channel non zero coefficients, in matrix_ch order
+
+    struct AVSliceThread *slicethread;              ///< slice threading context, NULL if running single threaded
+    int nb_threads;                                 ///< number of threads used for conversion
+    swri_job_func job_func;                         ///< function run by the slice threads
+    void *job_arg;                                  ///< argument passed to job_func
+
     /* TODO: callbacks for ASM optimizations */
 };
 
 av_warn_unused_result
 int swri_realloc_audio(AudioData *a, int count);
 
+/**
+ * Run func for nb_jobs jobs, in parallel if threading is enabled.
+ */
+void swri_execute(SwrContext *s, swri_job_func func, void *arg, int nb_jobs);
+
+/**
+ * @return the number of jobs the processing of ch_count channels should be
+ *         split into
+ */
+int swri_nb_jobs(SwrContext *s, int ch_count);
+
 void swri_noise_shaping_int16 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
 void swri_noise_shaping_int32 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
 void swri_noise_shaping_float (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
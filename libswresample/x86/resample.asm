@@ -51,15 +51,16 @@ SECTION_RODATA
 pf_1:      dd 1.0
 pdbl_1:    dq 1.0
 pd_0x4000: dd 0x4000
+pd_0x20000000: dd 0x20000000
 
 SECTION .text
 
 ; FIXME remove unneeded variables (index_incr, phase_mask)
-%macro RESAMPLE_FNS 3-5 ; format [float or int16], bps, log2_bps, float op suffix [s or d], 1.0 constant
+%macro RESAMPLE_FNS 3-5 ; format [float, int16 or int32], bps, log2_bps, float op suffix [s or d], 1.0 constant
 ; int resample_common_$format(ResampleContext *ctx, $format *dst,
 ;                             const $format *src, int size, int update_ctx)
 %if ARCH_X86_64 ; unix64 and win64
-cglobal resample_common_%1, 0, 15, 2, ctx, dst, src, phase_count, index, frac, \
+cglobal resample_common_%1, 0, 15, 3, ctx, dst, src, phase_count, index, frac, \
                                       dst_incr_mod, size, min_filter_count_x4, \
                                       min_filter_len_x4, dst_incr_div, src_incr, \
                                       phase_mask, dst_end, filter_bank
@@ -167,6 +168,8 @@ cglobal resample_common_%1, 1, 7, 2, ctx, phase_count, dst, frac, \
 %endif
 %ifidn %1, int16
     movd                          m0, [pd_0x4000]
+%elifidn %1, int32
+    movd                         xm0, [pd_0x20000000]
 %else ; float/double
     xorps                         m0, m0, m0
 %endif
@@ -181,6 +184,14 @@ cglobal resample_common_%1, 1, 7, 2, ctx, phase_count, dst, frac, \
     pmaddwd                       m1, [filterq+min_filter_count_x4q*1]
     paddd                         m0, m1
 %endif
+%elifidn %1, int32
+    ; 64-bit products of the even and the odd elements
+    pshufd                        m2, m1, q3311
+    pmuldq                        m1, [filterq+min_filter_count_x4q*1]
+    paddq                         m0, m1
+    pshufd                        m1, [filterq+min_filter_count_x4q*1], q3311
+    pmuldq                        m2, m1
+    paddq                         m0, m2
 %else ; float/double
 %if cpuflag(fma4) || cpuflag(fma3)
     fmaddp%4                      m0, m1, [filterq+min_filter_count_x4q*1], m0
@@ -199,10 +210,32 @@ cglobal resample_common_%1, 1, 7, 2, ctx, phase_count, dst, frac, \
     packssdw                      m0, m0
     add                       indexd, dst_incr_divd
     movd                      [dstq], m0
+%elifidn %1, int32
+%if mmsize == 32
+    vextracti128                 xm1, m0, 0x1
+    paddq                        xm0, xm1
+%endif
+    pshufd                       xm1, xm0, q1032
+    paddq                        xm0, xm1
+    add                        fracd, dst_incr_modd
+    movq                     filterq, xm0
+    add                       indexd, dst_incr_divd
+    sar                      filterq, 30
+    movsxd      min_filter_count_x4q, filterd
+    cmp         min_filter_count_x4q, filterq
+    je .clip_done
+    sar                      filterq, 63
+    xor                      filterd, 0x7fffffff
+.clip_done:
+    mov                       [dstq], filterd
 %else ; float/double
     ; horizontal sum & store
-%if mmsize == 32
-    vextractf128                 xm1, m0, 0x1
+%if mmsize == 64
+    vextractf64x4                ym1, m0, 0x1
+    addp%4                       ym0, ym1
+%endif
+%if mmsize >= 32
+    vextractf128                 xm1, ym0, 0x1
     addp%4                       xm0, xm1
 %endif
     movhlps                      xm1, xm0
@@ -313,6 +346,8 @@ cglobal resample_linear_%1, 0, 15, 5, ctx, phase_mask, src, phase_count, index,
     mov           min_filter_len_x4d, [ctxq+ResampleContext.filter_length]
 %ifidn %1, int16
     movd                          m4, [pd_0x4000]
+%elifidn %1, int32
+    ; the bias is loaded in the loop, m4 is used as a temporary
 %else ; float/double
     cvtsi2s%4                    xm0, src_incrd
     movs%4                       xm4, [%5]
@@ -416,6 +451,9 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
 %ifidn %1, int16
     mova                          m0, m4
     mova                          m2, m4
+%elifidn %1, int32
+    movd                         xm0, [pd_0x20000000]
+    mova                          m2, m0
 %else ; float/double
     xorps                         m0, m0, m0
     xorps                         m2, m2, m2
@@ -434,6 +472,18 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
     paddd                         m2, m3
     paddd                         m0, m1
 %endif ; cpuflag
+%elifidn %1, int32
+    pshufd                        m3, m1, q3311
+    pshufd                        m4, [filter2q+min_filter_count_x4q*1], q3311
+    pmuldq                        m4, m3
+    paddq                         m2, m4
+    pshufd                        m4, [filter1q+min_filter_count_x4q*1], q3311
+    pmuldq                        m4, m3
+    paddq                         m0, m4
+    pmuldq                        m3, m1, [filter2q+min_filter_count_x4q*1]
+    pmuldq                        m1, [filter1q+min_filter_count_x4q*1]
+    paddq                         m2, m3
+    paddq                         m0, m1
 %else ; float/double
 %if cpuflag(fma4) || cpuflag(fma3)
     fmaddp%4                      m2, m1, [filter2q+min_filter_count_x4q*1], m2
@@ -484,11 +534,47 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
     ; - 32bit: eax=r0[filter1], edx=r2[filter2]
     ; - win64: eax=r6[filter1], edx=r1[todo]
     ; - unix64: eax=r6[filter1], edx=r2[todo]
+%elifidn %1, int32
+%if mmsize == 32
+    vextracti128                 xm1, m0, 0x1
+    vextracti128                 xm3, m2, 0x1
+    paddq                        xm0, xm1
+    paddq                        xm2, xm3
+%endif
+    pshufd                       xm1, xm0, q1032
+    pshufd                       xm3, xm2, q1032
+    paddq                        xm0, xm1
+    paddq                        xm2, xm3
+    psubq                        xm2, xm0
+    ; val += (v2 - val) / c->src_incr * frac, with the same register
+    ; constraints as above for the 64-bit imul/idiv
+    movq                         rax, xm2
+    add                       indexd, dst_incr_divd
+    cqo
+    idiv                              src_incrq
+    imul                         rax, fracq
+    movq                         rdx, xm0
+    add                        fracd, dst_incr_modd
+    add                          rax, rdx
+    sar                          rax, 30
+    movsxd                       rdx, eax
+    cmp                          rdx, rax
+    je .clip_done
+    sar                          rax, 63
+    xor                          eax, 0x7fffffff
+.clip_done:
+    mov                       [dstq], eax
 %else ; float/double
     ; val += (v2 - val) * (FELEML) frac / c->src_incr;
-%if mmsize == 32
-    vextractf128                 xm1, m0, 0x1
-    vextractf128                 xm3, m2, 0x1
+%if mmsize == 64
+    vextractf64x4                ym1, m0, 0x1
+    vextractf64x4                ym3, m2, 0x1
+    addp%4                       ym0, ym1
+    addp%4                       ym2, ym3
+%endif
+%if mmsize >= 32
+    vextractf128                 xm1, ym0, 0x1
+    vextractf128                 xm3, ym2, 0x1
     addp%4                       xm0, xm1
     addp%4                       xm2, xm3
 %endif
@@ -593,6 +679,10 @@ RESAMPLE_FNS float, 4, 2, s, pf_1
 INIT_XMM fma4
 RESAMPLE_FNS float, 4, 2, s, pf_1
 %endif
+%if ARCH_X86_64 && HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+RESAMPLE_FNS float, 4, 2, s, pf_1
+%endif
 
 %if ARCH_X86_32
 INIT_MMX mmxext
@@ -606,6 +696,15 @@ INIT_XMM xop
 RESAMPLE_FNS int16, 2, 1
 %endif
 
+%if ARCH_X86_64
+INIT_XMM sse4
+RESAMPLE_FNS int32, 4, 2
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+RESAMPLE_FNS int32, 4, 2
+%endif
+%endif
+
 INIT_XMM sse2
 RESAMPLE_FNS double, 8, 3, d, pdbl_1
 
@@ -617,3 +716,7 @@ RESAMPLE_FNS double, 8, 3, d, pdbl_1
 INIT_YMM fma3
 RESAMPLE_FNS double, 8, 3, d, pdbl_1
 %endif
+%if ARCH_X86_64 && HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+RESAMPLE_FNS double, 8, 3, d, pdbl_1
+%endif
@@ -0,0 +1,186 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavcodec/ac3.h"
+#include "libavcodec/ac3dsp.h"
+#include "libavcodec/ac3tab.h"
+
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+
+#include "checkasm.h"
+
+#define EXP_SIZE (AC3_MAX_BLOCKS * AC3_MAX_COEFS)
+
+static void check_exponent_min(AC3DSPContext *c)
+{
+    LOCAL_ALIGNED_16(uint8_t, src,  [EXP_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, exp0, [EXP_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, exp1, [EXP_SIZE]);
+    int i, num_reuse_blocks;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, uint8_t *exp, int num_reuse_blocks,
+                      int nb_coefs);
+
+    for (i = 0; i < EXP_SIZE; i++)
+        src[i] = rnd() % 25;
+
+    for (num_reuse_blocks = 0; num_reuse_blocks < AC3_MAX_BLOCKS; num_reuse_blocks++) {
+        if (check_func(c->ac3_exponent_min, "ac3_exponent_min_reuse%d", num_reuse_blocks)) {
+            memcpy(exp0, src, EXP_SIZE);
+            memcpy(exp1, src, EXP_SIZE);
+            call_ref(exp0, num_reuse_blocks, AC3_MAX_COEFS);
+            call_new(exp1, num_reuse_blocks, AC3_MAX_COEFS);
+            if (memcmp(exp0, exp1, EXP_SIZE))
+                fail();
+            bench_new(exp1, num_reuse_blocks, AC3_MAX_COEFS);
+        }
+    }
+    report("ac3_exponent_min");
+}
+
+static void check_extract_exponents(AC3DSPContext *c)
+{
+    LOCAL_ALIGNED_16(int32_t, coef, [EXP_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, exp0, [EXP_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, exp1, [EXP_SIZE]);
+    int i;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, uint8_t *exp, int32_t *coef,
+                      int nb_coefs);
+
+    /* 25-bit coefficients of all magnitudes, including zero */
+    for (i = 0; i < EXP_SIZE; i++) {
+        int bits = rnd() % 25;
+        int v    = bits ? rnd() & ((1 << bits) - 1) : 0;
+        coef[i]  = rnd() & 1 ? -v : v;
+    }
+
+    if (check_func(c->extract_exponents, "ac3_extract_exponents")) {
+        memset(exp0, 0, EXP_SIZE);
+        memset(exp1, 0, EXP_SIZE);
+        call_ref(exp0, coef, EXP_SIZE);
+        call_new(exp1, coef, EXP_SIZE);
+        if (memcmp(exp0, exp1, EXP_SIZE))
+            fail();
+        bench_new(exp1, coef, EXP_SIZE);
+    }
+    report("ac3_extract_exponents");
+}
+
+static void check_bit_alloc_calc_bap(AC3DSPContext *c)
+{
+    static const int snr_offsets[] = { -960, -640, 0, 1024, 2060 };
+    LOCAL_ALIGNED_16(int16_t, mask, [AC3_CRITICAL_BANDS]);
+    LOCAL_ALIGNED_16(int16_t, psd,  [AC3_MAX_COEFS]);
+    LOCAL_ALIGNED_16(uint8_t, bap0, [AC3_MAX_COEFS]);
+    LOCAL_ALIGNED_16(uint8_t, bap1, [AC3_MAX_COEFS]);
+    int i, j;
+
+    declare_func(void, int16_t *mask, int16_t *psd, int start, int end,
+                 int snr_offset, int floor, const uint8_t *bap_tab, uint8_t *bap);
+
+    /* psd and mask values in the range produced from exponents 0 to 24 */
+    for (i = 0; i < AC3_MAX_COEFS; i++)
+        psd[i] = 3072 - (rnd() % 25 << 7);
+    for (i = 0; i < AC3_CRITICAL_BANDS; i++)
+        mask[i] = 3072 - (int)(rnd() % 3300);
+
+    if (check_func(c->bit_alloc_calc_bap, "ac3_bit_alloc_calc_bap")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(snr_offsets); i++) {
+            for (j = 0; j < 4; j++) {
+                int start = j ? rnd() % 37 : 0;
+                int end   = j ? start + 1 + rnd() % (AC3_MAX_COEFS - 3 - start) : 253;
+                int floor = ff_ac3_floor_tab[rnd() % 8];
+
+                memset(bap0, 0, AC3_MAX_COEFS);
+                memset(bap1, 0, AC3_MAX_COEFS);
+                call_ref(mask, psd, start, end, snr_offsets[i], floor,
+                         ff_ac3_bap_tab, bap0);
+                call_new(mask, psd, start, end, snr_offsets[i], floor,
+                         ff_ac3_bap_tab, bap1);
+                if (memcmp(bap0, bap1, AC3_MAX_COEFS))
+                    fail();
+            }
+        }
+        bench_new(mask, psd, 0, 253, 0, ff_ac3_floor_tab[4], ff_ac3_bap_tab, bap1);
+    }
+    report("ac3_bit_alloc_calc_bap");
+}
+
+static void check_mantissa_counts(AC3DSPContext *c)
+{
+    LOCAL_ALIGNED_16(uint8_t,  bap,  [EXP_SIZE]);
+    LOCAL_ALIGNED_16(uint16_t, cnt0, [AC3_MAX_BLOCKS], [16]);
+    LOCAL_ALIGNED_16(uint16_t, cnt1, [AC3_MAX_BLOCKS], [16]);
+    int i, blk;
+
+    for (i = 0; i < EXP_SIZE; i++)
+        bap[i] = rnd() % 16;
+
+    memset(cnt0, 0, sizeof(*cnt0) * AC3_MAX_BLOCKS);
+    memset(cnt1, 0, sizeof(*cnt1) * AC3_MAX_BLOCKS);
+
+    if (check_func(c->update_bap_counts, "ac3_update_bap_counts")) {
+        declare_func(void, uint16_t mant_cnt[16], uint8_t *bap, int len);
+
+        for (blk = 0; blk < AC3_MAX_BLOCKS; blk++) {
+            int start = rnd() % AC3_MAX_COEFS;
+            int len   = rnd() % (AC3_MAX_COEFS - start + 1);
+
+            call_ref(cnt0[blk], bap + blk * AC3_MAX_COEFS + start, len);
+            call_new(cnt1[blk], bap + blk * AC3_MAX_COEFS + start, len);
+        }
+        if (memcmp(cnt0, cnt1, sizeof(*cnt0) * AC3_MAX_BLOCKS))
+            fail();
+        memset(cnt1[0], 0, sizeof(*cnt1));
+        bench_new(cnt1[0], bap, AC3_MAX_COEFS);
+    }
+    report("ac3_update_bap_counts");
+
+    /* counts of up to 5 full bandwidth channels and the coupling channel */
+    for (blk = 0; blk < AC3_MAX_BLOCKS; blk++)
+        for (i = 0; i < 16; i++)
+            cnt0[blk][i] = rnd() % (6 * AC3_MAX_COEFS / 16);
+
+    if (check_func(c->compute_mantissa_size, "ac3_compute_mantissa_size")) {
+        declare_func(int, uint16_t mant_cnt[6][16]);
+        int bits0, bits1;
+
+        bits0 = call_ref(cnt0);
+        bits1 = call_new(cnt0);
+        if (bits0 != bits1)
+            fail();
+        bench_new(cnt0);
+    }
+    report("ac3_compute_mantissa_size");
+}
+
+void checkasm_check_ac3dsp(void)
+{
+    AC3DSPContext c;
+
+    ff_ac3dsp_init(&c, 0);
+
+    check_exponent_min(&c);
+    check_extract_exponents(&c);
+    check_bit_alloc_calc_bap(&c);
+    check_mantissa_counts(&c);
+}
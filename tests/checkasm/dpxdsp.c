@@ -0,0 +1,129 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavcodec/dpxdsp.h"
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+
+#define WIDTH 1023
+
+#define randomize_buffers(buf, size, mask)    \
+    do {                                      \
+        int j;                                \
+        for (j = 0; j < size; j++)            \
+            buf[j] = rnd() & mask;            \
+    } while (0)
+
+static void check_unpack(DPXDSPContext *c)
+{
+    LOCAL_ALIGNED_32(uint8_t,  src,  [WIDTH * 6]);
+    LOCAL_ALIGNED_32(uint16_t, dst0, [WIDTH * 3]);
+    LOCAL_ALIGNED_32(uint16_t, dst1, [WIDTH * 3]);
+    static const char *const endian[2] = { "le", "be" };
+    int be, shift;
+
+    randomize_buffers(src, WIDTH * 6, 0xFF);
+
+    for (be = 0; be < 2; be++) {
+        declare_func(void, const uint8_t *src, uint16_t *g, uint16_t *b,
+                     uint16_t *r, int width, int shift);
+
+        for (shift = 0; shift <= 2; shift += 2) {
+            if (check_func(c->unpack_rgb10[be], "dpx_unpack_rgb10_%s_%d", endian[be], shift)) {
+                memset(dst0, 0, WIDTH * 3 * sizeof(*dst0));
+                memset(dst1, 0, WIDTH * 3 * sizeof(*dst1));
+                call_ref(src, dst0, dst0 + WIDTH, dst0 + 2 * WIDTH, WIDTH, shift);
+                call_new(src, dst1, dst1 + WIDTH, dst1 + 2 * WIDTH, WIDTH, shift);
+                if (memcmp(dst0, dst1, WIDTH * 3 * sizeof(*dst0)))
+                    fail();
+                bench_new(src, dst1, dst1 + WIDTH, dst1 + 2 * WIDTH, WIDTH, shift);
+            }
+        }
+    }
+    report("unpack_rgb10");
+
+    for (be = 0; be < 2; be++) {
+        declare_func(void, const uint8_t *src, uint16_t *g, uint16_t *b,
+                     uint16_t *r, int width);
+
+        if (check_func(c->unpack_rgb12[be], "dpx_unpack_rgb12_%s", endian[be])) {
+            memset(dst0, 0, WIDTH * 3 * sizeof(*dst0));
+            memset(dst1, 0, WIDTH * 3 * sizeof(*dst1));
+            call_ref(src, dst0, dst0 + WIDTH, dst0 + 2 * WIDTH, WIDTH);
+            call_new(src, dst1, dst1 + WIDTH, dst1 + 2 * WIDTH, WIDTH);
+            if (memcmp(dst0, dst1, WIDTH * 3 * sizeof(*dst0)))
+                fail();
+            bench_new(src, dst1, dst1 + WIDTH, dst1 + 2 * WIDTH, WIDTH);
+        }
+    }
+    report("unpack_rgb12");
+}
+
+static void check_pack(DPXDSPContext *c)
+{
+    LOCAL_ALIGNED_32(uint16_t, src,  [WIDTH * 3]);
+    LOCAL_ALIGNED_32(uint8_t,  dst0, [WIDTH * 6]);
+    LOCAL_ALIGNED_32(uint8_t,  dst1, [WIDTH * 6]);
+    static const char *const endian[2] = { "le", "be" };
+    int be, bits, i;
+
+    for (bits = 10; bits <= 12; bits += 2) {
+        for (be = 0; be < 2; be++) {
+            void (*func)(uint8_t *, const uint16_t *, const uint16_t *,
+                         const uint16_t *, int) = bits == 10 ? c->pack_rgb10[be]
+                                                             : c->pack_rgb12[be];
+            int size = WIDTH * (bits == 10 ? 4 : 6);
+            declare_func(void, uint8_t *dst, const uint16_t *g,
+                         const uint16_t *b, const uint16_t *r, int width);
+
+            /* samples are stored in the byte order of the output */
+            for (i = 0; i < WIDTH * 3; i++) {
+                int v = rnd() & ((1 << bits) - 1);
+                if (be)
+                    AV_WB16(src + i, v);
+                else
+                    AV_WL16(src + i, v);
+            }
+
+            if (check_func(func, "dpx_pack_rgb%d_%s", bits, endian[be])) {
+                memset(dst0, 0, size);
+                memset(dst1, 0, size);
+                call_ref(dst0, src, src + WIDTH, src + 2 * WIDTH, WIDTH);
+                call_new(dst1, src, src + WIDTH, src + 2 * WIDTH, WIDTH);
+                if (memcmp(dst0, dst1, size))
+                    fail();
+                bench_new(dst1, src, src + WIDTH, src + 2 * WIDTH, WIDTH);
+            }
+        }
+        report("pack_rgb%d", bits);
+    }
+}
+
+void checkasm_check_dpxdsp(void)
+{
+    DPXDSPContext c;
+
+    ff_dpxdsp_init(&c);
+
+    check_unpack(&c);
+    check_pack(&c);
+}
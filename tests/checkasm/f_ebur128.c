@@ -0,0 +1,134 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <float.h>
+#include <string.h>
+
+#include "libavfilter/ebur128dsp.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "checkasm.h"
+
+#define CHANNELS 8
+#define SAMPLES  64
+#define EPS      (8 * DBL_EPSILON)
+
+#define randomize_buffer(buf, len)                    \
+do {                                                  \
+    int i;                                            \
+    for (i = 0; i < len; i++)                         \
+        buf[i] = (double)rnd() / UINT_MAX * 2.0 - 1.0; \
+} while (0)
+
+static void check_filter_channels(void)
+{
+    LOCAL_ALIGNED_32(double, samples,      [CHANNELS]);
+    LOCAL_ALIGNED_32(double, state,        [3 * 2 * CHANNELS]);
+    LOCAL_ALIGNED_32(double, state_ref,    [3 * 2 * CHANNELS]);
+    LOCAL_ALIGNED_32(double, state_new,    [3 * 2 * CHANNELS]);
+    LOCAL_ALIGNED_32(double, cache,        [2 * CHANNELS]);
+    LOCAL_ALIGNED_32(double, cache_ref,    [2 * CHANNELS]);
+    LOCAL_ALIGNED_32(double, cache_new,    [2 * CHANNELS]);
+    LOCAL_ALIGNED_32(double, sum,          [2 * CHANNELS]);
+    LOCAL_ALIGNED_32(double, sum_ref,      [2 * CHANNELS]);
+    LOCAL_ALIGNED_32(double, sum_new,      [2 * CHANNELS]);
+    int nb_channels;
+
+    declare_func(void, double *x, double *y, double *z, const double *samples,
+                 double *cache_400, double *cache_3000,
+                 double *sum_400, double *sum_3000, int nb_channels);
+
+    randomize_buffer(samples, CHANNELS);
+    randomize_buffer(state, 3 * 2 * CHANNELS);
+    randomize_buffer(cache, 2 * CHANNELS);
+    randomize_buffer(sum, 2 * CHANNELS);
+
+    for (nb_channels = 1; nb_channels <= CHANNELS; nb_channels++) {
+        double *x_ref = state_ref, *y_ref = x_ref + 2 * nb_channels, *z_ref = y_ref + 2 * nb_channels;
+        double *x_new = state_new, *y_new = x_new + 2 * nb_channels, *z_new = y_new + 2 * nb_channels;
+
+        memcpy(state_ref, state, sizeof(*state) * 3 * 2 * CHANNELS);
+        memcpy(state_new, state, sizeof(*state) * 3 * 2 * CHANNELS);
+        memcpy(cache_ref, cache, sizeof(*cache) * 2 * CHANNELS);
+        memcpy(cache_new, cache, sizeof(*cache) * 2 * CHANNELS);
+        memcpy(sum_ref,   sum,   sizeof(*sum)   * 2 * CHANNELS);
+        memcpy(sum_new,   sum,   sizeof(*sum)   * 2 * CHANNELS);
+
+        call_ref(x_ref, y_ref, z_ref, samples, cache_ref, cache_ref + CHANNELS,
+                 sum_ref, sum_ref + CHANNELS, nb_channels);
+        call_new(x_new, y_new, z_new, samples, cache_new, cache_new + CHANNELS,
+                 sum_new, sum_new + CHANNELS, nb_channels);
+
+        if (!double_near_abs_eps_array(state_ref, state_new, EPS, 3 * 2 * CHANNELS) ||
+            !double_near_abs_eps_array(cache_ref, cache_new, EPS, 2 * CHANNELS) ||
+            !double_near_abs_eps_array(sum_ref,   sum_new,   EPS, 2 * CHANNELS))
+            fail();
+
+        if (nb_channels == 2 || nb_channels == 6)
+            bench_new(x_new, y_new, z_new, samples, cache_new, cache_new + CHANNELS,
+                      sum_new, sum_new + CHANNELS, nb_channels);
+    }
+}
+
+static void check_peaks(void (*peaks)(double *, const double *, int, int),
+                        int history)
+{
+    LOCAL_ALIGNED_32(double, samples,   [(EBUR128_TP_HISTORY + SAMPLES) * CHANNELS]);
+    LOCAL_ALIGNED_32(double, peaks_ref, [CHANNELS]);
+    LOCAL_ALIGNED_32(double, peaks_new, [CHANNELS]);
+    const double *src = samples + history * CHANNELS;
+    int nb_channels;
+
+    declare_func(void, double *ch_peaks, const double *samples,
+                 int nb_channels, int nb_samples);
+
+    randomize_buffer(samples, (EBUR128_TP_HISTORY + SAMPLES) * CHANNELS);
+
+    for (nb_channels = 1; nb_channels <= CHANNELS; nb_channels++) {
+        memset(peaks_ref, 0, sizeof(*peaks_ref) * CHANNELS);
+        memset(peaks_new, 0, sizeof(*peaks_new) * CHANNELS);
+
+        call_ref(peaks_ref, src, nb_channels, SAMPLES * CHANNELS / nb_channels);
+        call_new(peaks_new, src, nb_channels, SAMPLES * CHANNELS / nb_channels);
+
+        if (!double_near_abs_eps_array(peaks_ref, peaks_new, EPS, CHANNELS))
+            fail();
+
+        if (nb_channels == 2 || nb_channels == 6)
+            bench_new(peaks_new, src, nb_channels, SAMPLES * CHANNELS / nb_channels);
+    }
+}
+
+void checkasm_check_ebur128(void)
+{
+    EBUR128DSPContext dsp;
+
+    ff_ebur128_dsp_init(&dsp);
+
+    if (check_func(dsp.filter_channels, "filter_channels"))
+        check_filter_channels();
+    report("filter_channels");
+
+    if (check_func(dsp.sample_peaks, "sample_peaks"))
+        check_peaks(dsp.sample_peaks, 0);
+    report("sample_peaks");
+
+    if (check_func(dsp.true_peaks, "true_peaks"))
+        check_peaks(dsp.true_peaks, EBUR128_TP_HISTORY);
+    report("true_peaks");
+}
@@ -35,24 +35,25 @@
         }                                       \
     } while (0)
 
-#define randomize_buffers2(buf, size)             \
-    do {                                          \
-        int j;                                    \
-        for (j = 0; j < size; j++)                \
-            AV_WN16A(buf + j * 2, rnd() & 0x3FF); \
+#define randomize_buffers2(buf, size, mask)      \
+    do {                                         \
+        int j;                                   \
+        for (j = 0; j < size; j++)               \
+            AV_WN16A(buf + j * 2, rnd() & mask); \
     } while (0)
 
-static void compare_add_res(int size, ptrdiff_t stride, int overflow_test)
+static void compare_add_res(int size, ptrdiff_t stride, int overflow_test, int bit_depth)
 {
     LOCAL_ALIGNED_32(int16_t, res0, [32 * 32]);
     LOCAL_ALIGNED_32(int16_t, res1, [32 * 32]);
     LOCAL_ALIGNED_32(uint8_t, dst0, [32 * 32 * 2]);
     LOCAL_ALIGNED_32(uint8_t, dst1, [32 * 32 * 2]);
+    int mask = bit_depth > 10 ? (1 << bit_depth) - 1 : 0x3FF;
 
     declare_func_emms(AV_CPU_FLAG_MMX, void, uint8_t *dst, int16_t *res, ptrdiff_t stride);
 
     randomize_buffers(res0, size);
-    randomize_buffers2(dst0, size);
+    randomize_buffers2(dst0, size, mask);
     if (overflow_test)
         res0[0] = 0x8000;
     memcpy(res1, res0, sizeof(*res0) * size);
@@ -60,7 +61,7 @@ static void compare_add_res(int size, ptrdiff_t stride, int overflow_test)
 
     call_ref(dst0, res0, stride);
     call_new(dst1, res1, stride);
-    if (memcmp(dst0, dst1, size))
+    if (memcmp(dst0, dst1, sizeof(int16_t) * size))
         fail();
     bench_new(dst1, res1, stride);
 }
@@ -75,9 +76,9 @@ static void check_add_res(HEVCDSPContext h, int bit_depth)
         ptrdiff_t stride = block_size << (bit_depth > 8);
 
         if (check_func(h.add_residual[i - 2], "hevc_add_res_%dx%d_%d", block_size, block_size, bit_depth)) {
-            compare_add_res(size, stride, 0);
+            compare_add_res(size, stride, 0, bit_depth);
             // overflow test for res = -32768
-            compare_add_res(size, stride, 1);
+            compare_add_res(size, stride, 1, bit_depth);
         }
     }
 }
@@ -86,9 +87,12 @@ void checkasm_check_hevc_add_res(void)
 {
     int bit_depth;
 
-    for (bit_depth = 8; bit_depth <= 10; bit_depth++) {
+    for (bit_depth = 8; bit_depth <= 12; bit_depth++) {
         HEVCDSPContext h;
 
+        if (bit_depth == 11)
+            continue;
+
         ff_hevc_dsp_init(&h, bit_depth);
         check_add_res(h, bit_depth);
     }
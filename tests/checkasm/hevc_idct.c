@@ -20,6 +20,7 @@
 
 #include <string.h>
 
+#include "libavutil/common.h"
 #include "libavutil/intreadwrite.h"
 
 #include "libavcodec/hevcdsp.h"
@@ -83,6 +84,36 @@ static void check_idct_dc(HEVCDSPContext h, int bit_depth)
     }
 }
 
+static void check_cross_component_pred(HEVCDSPContext h, int bit_depth)
+{
+    static const int res_scale_vals[] = { -8, -4, -2, -1, 1, 2, 4, 8 };
+    int i;
+    LOCAL_ALIGNED(32, int16_t, coeffs0,  [32 * 32]);
+    LOCAL_ALIGNED(32, int16_t, coeffs1,  [32 * 32]);
+    LOCAL_ALIGNED(32, int16_t, coeffs_y, [32 * 32]);
+
+    for (i = 2; i <= 5; i++) {
+        int block_size = 1 << i;
+        int size = block_size * block_size;
+        int res_scale_val = res_scale_vals[rnd() % FF_ARRAY_ELEMS(res_scale_vals)];
+        declare_func(void, int16_t *coeffs, const int16_t *coeffs_y,
+                     int res_scale_val, int16_t log2_size);
+
+        randomize_buffers(coeffs0, size);
+        randomize_buffers(coeffs_y, size);
+        memcpy(coeffs1, coeffs0, sizeof(*coeffs0) * size);
+
+        if (check_func(h.cross_component_pred, "hevc_cross_component_pred_%dx%d_%d",
+                       block_size, block_size, bit_depth)) {
+            call_ref(coeffs0, coeffs_y, res_scale_val, i);
+            call_new(coeffs1, coeffs_y, res_scale_val, i);
+            if (memcmp(coeffs0, coeffs1, sizeof(*coeffs0) * size))
+                fail();
+            bench_new(coeffs1, coeffs_y, res_scale_val, i);
+        }
+    }
+}
+
 void checkasm_check_hevc_idct(void)
 {
     int bit_depth;
@@ -102,4 +133,12 @@ void checkasm_check_hevc_idct(void)
         check_idct(h, bit_depth);
     }
     report("idct");
+
+    for (bit_depth = 8; bit_depth <= 12; bit_depth += 2) {
+        HEVCDSPContext h;
+
+        ff_hevc_dsp_init(&h, bit_depth);
+        check_cross_component_pred(h, bit_depth);
+    }
+    report("cross_component_pred");
 }
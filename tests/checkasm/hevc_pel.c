@@ -0,0 +1,180 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/intreadwrite.h"
+
+#include "libavcodec/hevcdsp.h"
+
+#include "checkasm.h"
+
+static const int sizes[10] = { 2, 4, 6, 8, 12, 16, 24, 32, 48, 64 };
+
+/* the filters read up to 3 pixels before and 4 after the block */
+#define SRC_EXTRA    8
+#define SRC_STRIDE   (2 * (MAX_PB_SIZE + 2 * SRC_EXTRA))
+#define SRC_BUF_SIZE (SRC_STRIDE * (MAX_PB_SIZE + 2 * SRC_EXTRA))
+#define SRC_OFFSET   (SRC_EXTRA * SRC_STRIDE + 2 * SRC_EXTRA)
+#define DST_STRIDE   (2 * MAX_PB_SIZE)
+#define DST_BUF_SIZE (DST_STRIDE * MAX_PB_SIZE)
+
+#define randomize_buffers()                                            \
+    do {                                                               \
+        uint32_t mask = bit_depth > 8 ? (1 << bit_depth) - 1 : 0xffff; \
+        int k;                                                         \
+        for (k = 0; k < SRC_BUF_SIZE; k += 2)                          \
+            AV_WN16A(src + k, rnd() & mask);                           \
+        for (k = 0; k < MAX_PB_SIZE * MAX_PB_SIZE; k++)                \
+            src2[k] = (int16_t)rnd() >> 2;                             \
+        for (k = 0; k < DST_BUF_SIZE; k += 4) {                        \
+            uint32_t r = rnd();                                        \
+            AV_WN32A(dst0 + k, r);                                     \
+            AV_WN32A(dst1 + k, r);                                     \
+        }                                                              \
+    } while (0)
+
+/* qpel uses the fractions 1 to 3, epel 1 to 7 */
+#define rnd_frac(qpel) (1 + rnd() % ((qpel) ? 3 : 7))
+
+enum { PUT, PUT_UNI, PUT_UNI_W, PUT_BI, PUT_BI_W, NB_PUT };
+
+static const char *const put_names[NB_PUT] = { "", "_uni", "_uni_w", "_bi", "_bi_w" };
+
+#define PEL_FUNC(h, qpel, name) ((qpel) ? (h)->put_hevc_qpel##name : (h)->put_hevc_epel##name)
+
+static void *get_put_func(HEVCDSPContext *h, int type, int qpel, int i, int j, int k)
+{
+    switch (type) {
+    case PUT:       return PEL_FUNC(h, qpel,      )[i][j][k];
+    case PUT_UNI:   return PEL_FUNC(h, qpel, _uni  )[i][j][k];
+    case PUT_UNI_W: return PEL_FUNC(h, qpel, _uni_w)[i][j][k];
+    case PUT_BI:    return PEL_FUNC(h, qpel, _bi   )[i][j][k];
+    default:        return PEL_FUNC(h, qpel, _bi_w )[i][j][k];
+    }
+}
+
+static void check_put(HEVCDSPContext *h, int bit_depth, int qpel, int type)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,  [SRC_BUF_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, src2, [MAX_PB_SIZE * MAX_PB_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [DST_BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [DST_BUF_SIZE]);
+    uint8_t *s = src + SRC_OFFSET;
+    int i, j, k;
+
+    for (i = 0; i < 10; i++) {
+        for (j = 0; j < 2; j++) {
+            for (k = 0; k < 2; k++) {
+                int size  = sizes[i];
+                int denom = rnd() % 8;
+                int wx0   = (int)(rnd() % 256) - 128;
+                int wx1   = (int)(rnd() % 256) - 128;
+                int ox0   = (int)(rnd() % 256) - 128;
+                int ox1   = (int)(rnd() % 256) - 128;
+                intptr_t mx = k ? rnd_frac(qpel) : 0;
+                intptr_t my = j ? rnd_frac(qpel) : 0;
+
+                if (!check_func(get_put_func(h, type, qpel, i, j, k),
+                                "put_hevc_%s%s_%d_%s%s_%d", qpel ? "qpel" : "epel",
+                                put_names[type], size, k ? "h" : "",
+                                j ? "v" : k ? "" : "pixels", bit_depth))
+                    continue;
+
+                randomize_buffers();
+                switch (type) {
+                case PUT: {
+                    declare_func(void, int16_t *dst, uint8_t *src, ptrdiff_t srcstride,
+                                 int height, intptr_t mx, intptr_t my, int width);
+                    call_ref((int16_t *)dst0, s, SRC_STRIDE, size, mx, my, size);
+                    call_new((int16_t *)dst1, s, SRC_STRIDE, size, mx, my, size);
+                    if (memcmp(dst0, dst1, DST_BUF_SIZE))
+                        fail();
+                    bench_new((int16_t *)dst1, s, SRC_STRIDE, size, mx, my, size);
+                    break;
+                }
+                case PUT_UNI: {
+                    declare_func(void, uint8_t *dst, ptrdiff_t dststride, uint8_t *src,
+                                 ptrdiff_t srcstride, int height, intptr_t mx, intptr_t my,
+                                 int width);
+                    call_ref(dst0, DST_STRIDE, s, SRC_STRIDE, size, mx, my, size);
+                    call_new(dst1, DST_STRIDE, s, SRC_STRIDE, size, mx, my, size);
+                    if (memcmp(dst0, dst1, DST_BUF_SIZE))
+                        fail();
+                    bench_new(dst1, DST_STRIDE, s, SRC_STRIDE, size, mx, my, size);
+                    break;
+                }
+                case PUT_UNI_W: {
+                    declare_func(void, uint8_t *dst, ptrdiff_t dststride, uint8_t *src,
+                                 ptrdiff_t srcstride, int height, int denom, int wx, int ox,
+                                 intptr_t mx, intptr_t my, int width);
+                    call_ref(dst0, DST_STRIDE, s, SRC_STRIDE, size, denom, wx0, ox0, mx, my, size);
+                    call_new(dst1, DST_STRIDE, s, SRC_STRIDE, size, denom, wx0, ox0, mx, my, size);
+                    if (memcmp(dst0, dst1, DST_BUF_SIZE))
+                        fail();
+                    bench_new(dst1, DST_STRIDE, s, SRC_STRIDE, size, denom, wx0, ox0, mx, my, size);
+                    break;
+                }
+                case PUT_BI: {
+                    declare_func(void, uint8_t *dst, ptrdiff_t dststride, uint8_t *src,
+                                 ptrdiff_t srcstride, int16_t *src2, int height,
+                                 intptr_t mx, intptr_t my, int width);
+                    call_ref(dst0, DST_STRIDE, s, SRC_STRIDE, src2, size, mx, my, size);
+                    call_new(dst1, DST_STRIDE, s, SRC_STRIDE, src2, size, mx, my, size);
+                    if (memcmp(dst0, dst1, DST_BUF_SIZE))
+                        fail();
+                    bench_new(dst1, DST_STRIDE, s, SRC_STRIDE, src2, size, mx, my, size);
+                    break;
+                }
+                case PUT_BI_W: {
+                    declare_func(void, uint8_t *dst, ptrdiff_t dststride, uint8_t *src,
+                                 ptrdiff_t srcstride, int16_t *src2, int height, int denom,
+                                 int wx0, int wx1, int ox0, int ox1,
+                                 intptr_t mx, intptr_t my, int width);
+                    call_ref(dst0, DST_STRIDE, s, SRC_STRIDE, src2, size,
+                             denom, wx0, wx1, ox0, ox1, mx, my, size);
+                    call_new(dst1, DST_STRIDE, s, SRC_STRIDE, src2, size,
+                             denom, wx0, wx1, ox0, ox1, mx, my, size);
+                    if (memcmp(dst0, dst1, DST_BUF_SIZE))
+                        fail();
+                    bench_new(dst1, DST_STRIDE, s, SRC_STRIDE, src2, size,
+                              denom, wx0, wx1, ox0, ox1, mx, my, size);
+                    break;
+                }
+                }
+            }
+        }
+    }
+}
+
+void checkasm_check_hevc_pel(void)
+{
+    HEVCDSPContext h[3];
+    int i, qpel, type;
+
+    for (i = 0; i < 3; i++)
+        ff_hevc_dsp_init(&h[i], 8 + 2 * i);
+
+    for (qpel = 1; qpel >= 0; qpel--) {
+        for (type = 0; type < NB_PUT; type++) {
+            for (i = 0; i < 3; i++)
+                check_put(&h[i], 8 + 2 * i, qpel, type);
+            report("%s%s", qpel ? "qpel" : "epel", put_names[type]);
+        }
+    }
+}
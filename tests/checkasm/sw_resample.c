@@ -0,0 +1,236 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <float.h>
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+
+#include "libswresample/swresample.h"
+#include "libswresample/swresample_internal.h"
+#include "libswresample/resample.h"
+
+#include "checkasm.h"
+
+#define DST_SAMPLES 64
+#define SRC_SAMPLES 512
+#define MIX_SAMPLES 256
+#define MIX_IN      6
+#define MIX_OUT     4
+
+static void randomize_samples(uint8_t *buf, enum AVSampleFormat fmt, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        switch (fmt) {
+        case AV_SAMPLE_FMT_S16P: ((int16_t *)buf)[i] = rnd();                                   break;
+        case AV_SAMPLE_FMT_S32P: ((int32_t *)buf)[i] = rnd();                                   break;
+        case AV_SAMPLE_FMT_FLTP: ((float   *)buf)[i] = (float)rnd() / UINT_MAX * 2.0f - 1.0f;   break;
+        case AV_SAMPLE_FMT_DBLP: ((double  *)buf)[i] = (double)rnd() / UINT_MAX * 2.0 - 1.0;    break;
+        }
+    }
+}
+
+static int samples_differ(const uint8_t *a, const uint8_t *b,
+                          enum AVSampleFormat fmt, int count, int tolerance)
+{
+    int i;
+
+    switch (fmt) {
+    case AV_SAMPLE_FMT_S16P:
+        for (i = 0; i < count; i++)
+            if (FFABS(((const int16_t *)a)[i] - ((const int16_t *)b)[i]) > tolerance)
+                return 1;
+        return 0;
+    case AV_SAMPLE_FMT_S32P:
+        return memcmp(a, b, count * sizeof(int32_t));
+    case AV_SAMPLE_FMT_FLTP:
+        return !float_near_abs_eps_array((const float *)a, (const float *)b,
+                                         32 * FLT_EPSILON, count);
+    case AV_SAMPLE_FMT_DBLP:
+        return !double_near_abs_eps_array((const double *)a, (const double *)b,
+                                          32 * DBL_EPSILON, count);
+    }
+    return 1;
+}
+
+static void check_resample(void)
+{
+    static const enum AVSampleFormat formats[] = {
+        AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_DBLP,
+    };
+    LOCAL_ALIGNED_32(uint8_t, src,  [SRC_SAMPLES * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [DST_SAMPLES * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [DST_SAMPLES * sizeof(double)]);
+    int i, linear;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, int, ResampleContext *c, void *dst,
+                      const void *src, int n, int update_ctx);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(formats); i++) {
+        enum AVSampleFormat fmt = formats[i];
+        const char *name = av_get_sample_fmt_name(av_get_packed_sample_fmt(fmt));
+
+        randomize_samples(src, fmt, SRC_SAMPLES);
+
+        for (linear = 0; linear < 2; linear++) {
+            /* the linear interpolation needs a non exact ratio to be used */
+            ResampleContext *c = swri_resampler.init(NULL, 44100, 48000, 32, 10, linear,
+                                                     0.97, fmt, SWR_FILTER_TYPE_KAISER, 9,
+                                                     20, 0, !linear);
+            int (*func)(ResampleContext *c, void *dst, const void *src, int n, int update_ctx);
+            int ret0, ret1, index, frac;
+
+            if (!c) {
+                fail();
+                continue;
+            }
+            func = linear ? c->dsp.resample_linear : c->dsp.resample_common;
+
+            index = rnd() % c->phase_count;
+            frac  = rnd() % c->src_incr;
+
+            if (check_func(func, "resample_%s_%s", linear ? "linear" : "common", name)) {
+                int index0, frac0;
+
+                memset(dst0, 0, DST_SAMPLES * c->felem_size);
+                memset(dst1, 0, DST_SAMPLES * c->felem_size);
+
+                /* the return value is only set when the context is updated */
+                c->index = index;
+                c->frac  = frac;
+                ret0   = call_ref(c, dst0, src, DST_SAMPLES, 1);
+                index0 = c->index;
+                frac0  = c->frac;
+                c->index = index;
+                c->frac  = frac;
+                ret1   = call_new(c, dst1, src, DST_SAMPLES, 1);
+                if (ret0 != ret1 || index0 != c->index || frac0 != c->frac ||
+                    samples_differ(dst0, dst1, fmt, DST_SAMPLES, 0))
+                    fail();
+                c->index = index;
+                c->frac  = frac;
+                bench_new(c, dst1, src, DST_SAMPLES, 0);
+            }
+
+            swri_resampler.free(&c);
+        }
+    }
+    report("resample");
+}
+
+static void check_rematrix(void)
+{
+    static const enum AVSampleFormat formats[] = {
+        AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_DBLP,
+    };
+    LOCAL_ALIGNED_32(uint8_t, src,  [MIX_IN * MIX_SAMPLES * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MIX_SAMPLES * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MIX_SAMPLES * sizeof(double)]);
+    const uint8_t *in[MIX_IN];
+    double matrix[MIX_OUT * MIX_IN];
+    int i, j;
+
+    for (i = 0; i < MIX_IN; i++)
+        in[i] = src + i * MIX_SAMPLES * sizeof(double);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(formats); i++) {
+        enum AVSampleFormat fmt = formats[i];
+        const char *name = av_get_sample_fmt_name(av_get_packed_sample_fmt(fmt));
+        int bps = av_get_bytes_per_sample(fmt);
+        int tolerance = fmt == AV_SAMPLE_FMT_S16P;
+        SwrContext *s;
+
+        /* non zero coefficients summing to less than 1 in magnitude, so that
+         * every output channel takes the general mixing path */
+        for (j = 0; j < MIX_OUT * MIX_IN; j++)
+            matrix[j] = ((double)rnd() / UINT_MAX * 2.0 - 1.0) / MIX_IN + 1.0 / 1024;
+
+        s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_4POINT0, fmt, 48000,
+                               AV_CH_LAYOUT_5POINT1, fmt, 48000, 0, NULL);
+        if (!s || swr_set_matrix(s, matrix, MIX_IN) < 0 || swr_init(s) < 0) {
+            swr_free(&s);
+            fail();
+            continue;
+        }
+
+        for (j = 0; j < MIX_IN; j++)
+            randomize_samples((uint8_t *)in[j], fmt, MIX_SAMPLES);
+
+        {
+            declare_func_emms(AV_CPU_FLAG_MMX, void, void *out, const void *in,
+                              void *coeffp, integer index, integer len);
+            mix_1_1_func_type *func = s->mix_1_1_simd ? s->mix_1_1_simd : s->mix_1_1_f;
+            void *coeffp = s->mix_1_1_simd ? s->native_simd_matrix : s->native_matrix;
+
+            if (check_func(func, "mix_1_1_%s", name)) {
+                call_ref(dst0, in[0], s->native_matrix, 1, MIX_SAMPLES);
+                call_new(dst1, in[0], coeffp,           1, MIX_SAMPLES);
+                if (samples_differ(dst0, dst1, fmt, MIX_SAMPLES, tolerance))
+                    fail();
+                bench_new(dst1, in[0], coeffp, 1, MIX_SAMPLES);
+            }
+        }
+
+        {
+            declare_func_emms(AV_CPU_FLAG_MMX, void, void *out, const void *in1,
+                              const void *in2, void *coeffp, integer index1,
+                              integer index2, integer len);
+            mix_2_1_func_type *func = s->mix_2_1_simd ? s->mix_2_1_simd : s->mix_2_1_f;
+            void *coeffp = s->mix_2_1_simd ? s->native_simd_matrix : s->native_matrix;
+
+            if (check_func(func, "mix_2_1_%s", name)) {
+                call_ref(dst0, in[0], in[1], s->native_matrix, 2, 3, MIX_SAMPLES);
+                call_new(dst1, in[0], in[1], coeffp,           2, 3, MIX_SAMPLES);
+                if (samples_differ(dst0, dst1, fmt, MIX_SAMPLES, tolerance))
+                    fail();
+                bench_new(dst1, in[0], in[1], coeffp, 2, 3, MIX_SAMPLES);
+            }
+        }
+
+        {
+            declare_func_emms(AV_CPU_FLAG_MMX, void, void *out, const uint8_t **in,
+                              void *coeffp, integer index, integer nb_in, integer len);
+            mix_n_1_func_type *func = s->mix_n_1_simd ? s->mix_n_1_simd : s->mix_n_1_f;
+            int nb_in = s->matrix_ch[1][0];
+
+            if (check_func(func, "mix_n_1_%s", name)) {
+                memset(dst0, 0, MIX_SAMPLES * bps);
+                memset(dst1, 0, MIX_SAMPLES * bps);
+
+                call_ref(dst0, in, s->native_packed_matrix, MIX_IN, nb_in, MIX_SAMPLES);
+                call_new(dst1, in, s->native_packed_matrix, MIX_IN, nb_in, MIX_SAMPLES);
+                if (samples_differ(dst0, dst1, fmt, MIX_SAMPLES, tolerance))
+                    fail();
+                bench_new(dst1, in, s->native_packed_matrix, MIX_IN, nb_in, MIX_SAMPLES);
+            }
+        }
+
+        swr_free(&s);
+    }
+    report("rematrix");
+}
+
+void checkasm_check_sw_resample(void)
+{
+    check_resample();
+    check_rematrix();
+}
@@ -128,6 +128,15 @@ fate-filter-firequalizer: CMP = oneoff
 fate-filter-firequalizer: CMP_UNIT = s16
 fate-filter-firequalizer: SIZE_TOLERANCE = 1058400 - 1097208
 
+FATE_AFILTER-$(call FILTERDEMDECENCMUX, LOUDNORM ARESAMPLE, WAV, PCM_S16LE, PCM_S16LE, WAV) += fate-filter-loudnorm-lookahead
+fate-filter-loudnorm-lookahead: tests/data/asynth-44100-2.wav
+fate-filter-loudnorm-lookahead: SRC = $(TARGET_PATH)/tests/data/asynth-44100-2.wav
+fate-filter-loudnorm-lookahead: CMD = framecrc -i $(SRC) -af aresample,loudnorm=lookahead=100,aresample=44100,aformat=sample_fmts=s16:channel_layouts=stereo
+
+# a decaying low frequency tone keeps the limiter gain rising over whole windows
+FATE_AFILTER-$(call ALLYES, LAVFI_INDEV AEVALSRC_FILTER LOUDNORM_FILTER ARESAMPLE_FILTER AFORMAT_FILTER PCM_S16LE_ENCODER FRAMECRC_MUXER) += fate-filter-loudnorm-lookahead-decay
+fate-filter-loudnorm-lookahead-decay: CMD = framecrc -f lavfi -i "aevalsrc=exp(-t)*sin(2*PI*20*t):c=mono:s=48000:d=3" -af aresample,loudnorm=lookahead=100:i=-10:tp=-2,aresample=48000,aformat=sample_fmts=s16:channel_layouts=mono -c:a pcm_s16le
+
 FATE_AFILTER-$(call FILTERDEMDECENCMUX, PAN, WAV, PCM_S16LE, PCM_S16LE, WAV) += fate-filter-pan-mono1
 fate-filter-pan-mono1: tests/data/asynth-44100-2.wav
 fate-filter-pan-mono1: SRC = $(TARGET_PATH)/tests/data/asynth-44100-2.wav
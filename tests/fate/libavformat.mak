@@ -6,6 +6,11 @@ FATE_LIBAVFORMAT-$(CONFIG_NETWORK) += fate-noproxy
 fate-noproxy: libavformat/tests/noproxy$(EXESUF)
 fate-noproxy: CMD = run libavformat/tests/noproxy$(EXESUF)
 
+LIVEORIGIN-TEST-$(call ALLYES, HLS_MUXER HTTP_PROTOCOL TCP_PROTOCOL) += fate-liveorigin
+FATE_LIBAVFORMAT-$(HAVE_THREADS) += $(LIVEORIGIN-TEST-yes)
+fate-liveorigin: libavformat/tests/liveorigin$(EXESUF)
+fate-liveorigin: CMD = run libavformat/tests/liveorigin$(EXESUF)
+
 FATE_LIBAVFORMAT-$(CONFIG_FFRTMPCRYPT_PROTOCOL) += fate-rtmpdh
 fate-rtmpdh: libavformat/tests/rtmpdh$(EXESUF)
 fate-rtmpdh: CMD = run libavformat/tests/rtmpdh$(EXESUF)